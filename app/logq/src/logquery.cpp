@@ -0,0 +1,456 @@
+// Unit Include
+#include "logquery.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+// Qt Includes
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSet>
+#include <QTimeZone>
+
+//===============================================================================================================
+// LogQuery::Stats
+//===============================================================================================================
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+qint64 LogQuery::Stats::total() const
+{
+    qint64 t = 0;
+    for(qint64 s : samples)
+        t += s;
+    return t;
+}
+
+qint64 LogQuery::Stats::percentile(int p) const
+{
+    if(samples.isEmpty())
+        return 0;
+
+    qsizetype i = (p * (samples.size() - 1) + 50) / 100;
+    return samples.at(i);
+}
+
+//===============================================================================================================
+// LogQuery
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Public:
+LogQuery::LogQuery() :
+    mOut(stdout),
+    mErr(stderr)
+{}
+
+//-Class Functions-------------------------------------------------------------
+//Private:
+QString LogQuery::formatDuration(qint64 ns) { return QString::number(ns / 1e6, 'f', 3) + u" ms"_s; }
+
+QString LogQuery::runStart(const QString& id)
+{
+    // Run IDs lead with their UTC start time
+    QDateTime start = QDateTime::fromString(id.section('-', 0, 0), u"yyyyMMdd'T'hhmmsszzz"_s);
+    start.setTimeZone(QTimeZone::UTC);
+    return start.isValid() ? start.toLocalTime().toString(u"yyyy-MM-dd hh:mm:ss"_s) : u"?"_s;
+}
+
+QString LogQuery::defaultDirPath()
+{
+    // Each build of CLIFp logs to its own directory, so go with whichever one was used last
+    QDir appDir(QCoreApplication::applicationDirPath());
+    QString latest = appDir.absolutePath();
+    QDateTime latestTime;
+
+    const QStringList logDirs = appDir.entryList({LOG_DIR_FILTER}, QDir::Dirs | QDir::NoDotAndDotDot);
+    for(const QString& d : logDirs)
+    {
+        QFileInfo manifest(appDir.absoluteFilePath(d + '/' + MANIFEST_NAME));
+        if(manifest.exists() && (!latestTime.isValid() || manifest.lastModified() > latestTime))
+        {
+            latest = manifest.absolutePath();
+            latestTime = manifest.lastModified();
+        }
+    }
+
+    return latest;
+}
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+bool LogQuery::loadManifest()
+{
+    QFile manifest(mDir.absoluteFilePath(MANIFEST_NAME));
+    if(!manifest.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonObject root = QJsonDocument::fromJson(manifest.readAll()).object();
+    if(root.value(u"version"_s).toInt() != MANIFEST_VERSION)
+        return false;
+
+    // A run that didn't fit in one segment shows up in each that it spans
+    QHash<QString, qsizetype> index;
+    const QJsonArray segments = root.value(u"segments"_s).toArray();
+    for(const QJsonValue& sv : segments)
+    {
+        QJsonObject so = sv.toObject();
+        quint64 id = so.value(u"id"_s).toInteger();
+        const QJsonArray runs = so.value(u"runs"_s).toArray();
+        for(const QJsonValue& rv : runs)
+        {
+            QString run = rv.toString();
+            auto existing = index.constFind(run);
+            if(existing != index.cend())
+                mRuns[*existing].segments.append(id);
+            else
+            {
+                index.insert(run, mRuns.size());
+                mRuns.append({.id = run, .segments = {id}});
+            }
+        }
+    }
+
+    return true;
+}
+
+bool LogQuery::selectRuns(QList<Run>& selected)
+{
+    if(mParser.isSet(OPT_RUN))
+    {
+        // Allow IDs to be shortened
+        const QStringList ids = mParser.values(OPT_RUN);
+        for(const Run& r : std::as_const(mRuns))
+            if(std::any_of(ids.cbegin(), ids.cend(), [&r](const QString& id){ return r.id.startsWith(id); }))
+                selected.append(r);
+    }
+    else
+        selected = mRuns;
+
+    if(mParser.isSet(OPT_LAST))
+    {
+        bool ok;
+        int last = mParser.value(OPT_LAST).toInt(&ok);
+        if(!ok || last < 0)
+        {
+            fail(ERR_INVALID_NUMBER.arg(mParser.value(OPT_LAST)));
+            return false;
+        }
+        if(last < selected.size())
+            selected = selected.sliced(selected.size() - last);
+    }
+
+    if(selected.isEmpty())
+    {
+        fail(ERR_NO_RUNS);
+        return false;
+    }
+
+    return true;
+}
+
+bool LogQuery::readEvents(const QList<Run>& runs, QList<Event>& events, QList<QByteArray>* raw)
+{
+    // Only the segments that hold the runs are read, in order
+    QList<quint64> segments;
+    QList<QByteArray> needles;
+    for(const Run& r : runs)
+    {
+        for(quint64 s : r.segments)
+            if(!segments.contains(s))
+                segments.append(s);
+        needles.append(uR"("run":")"_s.toUtf8() + r.id.toUtf8() + '"');
+    }
+    std::sort(segments.begin(), segments.end());
+
+    for(quint64 s : std::as_const(segments))
+    {
+        QFile segment(mDir.absoluteFilePath(SEGMENT_TEMPLATE.arg(s, 6, 10, QChar('0'))));
+        if(!segment.open(QIODevice::ReadOnly))
+            continue; // Dropped by retention since the manifest was read
+
+        while(!segment.atEnd())
+        {
+            QByteArray line = segment.readLine();
+
+            // Skip other runs without parsing them
+            if(std::none_of(needles.cbegin(), needles.cend(), [&line](const QByteArray& n){ return line.contains(n); }))
+                continue;
+
+            QJsonObject o = QJsonDocument::fromJson(line).object();
+            if(o.isEmpty())
+                continue; // Partially written line
+
+            events.append({
+                .run = o.value(u"run"_s).toString(),
+                .mono = o.value(u"mono"_s).toInteger(),
+                .wall = o.value(u"wall"_s).toInteger(),
+                .thread = o.value(u"thread"_s).toInt(),
+                .source = o.value(u"source"_s).toString(),
+                .kind = o.value(u"kind"_s).toString(),
+                .level = o.value(u"level"_s).toString(),
+                .severity = o.value(u"severity"_s).toString(),
+                .task = o.value(u"task"_s).toInt(-1),
+                .text = o.value(u"text"_s).toString(),
+                .code = o.value(u"code"_s).toInteger()
+            });
+            if(raw)
+                raw->append(line.trimmed());
+        }
+    }
+
+    return true;
+}
+
+bool LogQuery::matches(const Event& event) const
+{
+    if(mParser.isSet(OPT_SOURCE) && event.source.compare(mParser.value(OPT_SOURCE), Qt::CaseInsensitive) != 0)
+        return false;
+    if(mParser.isSet(OPT_KIND) && event.kind != mParser.value(OPT_KIND))
+        return false;
+    if(mParser.isSet(OPT_LEVEL) && event.level != mParser.value(OPT_LEVEL).toLower())
+        return false;
+    if(mParser.isSet(OPT_TASK) && event.task != mParser.value(OPT_TASK).toInt())
+        return false;
+    if(mParser.isSet(OPT_MATCH) && !event.text.contains(mParser.value(OPT_MATCH), Qt::CaseInsensitive))
+        return false;
+
+    return true;
+}
+
+int LogQuery::fail(const QString& message)
+{
+    mErr << message << Qt::endl;
+    return EXIT_FAILURE;
+}
+
+int LogQuery::listRuns()
+{
+    QList<Run> runs;
+    if(!selectRuns(runs))
+        return EXIT_FAILURE;
+
+    for(const Run& r : std::as_const(runs))
+    {
+        QStringList segments;
+        for(quint64 s : r.segments)
+            segments.append(QString::number(s));
+        mOut << r.id << u"  "_s << runStart(r.id) << u"  segment(s) "_s << segments.join(',') << Qt::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int LogQuery::printEvents()
+{
+    // Just the latest run unless told otherwise
+    if(!mParser.isSet(OPT_RUN) && !mParser.isSet(OPT_LAST))
+        mRuns = mRuns.sliced(mRuns.size() - 1);
+
+    QList<Run> runs;
+    if(!selectRuns(runs))
+        return EXIT_FAILURE;
+
+    QList<Event> events;
+    QList<QByteArray> raw;
+    bool json = mParser.isSet(OPT_JSON);
+    readEvents(runs, events, json ? &raw : nullptr);
+
+    QHash<QString, qint64> runMono;
+    for(qsizetype i = 0; i < events.size(); i++)
+    {
+        const Event& e = events.at(i);
+        if(e.kind == KIND_RUN)
+        {
+            runMono.insert(e.run, e.mono);
+            if(runs.size() > 1 && !json)
+                mOut << Qt::endl << u"== "_s << e.run << u" =="_s << Qt::endl;
+        }
+
+        if(!matches(e))
+            continue;
+
+        if(json)
+        {
+            mOut << raw.at(i) << Qt::endl;
+            continue;
+        }
+
+        QString kind = e.kind == KIND_EVENT ? e.level :
+                       e.kind == KIND_ERROR ? e.severity.toLower() + u"/0x"_s + QString::number(e.code, 16) :
+                       e.kind == KIND_FINISH ? e.kind + '/' + QString::number(e.code) : e.kind;
+        QString task = e.task >= 0 ? u" #"_s + QString::number(e.task) : QString();
+
+        mOut << QDateTime::fromMSecsSinceEpoch(e.wall).toString(u"hh:mm:ss.zzz"_s)
+             << u" +"_s << formatDuration(e.mono - runMono.value(e.run, e.mono))
+             << u" T"_s << e.thread
+             << u" ("_s << e.source << ')' << task
+             << ' ' << kind
+             << (e.text.isEmpty() ? QString() : u": "_s + e.text) << Qt::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int LogQuery::aggregateLatency()
+{
+    QList<Run> runs;
+    if(!selectRuns(runs))
+        return EXIT_FAILURE;
+
+    QList<Event> events;
+    readEvents(runs, events);
+
+    // Pair up the start and end of each task within its run
+    static const QString runKey = u"(run)"_s;
+    QMap<QString, Stats> stats;
+    QHash<QString, QHash<int, qint64>> taskStarts;
+    QHash<QString, qint64> runStarts;
+    for(const Event& e : std::as_const(events))
+    {
+        if(e.kind == KIND_RUN)
+            runStarts.insert(e.run, e.mono);
+        else if(e.kind == KIND_FINISH && runStarts.contains(e.run))
+            stats[runKey].add(e.mono - runStarts.value(e.run));
+        else if(e.kind == KIND_TASK_START)
+            taskStarts[e.run].insert(e.task, e.mono);
+        else if(e.kind == KIND_TASK_END && taskStarts[e.run].contains(e.task))
+            stats[e.source].add(e.mono - taskStarts[e.run].take(e.task));
+    }
+
+    if(mParser.isSet(OPT_SOURCE))
+        stats.removeIf([this](auto it){ return it.key().compare(mParser.value(OPT_SOURCE), Qt::CaseInsensitive) != 0; });
+
+    // Heaviest first
+    QList<QString> order = stats.keys();
+    for(auto& s : stats)
+        std::sort(s.samples.begin(), s.samples.end());
+    std::sort(order.begin(), order.end(), [&stats](const QString& a, const QString& b){ return stats[a].total() > stats[b].total(); });
+
+    static const QString row = u"%1 %2 %3 %4 %5 %6 %7 %8"_s;
+    mOut << row.arg(u"Task"_s, -24).arg(u"Count"_s, 6).arg(u"Min"_s, 12).arg(u"P50"_s, 12).arg(u"Mean"_s, 12)
+                .arg(u"P95"_s, 12).arg(u"Max"_s, 12).arg(u"Total"_s, 14) << Qt::endl;
+    for(const QString& name : std::as_const(order))
+    {
+        const Stats& s = stats[name];
+        mOut << row.arg(name, -24).arg(s.samples.size(), 6).arg(formatDuration(s.samples.first()), 12)
+                    .arg(formatDuration(s.percentile(50)), 12).arg(formatDuration(s.total() / s.samples.size()), 12)
+                    .arg(formatDuration(s.percentile(95)), 12).arg(formatDuration(s.samples.last()), 12)
+                    .arg(formatDuration(s.total()), 14) << Qt::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int LogQuery::diffRuns(const QStringList& ids)
+{
+    // Either the two given runs or the last two
+    QList<Run> runs;
+    if(ids.size() == 2)
+    {
+        for(const QString& id : ids)
+        {
+            auto it = std::find_if(mRuns.cbegin(), mRuns.cend(), [&id](const Run& r){ return r.id.startsWith(id); });
+            if(it == mRuns.cend())
+                return fail(ERR_NO_RUNS);
+            runs.append(*it);
+        }
+    }
+    else if(ids.isEmpty() && mRuns.size() >= 2)
+        runs = mRuns.sliced(mRuns.size() - 2);
+    else
+        return fail(ERR_DIFF_RUNS);
+
+    // Gather per run figures, keyed so they line up between runs
+    QMap<QString, qint64> figures[2];
+    for(int i = 0; i < 2; i++)
+    {
+        QList<Event> events;
+        readEvents({runs[i]}, events);
+
+        qint64 runStart = 0;
+        QHash<int, qint64> taskStarts;
+        QMap<QString, qint64>& f = figures[i];
+        for(const Event& e : std::as_const(events))
+        {
+            if(e.kind == KIND_RUN)
+                runStart = e.mono;
+            else if(e.kind == KIND_FINISH)
+            {
+                f[u"duration"_s] = e.mono - runStart;
+                f[u"exit code"_s] = e.code;
+            }
+            else if(e.kind == KIND_TASK_START)
+                taskStarts.insert(e.task, e.mono);
+            else if(e.kind == KIND_TASK_END && taskStarts.contains(e.task))
+                f[u"task "_s + e.source] += e.mono - taskStarts.take(e.task);
+            else if(e.kind == KIND_ERROR)
+                f[u"errors"_s]++;
+
+            if(e.kind == KIND_EVENT || e.kind == KIND_ERROR)
+                f[u"events "_s + e.source]++;
+        }
+    }
+
+    QSet<QString> keySet(figures[0].keyBegin(), figures[0].keyEnd());
+    keySet.unite(QSet<QString>(figures[1].keyBegin(), figures[1].keyEnd()));
+    QStringList keys(keySet.cbegin(), keySet.cend());
+    keys.sort();
+
+    static const QString row = u"%1 %2 %3 %4"_s;
+    mOut << row.arg(u""_s, -32).arg(runs[0].id, 24).arg(runs[1].id, 24).arg(u"Delta"_s, 14) << Qt::endl;
+    for(const QString& key : std::as_const(keys))
+    {
+        qint64 a = figures[0].value(key);
+        qint64 b = figures[1].value(key);
+
+        // Times are in ns, everything else is a count
+        bool time = key == u"duration"_s || key.startsWith(u"task "_s);
+        auto show = [time](qint64 v){ return time ? formatDuration(v) : QString::number(v); };
+        QString delta = (b >= a ? u"+"_s : u"-"_s) + show(std::abs(b - a));
+        mOut << row.arg(key, -32).arg(show(a), 24).arg(show(b), 24).arg(delta, 14) << Qt::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+//Public:
+int LogQuery::exec(const QStringList& arguments)
+{
+    mParser.setApplicationDescription(DESCRIPTION);
+    mParser.addHelpOption();
+    mParser.addOptions({OPT_DIR, OPT_RUN, OPT_LAST, OPT_SOURCE, OPT_KIND, OPT_LEVEL, OPT_TASK, OPT_MATCH, OPT_JSON});
+    mParser.addPositionalArgument(u"command"_s, u"runs, events, latency or diff"_s);
+    mParser.process(arguments);
+
+    QStringList positional = mParser.positionalArguments();
+    if(positional.isEmpty())
+    {
+        fail(ERR_NO_COMMAND);
+        return fail(mParser.helpText());
+    }
+    QString command = positional.takeFirst();
+
+    mDir.setPath(mParser.isSet(OPT_DIR) ? mParser.value(OPT_DIR) : defaultDirPath());
+    if(!loadManifest() || mRuns.isEmpty())
+        return fail(ERR_NO_MANIFEST.arg(mDir.absolutePath()));
+
+    if(command == CMD_RUNS)
+        return listRuns();
+    else if(command == CMD_EVENTS)
+        return printEvents();
+    else if(command == CMD_LATENCY)
+        return aggregateLatency();
+    else if(command == CMD_DIFF)
+        return diffRuns(positional);
+    else
+        return fail(ERR_UNKNOWN_COMMAND.arg(command));
+}
@@ -0,0 +1,136 @@
+#ifndef LOGQUERY_H
+#define LOGQUERY_H
+
+// Qt Includes
+#include <QCommandLineParser>
+#include <QDir>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+using namespace Qt::StringLiterals;
+
+/* Reads the structured event log written by CLIFp's '--event-log' option.
+ *
+ * The manifest of the log is used to work out which segments hold the runs of interest, so only those are
+ * read, and within them, lines belonging to other runs are skipped before being parsed.
+ */
+class LogQuery
+{
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+private:
+    struct Event
+    {
+        QString run;
+        qint64 mono; // ns
+        qint64 wall; // ms since epoch
+        int thread;
+        QString source;
+        QString kind;
+        QString level;
+        QString severity;
+        int task; // -1 if none
+        QString text;
+        qint64 code;
+    };
+
+    struct Run
+    {
+        QString id;
+        QList<quint64> segments;
+    };
+
+    struct Stats
+    {
+        QList<qint64> samples; // ns
+
+        void add(qint64 sample) { samples.append(sample); }
+        qint64 total() const;
+        qint64 percentile(int p) const; // Expects samples to be sorted
+    };
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    // Log
+    static inline const QString LOG_DIR_FILTER = u"*-events"_s; // <app basename>-events, console builds differ in name
+    static inline const QString MANIFEST_NAME = u"manifest.json"_s;
+    static const int MANIFEST_VERSION = 1;
+    static inline const QString SEGMENT_TEMPLATE = u"events-%1.jsonl"_s;
+
+    // Kinds
+    static inline const QString KIND_RUN = u"run"_s;
+    static inline const QString KIND_EVENT = u"event"_s;
+    static inline const QString KIND_ERROR = u"error"_s;
+    static inline const QString KIND_FINISH = u"finish"_s;
+    static inline const QString KIND_TASK_START = u"task-start"_s;
+    static inline const QString KIND_TASK_END = u"task-end"_s;
+
+    // Commands
+    static inline const QString CMD_RUNS = u"runs"_s;
+    static inline const QString CMD_EVENTS = u"events"_s;
+    static inline const QString CMD_LATENCY = u"latency"_s;
+    static inline const QString CMD_DIFF = u"diff"_s;
+
+    // Options
+    static inline const QCommandLineOption OPT_DIR{{u"d"_s, u"dir"_s}, u"Event log directory (default: the most recently written *-events directory next to this tool)."_s, u"path"_s};
+    static inline const QCommandLineOption OPT_RUN{{u"r"_s, u"run"_s}, u"Only consider the given run (can be repeated)."_s, u"id"_s};
+    static inline const QCommandLineOption OPT_LAST{{u"n"_s, u"last"_s}, u"Only consider the last N runs."_s, u"N"_s};
+    static inline const QCommandLineOption OPT_SOURCE{{u"s"_s, u"source"_s}, u"Only events from the given source."_s, u"name"_s};
+    static inline const QCommandLineOption OPT_KIND{{u"k"_s, u"kind"_s}, u"Only events of the given kind (run, event, error, finish, task-start, task-end)."_s, u"kind"_s};
+    static inline const QCommandLineOption OPT_LEVEL{{u"l"_s, u"level"_s}, u"Only events of the given level (trace, debug, info)."_s, u"level"_s};
+    static inline const QCommandLineOption OPT_TASK{{u"t"_s, u"task"_s}, u"Only events attributed to the given task number."_s, u"number"_s};
+    static inline const QCommandLineOption OPT_MATCH{{u"m"_s, u"match"_s}, u"Only events whose text contains the given string (case-insensitive)."_s, u"text"_s};
+    static inline const QCommandLineOption OPT_JSON{{u"j"_s, u"json"_s}, u"Print matching events as the raw JSON lines."_s};
+
+    // Messages
+    static inline const QString DESCRIPTION = u"Queries the structured event log of CLIFp.\n\n"
+                                              "Commands:\n"
+                                              "  runs               List the runs in the log\n"
+                                              "  events             Print events, filtered by the options below\n"
+                                              "  latency            Aggregate task durations by task\n"
+                                              "  diff [<a> <b>]     Compare two runs (default: the last two)"_s;
+    static inline const QString ERR_NO_COMMAND = u"No command was given."_s;
+    static inline const QString ERR_UNKNOWN_COMMAND = u"Unknown command \"%1\"."_s;
+    static inline const QString ERR_NO_MANIFEST = u"No event log found in %1."_s;
+    static inline const QString ERR_NO_RUNS = u"No matching runs."_s;
+    static inline const QString ERR_INVALID_NUMBER = u"\"%1\" is not a valid number."_s;
+    static inline const QString ERR_DIFF_RUNS = u"diff needs two runs."_s;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    QCommandLineParser mParser;
+    QTextStream mOut;
+    QTextStream mErr;
+    QDir mDir;
+    QList<Run> mRuns; // Oldest first
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    LogQuery();
+
+//-Class Functions------------------------------------------------------------------------------------------------------
+private:
+    static QString formatDuration(qint64 ns);
+    static QString runStart(const QString& id);
+    static QString defaultDirPath();
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    bool loadManifest();
+    bool selectRuns(QList<Run>& selected);
+    bool readEvents(const QList<Run>& runs, QList<Event>& events, QList<QByteArray>* raw = nullptr);
+    bool matches(const Event& event) const;
+    int fail(const QString& message);
+
+    int listRuns();
+    int printEvents();
+    int aggregateLatency();
+    int diffRuns(const QStringList& ids);
+
+public:
+    int exec(const QStringList& arguments);
+};
+
+#endif // LOGQUERY_H
@@ -0,0 +1,12 @@
+// Qt Includes
+#include <QCoreApplication>
+
+// Project Includes
+#include "logquery.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    LogQuery query;
+    return query.exec(app.arguments());
+}
@@ -1,7 +1,19 @@
 // Unit Include
 #include "c-download.h"
 
+// Standard Library Includes
+#include <functional>
+
+// Qt Includes
+#include <QDir>
+#include <QElapsedTimer>
+#include <QScopeGuard>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
 // libfp Includes
+#include <fp/fp-db.h>
 #include <fp/fp-install.h>
 
 // Project Includes
@@ -41,6 +53,112 @@ QString CDownloadError::deriveSecondary() const { return mSpecific; }
 CDownload::CDownload(Core& coreRef, const QStringList& commandLine) : Command(coreRef, commandLine) {}
 
 //-Instance Functions-------------------------------------------------------------
+//Private:
+bool CDownload::queryGameData(QHash<QUuid, Fp::GameData>& data, const QList<QUuid>& gameIds, QString& errorString)
+{
+    /* Fp::Db only offers lookups for a single game, which for a large playlist means thousands of round trips,
+     * so use a private read-only connection to the same database to grab the active data of every game in a
+     * few queries instead.
+     *
+     * Each game_data column is listed alongside the GameData field it fills, so the selection and the mapping
+     * can't drift apart, and values are read by name rather than position.
+     */
+    using Builder = Fp::GameData::Builder;
+    static const QList<std::pair<QString, std::function<void(Builder&, const QVariant&)>>> columns{
+        {u"id"_s, [](Builder& b, const QVariant& v){ b.wId(v.toUInt()); }},
+        {u"gameId"_s, [](Builder& b, const QVariant& v){ b.wGameId(QUuid(v.toString())); }},
+        {u"title"_s, [](Builder& b, const QVariant& v){ b.wTitle(v.toString()); }},
+        {u"dateAdded"_s, [](Builder& b, const QVariant& v){ b.wDateAdded(QDateTime::fromString(v.toString(), Qt::ISODateWithMs)); }},
+        {u"sha256"_s, [](Builder& b, const QVariant& v){ b.wSha256(v.toString()); }},
+        {u"crc32"_s, [](Builder& b, const QVariant& v){ b.wCrc32(v.toUInt()); }},
+        {u"presentOnDisk"_s, [](Builder& b, const QVariant& v){ b.wPresentOnDisk(v.toBool()); }},
+        {u"path"_s, [](Builder& b, const QVariant& v){ b.wPath(v.toString()); }},
+        {u"size"_s, [](Builder& b, const QVariant& v){ b.wSize(v.toUInt()); }},
+        {u"parameters"_s, [](Builder& b, const QVariant& v){ b.wParameters(v.toString()); }},
+        {u"applicationPath"_s, [](Builder& b, const QVariant& v){ b.wAppPath(v.toString()); }},
+        {u"launchCommand"_s, [](Builder& b, const QVariant& v){ b.wLaunchCommand(v.toString()); }}
+    };
+
+    QStringList selection;
+    for(const auto& c : columns)
+        selection.append(u"gd."_s + c.first);
+
+    auto cleanup = qScopeGuard([]{ QSqlDatabase::removeDatabase(BULK_CONNECTION_NAME); });
+    {
+        QSqlDatabase fpDb = QSqlDatabase::addDatabase(u"QSQLITE"_s, BULK_CONNECTION_NAME);
+        fpDb.setDatabaseName(mCore.fpInstall().database()->databaseName());
+        fpDb.setConnectOptions(u"QSQLITE_OPEN_READONLY"_s);
+        if(!fpDb.open())
+        {
+            errorString = fpDb.lastError().text();
+            return false;
+        }
+
+        QSqlQuery query(fpDb);
+        query.setForwardOnly(true);
+        for(qsizetype i = 0; i < gameIds.size(); i += BULK_QUERY_BATCH)
+        {
+            QList<QUuid> batch = gameIds.mid(i, BULK_QUERY_BATCH);
+            QStringList placeholders(batch.size(), u"?"_s);
+            query.prepare(u"SELECT "_s + selection.join(u", "_s) + u" FROM game_data gd INNER JOIN game g ON g.activeDataId = gd.id "
+                          "WHERE g.id IN ("_s + placeholders.join(',') + u")"_s);
+            for(const QUuid& id : batch)
+                query.addBindValue(id.toString(QUuid::WithoutBraces));
+
+            if(!query.exec())
+            {
+                errorString = query.lastError().text();
+                return false;
+            }
+
+            while(query.next())
+            {
+                Builder gdb;
+                for(const auto& [column, assign] : columns)
+                    assign(gdb, query.value(column));
+
+                Fp::GameData gameData = gdb.build();
+                data.insert(gameData.gameId(), gameData);
+            }
+        }
+    } // Connection must be out of scope before it's removed
+
+    return true;
+}
+
+CDownloadError CDownload::configureConcurrency(TDownload* downloadTask) const
+{
+    if(mParser.isSet(CL_OPTION_PARALLEL))
+    {
+        QString parallel = mParser.value(CL_OPTION_PARALLEL).trimmed();
+        if(parallel.compare(PARALLEL_AUTO, Qt::CaseInsensitive) == 0)
+        {
+            downloadTask->setAdaptive(true);
+            downloadTask->setMaxSimultaneous(PARALLEL_AUTO_CEILING);
+        }
+        else
+        {
+            bool ok;
+            int max = parallel.toInt(&ok);
+            if(!ok || max < 1)
+                return CDownloadError(CDownloadError::InvalidParallel, parallel);
+            downloadTask->setMaxSimultaneous(max);
+        }
+    }
+
+    if(mParser.isSet(CL_OPTION_MAX_PER_HOST))
+    {
+        QString perHost = mParser.value(CL_OPTION_MAX_PER_HOST).trimmed();
+        bool ok;
+        int max = perHost.toInt(&ok);
+        if(!ok || max < 1)
+            return CDownloadError(CDownloadError::InvalidMaxPerHost, perHost);
+        downloadTask->setMaxPerHost(max);
+    }
+
+    return CDownloadError();
+}
+
 //Protected:
 QList<const QCommandLineOption*> CDownload::options() const { return CL_OPTIONS_SPECIFIC + Command::options(); }
 QSet<const QCommandLineOption*> CDownload::requiredOptions() const { return CL_OPTIONS_REQUIRED + Command::requiredOptions(); }
@@ -75,10 +193,51 @@ Qx::Error CDownload::perform()
     TDownload* downloadTask = new TDownload(mCore);
     downloadTask->setStage(Task::Stage::Primary);
     downloadTask->setDescription(u"playlist data packs"_s);
+    if(CDownloadError tuneError = configureConcurrency(downloadTask); tuneError.isValid())
+    {
+        delete downloadTask;
+        postDirective<DError>(tuneError);
+        return tuneError;
+    }
     QList<int> dataIds;
 
     const Fp::Toolkit* tk = mCore.fpInstall().toolkit();
-    for(const auto& pg : pItr->playlistGames())
+    const auto playlistGames = pItr->playlistGames();
+
+    // Get data for all games up front
+    QList<QUuid> gameIds;
+    gameIds.reserve(playlistGames.size());
+    for(const auto& pg : playlistGames)
+        gameIds.append(pg.gameId());
+
+    QElapsedTimer queryTimer;
+    queryTimer.start();
+    QHash<QUuid, Fp::GameData> bulkData;
+    QString bulkError;
+    bool haveBulkData = queryGameData(bulkData, gameIds, bulkError);
+    if(haveBulkData)
+        logEvent(LOG_EVENT_BULK_QUERY.arg(bulkData.size()).arg(gameIds.size()).arg(queryTimer.elapsed()));
+    else
+        logEvent(LOG_EVENT_BULK_QUERY_FAILED.arg(bulkError));
+
+    // Check presence against one listing per data pack folder instead of a stat per pack
+    QHash<QString, QSet<QString>> folderListings;
+    auto isPresent = [&](const Fp::GameData& gameData){
+        QFileInfo packInfo(tk->datapackPath(gameData));
+        QString folder = packInfo.absolutePath();
+
+        auto lItr = folderListings.constFind(folder);
+        if(lItr == folderListings.cend())
+        {
+            const QStringList files = QDir(folder).entryList(QDir::Files | QDir::Hidden);
+            lItr = folderListings.insert(folder, QSet<QString>(files.cbegin(), files.cend()));
+        }
+
+        return lItr->contains(packInfo.fileName());
+    };
+
+    int presentCount = 0;
+    for(const auto& pg : playlistGames)
     {
         /* TODO: This doesn't handle Game Redirects, i.e. if one ID on a playlist becomes a redirect entry in the future.
          * Either need to add redirects here, or implement them in the DB module of libfp (full implementation).
@@ -86,7 +245,9 @@ Qx::Error CDownload::perform()
 
         // Get data
         Fp::GameData gameData;
-        if(Fp::DbError gdErr = db->getGameData(gameData, pg.gameId()); gdErr.isValid())
+        if(haveBulkData)
+            gameData = bulkData.value(pg.gameId());
+        else if(Fp::DbError gdErr = db->getGameData(gameData, pg.gameId()); gdErr.isValid())
         {
             postDirective<DError>(gdErr);
             return gdErr;
@@ -98,8 +259,11 @@ Qx::Error CDownload::perform()
             continue;
         }
 
-        if(tk->datapackIsPresent(gameData))
+        if(isPresent(gameData))
+        {
+            presentCount++;
             continue;
+        }
 
         // Queue download, if possible
         TDownloadError packError = downloadTask->addDatapack(tk, &gameData);
@@ -112,6 +276,7 @@ Qx::Error CDownload::perform()
         // Note data id
         dataIds.append(gameData.id());
     }
+    logEvent(LOG_EVENT_PRESENT_COUNT.arg(presentCount));
 
     if(downloadTask->isEmpty())
     {
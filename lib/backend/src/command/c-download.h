@@ -7,6 +7,11 @@
 // Project Includes
 #include "command/command.h"
 
+class TDownload;
+
+// FP Forward Declarations
+namespace Fp { class GameData; }
+
 class QX_ERROR_TYPE(CDownloadError, "CDownloadError", 1217)
 {
     friend class CDownload;
@@ -15,14 +20,18 @@ public:
     enum Type
     {
         NoError,
-        InvalidPlaylist
+        InvalidPlaylist,
+        InvalidParallel,
+        InvalidMaxPerHost
     };
 
 //-Class Variables-------------------------------------------------------------
 private:
     static inline const QHash<Type, QString> ERR_STRINGS{
         {NoError, u""_s},
-        {InvalidPlaylist, u""_s}
+        {InvalidPlaylist, u""_s},
+        {InvalidParallel, u"The simultaneous download limit must be a positive number or 'auto'."_s},
+        {InvalidMaxPerHost, u"The per-host download limit must be a positive number."_s}
     };
 
 //-Instance Variables-------------------------------------------------------------
@@ -58,15 +67,32 @@ private:
     static inline const QString LOG_EVENT_PLAYLIST_MATCH = u"Playlist matches ID: %1"_s;
     static inline const QString LOG_EVENT_NON_DATAPACK = u"Game %1 does not use a data pack."_s;
     static inline const QString LOG_EVENT_NO_OP = u"No datapacks to download."_s;
+    static inline const QString LOG_EVENT_BULK_QUERY = u"Fetched data for %1 of %2 playlist games in %3 ms"_s;
+    static inline const QString LOG_EVENT_BULK_QUERY_FAILED = u"Bulk data pack query failed (%1), querying games individually"_s;
+    static inline const QString LOG_EVENT_PRESENT_COUNT = u"%1 data packs already present"_s;
+
+    // Bulk query
+    static inline const QString BULK_CONNECTION_NAME = u"CDownload_bulk"_s;
+    static const int BULK_QUERY_BATCH = 500; // Stay well under SQLite's bound parameter limit
 
     // Command line option strings
     static inline const QString CL_OPT_PLAYLIST_S_NAME = u"p"_s;
     static inline const QString CL_OPT_PLAYLIST_L_NAME = u"playlist"_s;
     static inline const QString CL_OPT_PLAYLIST_DESC = u"Name of the playlist to download games for."_s;
+    static inline const QString CL_OPT_PARALLEL_L_NAME = u"parallel"_s;
+    static inline const QString CL_OPT_PARALLEL_DESC = u"Maximum number of simultaneous downloads, or 'auto' to keep adding downloads while it improves throughput."_s;
+    static inline const QString CL_OPT_MAX_PER_HOST_L_NAME = u"max-per-host"_s;
+    static inline const QString CL_OPT_MAX_PER_HOST_DESC = u"Maximum number of simultaneous downloads from any one server."_s;
+
+    // Parallelism
+    static inline const QString PARALLEL_AUTO = u"auto"_s;
+    static const int PARALLEL_AUTO_CEILING = 32;
 
     // Command line options
     static inline const QCommandLineOption CL_OPTION_PLAYLIST{{CL_OPT_PLAYLIST_S_NAME, CL_OPT_PLAYLIST_L_NAME}, CL_OPT_PLAYLIST_DESC, u"playlist"_s}; // Takes value
-    static inline const QList<const QCommandLineOption*> CL_OPTIONS_SPECIFIC{&CL_OPTION_PLAYLIST};
+    static inline const QCommandLineOption CL_OPTION_PARALLEL{{CL_OPT_PARALLEL_L_NAME}, CL_OPT_PARALLEL_DESC, u"count|auto"_s}; // Takes value
+    static inline const QCommandLineOption CL_OPTION_MAX_PER_HOST{{CL_OPT_MAX_PER_HOST_L_NAME}, CL_OPT_MAX_PER_HOST_DESC, u"count"_s}; // Takes value
+    static inline const QList<const QCommandLineOption*> CL_OPTIONS_SPECIFIC{&CL_OPTION_PLAYLIST, &CL_OPTION_PARALLEL, &CL_OPTION_MAX_PER_HOST};
     static inline const QSet<const QCommandLineOption*> CL_OPTIONS_REQUIRED{&CL_OPTION_PLAYLIST};
 
 public:
@@ -79,6 +105,10 @@ public:
     CDownload(Core& coreRef, const QStringList& commandLine);
 
 //-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    bool queryGameData(QHash<QUuid, Fp::GameData>& data, const QList<QUuid>& gameIds, QString& errorString);
+    CDownloadError configureConcurrency(TDownload* downloadTask) const;
+
 protected:
     QList<const QCommandLineOption*> options() const override;
     QSet<const QCommandLineOption*> requiredOptions() const override;
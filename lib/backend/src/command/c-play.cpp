@@ -368,7 +368,7 @@ void CPlay::setupRuffle(TExec* exec, const QString& originalParams)
      *
      * If the ruffle config schema really starts getting used, we might want to move its setup to libfp so that it just comes with the game entry.
      *
-     * The ruffle executable path should also likely be part of libfp. Then with this the chmod change should be done at startup using that path.
+     * The ruffle executable path should also likely be part of libfp. Then with this the chmod change could be done at startup using that path.
      *
      * TODO: Download ruffle if it's missing.
      */
@@ -381,7 +381,8 @@ void CPlay::setupRuffle(TExec* exec, const QString& originalParams)
     static QFileInfo ruffle = [&]{
         QFile file(mCore.fpInstall().dir().absoluteFilePath(u"Data/Ruffle/standalone/latest/"_s + RUFFLE_EXE));
         auto exec = QFile::ExeOwner | QFile::ExeGroup | QFile::ExeOther;
-        file.setPermissions(file.permissions() | exec);
+        if(auto perms = file.permissions(); (perms & exec) != exec) // Usually already done by a previous run
+            file.setPermissions(perms | exec);
         return QFileInfo(file);
     }();
 
@@ -0,0 +1,31 @@
+// Unit Include
+#include "c-serve.h"
+
+// Project Includes
+#include "kernel/core.h"
+
+//===============================================================================================================
+// CSERVE
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Public:
+CServe::CServe(Core& coreRef, const QStringList& commandLine) : Command(coreRef, commandLine) {}
+
+//-Instance Functions-------------------------------------------------------------
+//Protected:
+QList<const QCommandLineOption*> CServe::options() const { return Command::options(); }
+QString CServe::name() const { return NAME; }
+
+//Public:
+Qx::Error CServe::perform()
+{
+    // Nothing to enqueue, Driver takes over once this returns
+    postDirective<DStatusUpdate>(STATUS_SERVE, STATUS_SERVE_DETAILS);
+
+    // Return success
+    return Qx::Error();
+}
+
+//Public:
+bool CServe::startsResidentMode() const { return true; }
@@ -0,0 +1,40 @@
+#ifndef CSERVE_H
+#define CSERVE_H
+
+// Qx Includes
+#include <qx/utility/qx-macros.h>
+
+// Project Includes
+#include "command/command.h"
+
+class CServe : public Command
+{
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    // Status
+    static inline const QString STATUS_SERVE = u"Serving"_s;
+    static inline const QString STATUS_SERVE_DETAILS = u"Waiting for further invocations..."_s;
+
+public:
+    // Meta
+    static inline const QString NAME = u"serve"_s;
+    static inline const QString DESCRIPTION = u"Keeps a resident instance of CLIFp running that handles all further invocations, "
+                                               "which then only forward their command line to it."_s;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    CServe(Core& coreRef, const QStringList& commandLine);
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+protected:
+    QList<const QCommandLineOption*> options() const override;
+    QString name() const override;
+
+public:
+    Qx::Error perform() override;
+
+public:
+    bool startsResidentMode() const override;
+};
+
+#endif // CSERVE_H
@@ -115,7 +115,11 @@ Qx::IoOpReport CUpdate::determineNewFiles(QStringList& files, const QDir& source
         files += subFiles;
     }
 
-    files.removeIf([](const QString& s){ return s == u"bin/"_s + CLIFP_CUR_APP_BASENAME + u".log"_s; });
+    // Leave logs out of it, including the single file log of older versions
+    files.removeIf([](const QString& s){
+        QString logBase = u"bin/"_s + CLIFP_CUR_APP_BASENAME;
+        return s == logBase + u".log"_s || s.startsWith(logBase + u"-logs/"_s) || s.startsWith(logBase + u"-events/"_s);
+    });
 
     return Qx::IoOpReport(Qx::IO_OP_ENUMERATE, Qx::IO_SUCCESS, sourceRoot);
 }
@@ -11,6 +11,7 @@
 #include "command/c-play.h"
 #include "command/c-prepare.h"
 #include "command/c-run.h"
+#include "command/c-serve.h"
 #include "command/c-share.h"
 #include "command/c-show.h"
 #include "command/c-update.h"
@@ -99,6 +100,7 @@ void Command::registerAllCommands()
         CPlay,
         CPrepare,
         CRun,
+        CServe,
         CShare,
         CShow,
         CUpdate
@@ -253,6 +255,7 @@ QString Command::name() const { return NAME; };
 bool Command::requiresFlashpoint() const { return true; }
 bool Command::requiresServices() const { return false; }
 bool Command::autoBlockNewInstances() const { return true; }
+bool Command::startsResidentMode() const { return false; }
 
 CommandError Command::process(bool& proceed)
 {
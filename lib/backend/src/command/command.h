@@ -179,6 +179,7 @@ public:
     virtual bool requiresFlashpoint() const;
     virtual bool requiresServices() const;
     virtual bool autoBlockNewInstances() const;
+    virtual bool startsResidentMode() const;
     CommandError process(bool& proceed);
     virtual Qx::Error perform() = 0;
 };
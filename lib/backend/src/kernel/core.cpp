@@ -1,10 +1,19 @@
 // Unit Include
 #include "core.h"
 
+// Qt Includes
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
 // Qx Includes
 #include <qx/utility/qx-helpers.h>
 #include <qx/core/qx-system.h>
-#include <qx/core/qx-integrity.h>
 
 // libfp Includes
 #include <fp/fp-install.h>
@@ -14,6 +23,8 @@
 
 // Project Includes
 #include "command/command.h"
+#include "task/t-archivefetch.h"
+#include "task/t-awaitready.h"
 #include "task/t-download.h"
 #include "task/t-exec.h"
 #include "task/t-extract.h"
@@ -24,9 +35,83 @@
     #include "task/t-awaitdocker.h"
 #endif
 #include "tools/archiveaccess.h"
+#include "tools/localhttpclient.h"
 #include "utility.h"
 #include "_buildinfo.h"
 
+namespace
+{
+
+QList<TAwaitReady::Endpoint> daemonEndpoints(Fp::Daemon daemon)
+{
+    static const QString localHost = u"127.0.0.1"_s;
+
+    switch(daemon)
+    {
+        case Fp::Daemon::FpProxy:
+        case Fp::Daemon::FpGameServer:
+            return {{localHost, TMount::GAME_SERVER_PORT}};
+
+        default:
+            return {};
+    }
+}
+
+#ifdef __linux__
+/* Snapshot of the environment additions derived from the install at startup. Working them out requires
+ * reading the install's directories, but they only change when the install does, so they're stored in a
+ * single small binary file and reused as long as the install looks the same.
+ */
+struct EnvironmentSnapshot
+{
+    static const quint32 MAGIC = 0x434C4553; // 'CLES'
+    static const quint32 FORMAT = 1;
+
+    QString installPath;
+    qint64 librariesModified = 0;
+    bool immutable = false;
+    QList<std::pair<QString, QString>> vars;
+
+    static QString filePath() { return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + u"/startup.snapshot"_s; }
+
+    bool matches(const QString& path, qint64 libsModified) const { return installPath == path && librariesModified == libsModified; }
+
+    bool load()
+    {
+        QFile file(filePath());
+        if(!file.open(QIODevice::ReadOnly))
+            return false;
+
+        QDataStream in(file.readAll()); // One read
+        in.setVersion(QDataStream::Qt_6_0);
+
+        quint32 magic, format;
+        in >> magic >> format;
+        if(magic != MAGIC || format != FORMAT)
+            return false;
+
+        in >> installPath >> librariesModified >> immutable >> vars;
+        return in.status() == QDataStream::Ok;
+    }
+
+    void save() const
+    {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << MAGIC << FORMAT << installPath << librariesModified << immutable << vars;
+
+        // Best effort
+        QString path = filePath();
+        QSaveFile file(path);
+        if(QDir().mkpath(QFileInfo(path).absolutePath()) && file.open(QIODevice::WriteOnly) && file.write(data) == data.size())
+            file.commit();
+    }
+};
+#endif
+
+}
+
 //===============================================================================================================
 // CoreError
 //===============================================================================================================
@@ -59,13 +144,36 @@ QString CoreError::deriveSecondary() const { return mSpecific; }
 //Public:
 Core::Core() :
     Directorate(&mDirector),
-    mServicesMode(ServicesMode::Standalone)
+    mServicesMode(ServicesMode::Standalone),
+    mBatchMount(nullptr),
+    mBaseProcEnv(QProcessEnvironment::systemEnvironment())
 {}
 
 //-Destructor----------------------------------------------------------------------------------------------------------
 //Public:
 Core::~Core() = default; // Required definition so we can delete the unique_ptrs using forward declared types in the header
 
+//-Class Functions-------------------------------------------------------------
+//Private:
+void Core::setupParser(QCommandLineParser& clParser)
+{
+    clParser.setOptionsAfterPositionalArgumentsMode(QCommandLineParser::ParseAsPositionalArguments);
+    for(const QCommandLineOption* clOption : CL_OPTIONS_ALL)
+        clParser.addOption(*clOption);
+}
+
+//Public:
+QString Core::commandName(const QStringList& commandLine)
+{
+    // Parsed the same way initialize() does so that options which take a value aren't mistaken for the command
+    QCommandLineParser clParser;
+    setupParser(clParser);
+    if(!clParser.parse(commandLine))
+        return QString();
+
+    return clParser.positionalArguments().value(0);
+}
+
 //-Instance Functions-------------------------------------------------------------
 //Private:
 QString Core::name() const { return NAME; }
@@ -219,7 +327,7 @@ Qx::Error Core::searchAndFilterEntity(QUuid& returnBuffer, QString name, bool ex
     }
 }
 
-void Core::addOnDiskUpdateTask(int gameDataId)
+void Core::addOnDiskUpdateTask(int gameDataId, const QSet<const Task*>& dependencies)
 {
     TGeneric* onDiskUpdateTask = new TGeneric(*this);
     onDiskUpdateTask->setStage(Task::Stage::Auxiliary);
@@ -228,12 +336,93 @@ void Core::addOnDiskUpdateTask(int gameDataId)
         return mFlashpointInstall->database()->updateGameDataOnDiskState({gameDataId}, true);
     });
 
-    mTaskQueue.push(onDiskUpdateTask);
-    logTask(onDiskUpdateTask);
+    enqueueTask(onDiskUpdateTask, dependencies);
+}
+
+QSet<const Task*> Core::incompleteTasks(Task::Stage stage) const
+{
+    QSet<const Task*> tasks;
+    for(const Task* t : mIncompleteTasks)
+        if(t->stage() == stage)
+            tasks.insert(t);
+
+    return tasks;
+}
+
+QSet<QString> Core::concurrentServiceEntries(const QString& key) const
+{
+    // Optional, CLIFp specific, file that sits next to the executable
+    QFile overlayFile(CLIFP_DIR_PATH + '/' + SERVICES_OVERLAY_FILE_NAME);
+    if(!overlayFile.open(QIODevice::ReadOnly))
+        return {};
+
+    const QJsonArray entries = QJsonDocument::fromJson(overlayFile.readAll()).object().value(key).toArray();
+    QSet<QString> names;
+    for(const QJsonValue& e : entries)
+        names.insert(e.toString().toLower());
+
+    return names;
+}
+
+void Core::enqueueServiceEntries(const QList<Fp::StartStop>& entries, Task::Stage stage, const QSet<QString>& concurrent)
+{
+    /* Entries run one after another by default. Consecutive entries marked as concurrent form a group that
+     * all wait on what came before the group, but not each other, and whatever follows waits on the whole group.
+     */
+    bool allConcurrent = concurrent.contains(u"*"_s);
+    std::optional<QSet<const Task*>> groupDeps;
+    qsizetype groupSize = 0;
+
+    auto closeGroup = [&]{
+        if(groupSize > 1)
+            logEvent(LOG_EVENT_SERVICE_GROUP.arg(groupSize).arg(ENUM_NAME(stage)));
+        groupDeps.reset();
+        groupSize = 0;
+    };
+
+    for(const Fp::StartStop& entry : entries)
+    {
+        TExec* serviceTask = new TExec(*this);
+        serviceTask->setIdentifier(entry.filename);
+        serviceTask->setStage(stage);
+        serviceTask->setExecutable(entry.filename);
+        serviceTask->setDirectory(mFlashpointInstall->dir().absoluteFilePath(entry.path));
+        serviceTask->setParameters(entry.arguments);
+        serviceTask->setProcessType(TExec::ProcessType::Blocking);
+
+        if(allConcurrent || concurrent.contains(QFileInfo(entry.filename).fileName().toLower()))
+        {
+            if(!groupDeps)
+                groupDeps = QSet<const Task*>(mIncompleteTasks.cbegin(), mIncompleteTasks.cend());
+
+            enqueueTask(serviceTask, *groupDeps);
+            groupSize++;
+        }
+        else
+        {
+            closeGroup();
+            enqueueSingleTask(serviceTask);
+        }
+    }
+
+    closeGroup();
 }
 
 // TODO: Have task have a toString function/operator instead of "members()" (or make members() private and have toString() use that)
-void Core::logTask(const Task* task) { logEvent(LOG_EVENT_TASK_ENQ.arg(task->name(), task->members().join(u", "_s))); }
+bool Core::extendPendingTask(const Task* task, const QSet<const Task*>& dependencies)
+{
+    auto itr = std::find_if(mPendingTasks.begin(), mPendingTasks.end(), [task](const TaskNode& n){ return n.task == task; });
+    if(itr == mPendingTasks.end())
+        return false; // Already underway or done
+
+    for(const Task* d : dependencies)
+        if(d != task && mIncompleteTasks.contains(d))
+            itr->blockers.insert(d);
+
+    return true;
+}
+
+void Core::logTask(const Task* task) { logDebug(LOG_EVENT_TASK_ENQ, task->name(), [task]{ return task->members(); }); }
 
 //Public:
 Qx::Error Core::initialize(QStringList& commandLine)
@@ -243,9 +432,7 @@ Qx::Error Core::initialize(QStringList& commandLine)
 
     // Setup CLI Parser
     QCommandLineParser clParser;
-    clParser.setOptionsAfterPositionalArgumentsMode(QCommandLineParser::ParseAsPositionalArguments);
-    for(const QCommandLineOption* clOption : CL_OPTIONS_ALL)
-        clParser.addOption(*clOption);
+    setupParser(clParser);
 
     // Parse
     bool validArgs = clParser.parse(commandLine);
@@ -270,6 +457,22 @@ Qx::Error Core::initialize(QStringList& commandLine)
     if(globalOptions.isEmpty())
         globalOptions = LOG_NO_PARAMS;
 
+    // Start tracing as early as possible
+    if(clParser.isSet(CL_OPTION_TRACE))
+        mDirector.tracer()->enable(QFileInfo(clParser.value(CL_OPTION_TRACE)).absoluteFilePath());
+
+    // Apply the log level before anything is recorded so that it covers the whole run
+    std::optional<Director::LogLevel> logLevel;
+    if(clParser.isSet(CL_OPTION_LOG_LEVEL))
+    {
+        logLevel = magic_enum::enum_cast<Director::LogLevel>(clParser.value(CL_OPTION_LOG_LEVEL).toStdString(), magic_enum::case_insensitive);
+        if(logLevel)
+            mDirector.setLogLevel(*logLevel);
+    }
+
+    if(clParser.isSet(CL_OPTION_EVENT_LOG))
+        mDirector.enableEventLog();
+
     // Remove app name from command line string
     commandLine.removeFirst();
 
@@ -293,6 +496,32 @@ Qx::Error Core::initialize(QStringList& commandLine)
         return err;
     }
 
+    if(clParser.isSet(CL_OPTION_LOG_LEVEL) && !logLevel)
+    {
+        commandLine.clear();
+        showHelp();
+
+        CoreError err(CoreError::InvalidOptions, LOG_ERR_INVALID_LOG_LEVEL.arg(clParser.value(CL_OPTION_LOG_LEVEL)));
+        postDirective<DError>(err);
+        return err;
+    }
+
+    if(clParser.isSet(CL_OPTION_PROGRESS_RATE))
+    {
+        bool ok;
+        int rate = clParser.value(CL_OPTION_PROGRESS_RATE).toInt(&ok);
+        if(!ok || rate < 0)
+        {
+            commandLine.clear();
+            showHelp();
+
+            CoreError err(CoreError::InvalidOptions, LOG_ERR_INVALID_PROGRESS_RATE.arg(clParser.value(CL_OPTION_PROGRESS_RATE)));
+            postDirective<DError>(err);
+            return err;
+        }
+        mDirector.setProgressRate(rate);
+    }
+
     // Handle each global option
     Director::Verbosity v = clParser.isSet(CL_OPTION_SILENT) ? Director::Verbosity::Silent :
                             clParser.isSet(CL_OPTION_QUIET) ? Director::Verbosity::Quiet : Director::Verbosity::Full;
@@ -326,41 +555,37 @@ Qx::Error Core::initialize(QStringList& commandLine)
     return CoreError();
 }
 
-void Core::setServicesMode(ServicesMode mode)
+void Core::setServicesMode(ServicesMode mode, quint32 launcherPid)
 {
     logEvent(LOG_EVENT_MODE_SET.arg(ENUM_NAME(mode)));
     mServicesMode = mode;
 
     if(mode == ServicesMode::Companion)
-        watchLauncher();
+        watchLauncher(launcherPid);
 }
 
-void Core::watchLauncher()
+void Core::watchLauncher(quint32 launcherPid)
 {
     logEvent(LOG_EVENT_LAUNCHER_WATCH);
 
-    using namespace std::chrono_literals;
+    // Event driven, so the launcher closing is noticed right away without any polling
     mLauncherWatcher.setProcessName(Fp::Install::LAUNCHER_NAME);
-#ifdef __linux__
-    mLauncherWatcher.setPollRate(1s); // Generous rate since while we need to know quickly, we don't THAT quickly
-#endif
-    connect(&mLauncherWatcher, &Qx::ProcessBider::established, this, [this]{
-        logEvent(LOG_EVENT_LAUNCHER_WATCH_HOOKED);
+    connect(&mLauncherWatcher, &ProcessWatcher::established, this, [this](quint32 pid, ProcessWatcher::Method method){
+        logEvent(LOG_EVENT_LAUNCHER_WATCH_HOOKED.arg(pid).arg(ENUM_NAME(method)));
     });
-    connect(&mLauncherWatcher, &Qx::ProcessBider::errorOccurred, this, [this](Qx::ProcessBiderError err){
-        logError(err);
-    });
-    connect(&mLauncherWatcher, &Qx::ProcessBider::finished, this, [this]{
+    connect(&mLauncherWatcher, &ProcessWatcher::finished, this, [this]{
         // Launcher closed (or can't be hooked), need to bail
         CoreError err(CoreError::CompanionModeLauncherClose, LOG_EVENT_LAUNCHER_CLOSED_RESULT);
         postDirective<DError>(err);
         emit abort(err);
     });
 
-    mLauncherWatcher.start();
-    // The bide is automatically abandoned when core, and therefore the bider, is destroyed
+    mLauncherWatcher.start(launcherPid);
+    // The watch is automatically abandoned when core, and therefore the watcher, is destroyed
 }
 
+void Core::setBaseProcessEnvironment(const QProcessEnvironment& environment) { mBaseProcEnv = environment; }
+
 void Core::attachFlashpoint(std::unique_ptr<Fp::Install> flashpointInstall)
 {
     // Capture install
@@ -374,37 +599,56 @@ void Core::attachFlashpoint(std::unique_ptr<Fp::Install> flashpointInstall)
     logEvent(LOG_EVENT_OUTFITTED_DAEMON.arg(ENUM_NAME(mFlashpointInstall->outfittedDaemon())));
 
     // Initialize child process env vars
-    QProcessEnvironment de = QProcessEnvironment::systemEnvironment();
+    QProcessEnvironment de = mBaseProcEnv;
     const QString fpPath = mFlashpointInstall->dir().absolutePath();
 
 #ifdef __linux__
     //-Mimic startup script setup-------------------------
     logEvent(LOG_EVENT_LINUX_SPECIFIC_STARTUP_STEPS);
 
-    // NOTE: This check likely will need to be modified over time, though it's close to how the script does it
+    /* The additions only depend on the install, since PATH and LD_LIBRARY_PATH are replaced outright rather than
+     * extended, so reuse those from the last run if it hasn't changed
+     */
     QDir librariesDir(mFlashpointInstall->dir().absoluteFilePath(u"Libraries"_s));
-    bool immutable = !librariesDir.entryList({"*.so"}, QDir::Files).isEmpty();
-    logEvent(LOG_EVENT_LINUX_BUILD_TYPE.arg(immutable ? u"isn't"_s : u"is"_s));
+    qint64 librariesModified = QFileInfo(librariesDir.absolutePath()).lastModified().toMSecsSinceEpoch();
 
-    if(immutable)
+    EnvironmentSnapshot snapshot;
+    if(snapshot.load() && snapshot.matches(fpPath, librariesModified))
+        logEvent(LOG_EVENT_ENV_SNAPSHOT_HIT);
+    else
     {
-        de.insert(u"GDK_PIXBUF_MODULE_FILE"_s, fpPath + u"/Libraries/loader.cache"_s);
-        de.insert(u"GSETTINGS_SCHEMA_DIR"_s, fpPath + u"/Libraries"_s);
-        de.insert(u"LD_LIBRARY_PATH"_s, fpPath + u"/Libraries"_s);
-        de.insert(u"LIBGL_DRIVERS_PATH"_s, fpPath + u"/Libraries"_s);
+        snapshot = {.installPath = fpPath, .librariesModified = librariesModified};
+
+        // NOTE: This check likely will need to be modified over time, though it's close to how the script does it
+        snapshot.immutable = !librariesDir.entryList({"*.so"}, QDir::Files).isEmpty();
+        if(snapshot.immutable)
+        {
+            snapshot.vars = {
+                {u"GDK_PIXBUF_MODULE_FILE"_s, fpPath + u"/Libraries/loader.cache"_s},
+                {u"GSETTINGS_SCHEMA_DIR"_s, fpPath + u"/Libraries"_s},
+                {u"LD_LIBRARY_PATH"_s, fpPath + u"/Libraries"_s},
+                {u"LIBGL_DRIVERS_PATH"_s, fpPath + u"/Libraries"_s},
+                /* Completely override PATH for child processes.
+                 * Currently we fully override our own path too, but if this breaks things, then we should only prepend the change to our own path.
+                 *
+                 * The addition of the WINE path is done just before game launch in the vanilla launcher, but there shouldn't be an issue doing it here.
+                 */
+                {u"PATH"_s, fpPath + u"/FPSoftware/Wine/bin:"_s + fpPath + u"/Libraries"_s}
+            };
+        }
+        snapshot.vars.append({u"WINEPREFIX"_s, fpPath + u"/FPSoftware/Wine"_s});
 
-        /* Completely override PATH for child processes.
-         * Currently we fully override our own path too, but if this breaks things, then we should only prepend the change to our own path.
-         *
-         * The addition of the WINE path is done just before game launch in the vanilla launcher, but there shouldn't be an issue doing it here.
-         */
-        QString pathChange = fpPath + u"/FPSoftware/Wine/bin:"_s +
-                             fpPath + u"/Libraries"_s;
-        de.insert(u"PATH"_s, pathChange);
-        qputenv("PATH", pathChange.toLocal8Bit());
+        snapshot.save();
+        logEvent(LOG_EVENT_ENV_SNAPSHOT_MISS);
     }
+    logEvent(LOG_EVENT_LINUX_BUILD_TYPE.arg(snapshot.immutable ? u"isn't"_s : u"is"_s));
 
-    de.insert(u"WINEPREFIX"_s, fpPath + u"/FPSoftware/Wine"_s);
+    for(const auto& [var, value] : std::as_const(snapshot.vars))
+    {
+        de.insert(var, value);
+        if(var == u"PATH"_s)
+            qputenv("PATH", value.toLocal8Bit());
+    }
 #endif
 
     TExec::setDefaultProcessEnvironment(de);
@@ -437,6 +681,27 @@ void Core::attachFlashpoint(std::unique_ptr<Fp::Install> flashpointInstall)
         mGamesArchive = std::make_unique<ArchiveAccess>(*this, ArchiveAccess::GameData);
 }
 
+std::unique_ptr<Fp::Install> Core::detachFlashpoint()
+{
+    // Archive access is tied to this core's director, so it doesn't travel with the install
+    mGamesArchive.reset();
+    return std::move(mFlashpointInstall);
+}
+
+void Core::attachLocalHttpClient(std::unique_ptr<LocalHttpClient> client)
+{
+    // Keeps its open connections, but now reports to this core
+    mLocalHttpClient = std::move(client);
+    mLocalHttpClient->setDirector(&mDirector);
+}
+
+std::unique_ptr<LocalHttpClient> Core::detachLocalHttpClient()
+{
+    if(mLocalHttpClient)
+        mLocalHttpClient->setDirector(nullptr);
+    return std::move(mLocalHttpClient);
+}
+
 QString Core::resolveFullAppPath(const QString& appPath, const QString& platform)
 {
     // We don't have a browser mode. Since Electron bundles chromium, chrome should give the closest experience to the launcher's browser mode.
@@ -498,8 +763,7 @@ CoreError Core::enqueueStartupTasks(const QString& serverOverride)
         xhostSet->setParameters({u"+SI:localuser:root"_s});
         xhostSet->setProcessType(TExec::ProcessType::Blocking);
 
-        mTaskQueue.push(xhostSet);
-        logTask(xhostSet);
+        enqueueSingleTask(xhostSet);
     }
 #endif
 
@@ -510,19 +774,7 @@ CoreError Core::enqueueStartupTasks(const QString& serverOverride)
     Fp::Preferences fpPreferences = mFlashpointInstall->preferences();
 
     // Add Start entries from services
-    for(const Fp::StartStop& startEntry : std::as_const(fpServices.start))
-    {
-        TExec* currentTask = new TExec(*this);
-        currentTask->setIdentifier(startEntry.filename);
-        currentTask->setStage(Task::Stage::Startup);
-        currentTask->setExecutable(startEntry.filename);
-        currentTask->setDirectory(mFlashpointInstall->dir().absoluteFilePath(startEntry.path));
-        currentTask->setParameters(startEntry.arguments);
-        currentTask->setProcessType(TExec::ProcessType::Blocking);
-
-        mTaskQueue.push(currentTask);
-        logTask(currentTask);
-    }
+    enqueueServiceEntries(fpServices.start, Task::Stage::Startup, concurrentServiceEntries(SERVICES_OVERLAY_KEY_START));
 
     // Add Server entry from services if applicable
     if(fpConfig.startServer)
@@ -550,8 +802,7 @@ CoreError Core::enqueueStartupTasks(const QString& serverOverride)
             serverTask->setParameters(server.arguments);
             serverTask->setProcessType(server.kill ? TExec::ProcessType::Deferred : TExec::ProcessType::Detached);
 
-            mTaskQueue.push(serverTask);
-            logTask(serverTask);
+            enqueueSingleTask(serverTask);
         }
     }
 
@@ -566,8 +817,7 @@ CoreError Core::enqueueStartupTasks(const QString& serverOverride)
         currentTask->setParameters(d.arguments);
         currentTask->setProcessType(d.kill ? TExec::ProcessType::Deferred : TExec::ProcessType::Detached);
 
-        mTaskQueue.push(currentTask);
-        logTask(currentTask);
+        enqueueSingleTask(currentTask);
     }
 
 #ifdef __linux__
@@ -580,22 +830,35 @@ CoreError Core::enqueueStartupTasks(const QString& serverOverride)
         dockerWait->setImageName(u"gamezip"_s);
         dockerWait->setTimeout(10000);
 
-        mTaskQueue.push(dockerWait);
-        logTask(dockerWait);
+        enqueueSingleTask(dockerWait);
     }
 #endif
 
     /* Make sure that all startup processes have fully initialized.
      *
-     * This is especially important for docker, as the mount server inside seems to take an extra moment to initialize (gives
-     * "Connection Closed" if a mount attempt is made right away).
+     * Where the daemon's port can be probed that is done so the launch continues as soon as it accepts connections;
+     * otherwise fall back to a fixed delay. Docker and QEMU are among the latter, as their port forwarding accepts
+     * connections before the servers inside are up (Docker gives "Connection Closed" if a mount attempt is made
+     * right away).
      */
-    TSleep* initDelay = new TSleep(*this);
-    initDelay->setStage(Task::Stage::Startup);
-    initDelay->setDuration(1500); // NOTE: Might need to be made longer
+    QList<TAwaitReady::Endpoint> readyEndpoints = daemonEndpoints(mFlashpointInstall->outfittedDaemon());
+    if(!readyEndpoints.isEmpty())
+    {
+        TAwaitReady* initAwait = new TAwaitReady(*this);
+        initAwait->setStage(Task::Stage::Startup);
+        initAwait->setEndpoints(readyEndpoints);
+        initAwait->setTimeout(10000);
+
+        enqueueSingleTask(initAwait);
+    }
+    else
+    {
+        TSleep* initDelay = new TSleep(*this);
+        initDelay->setStage(Task::Stage::Startup);
+        initDelay->setDuration(1500); // NOTE: Might need to be made longer
 
-    mTaskQueue.push(initDelay);
-    logTask(initDelay);
+        enqueueSingleTask(initDelay);
+    }
 
     // Return success
     return CoreError();
@@ -612,19 +875,7 @@ void Core::enqueueShutdownTasks()
     }
 
     // Add Stop entries from services
-    for(const Fp::StartStop& stopEntry : qxAsConst(mFlashpointInstall->services().stop))
-    {
-        TExec* shutdownTask = new TExec(*this);
-        shutdownTask->setIdentifier(stopEntry.filename);
-        shutdownTask->setStage(Task::Stage::Shutdown);
-        shutdownTask->setExecutable(stopEntry.filename);
-        shutdownTask->setDirectory(mFlashpointInstall->dir().absoluteFilePath(stopEntry.path));
-        shutdownTask->setParameters(stopEntry.arguments);
-        shutdownTask->setProcessType(TExec::ProcessType::Blocking);
-
-        mTaskQueue.push(shutdownTask);
-        logTask(shutdownTask);
-    }
+    enqueueServiceEntries(mFlashpointInstall->services().stop, Task::Stage::Shutdown, concurrentServiceEntries(SERVICES_OVERLAY_KEY_STOP));
 
 #ifdef __linux__
     // Undo xhost permissions modifications related to docker
@@ -638,8 +889,7 @@ void Core::enqueueShutdownTasks()
         xhostClear->setParameters({"-SI:localuser:root"});
         xhostClear->setProcessType(TExec::ProcessType::Blocking);
 
-        mTaskQueue.push(xhostClear);
-        logTask(xhostClear);
+        enqueueSingleTask(xhostClear);
     }
 #endif
 }
@@ -654,6 +904,10 @@ Qx::Error Core::enqueueDataPackTasks(const Fp::GameData& gameData)
     QString packFilename = tk->datapackFilename(gameData);
     logEvent(LOG_EVENT_DATA_PACK_PATH.arg(packPath));
 
+    // Tasks that must finish before the pack can be used
+    QSet<const Task*> packAcquisition;
+    TDownload* packDownload = nullptr;
+
     // Try to acquire data pack if it's not present
     if(!tk->datapackIsPresent(gameData))
     {
@@ -662,12 +916,6 @@ Qx::Error Core::enqueueDataPackTasks(const Fp::GameData& gameData)
         auto edition = mFlashpointInstall->versionInfo()->edition();
         if(edition == Fp::Install::VersionInfo::Ultimate)
         {
-            /* TODO: Might want to make all of this its own task, and have a static, singleton, manager
-             * type (e.g. ArchiveAccessManager) that holds the archive instances, instead of core,
-             * which is then used by that task, and then here we just setup the task. This way we
-             * can also have more specific errors instead of just the one (with events).
-             */
-
             /* TODO: Need to step through a debug build, as despite what the source looks like, the real
              * thing seems like it doesn't save the game data to disk, but instead uses it directly as-is.
              * Pulling it from the archive is fine for now though as it's unlikely to add up to much for
@@ -676,34 +924,19 @@ Qx::Error Core::enqueueDataPackTasks(const Fp::GameData& gameData)
             Q_ASSERT(mGamesArchive);
             logEvent(LOG_EVENT_DATA_PACK_FROM_ARCHIVE);
 
-            // Check archive
-            QByteArray datapackData = mGamesArchive->getFileContents(DATA_PACK_FROM_ARCHIVE_TEMPLATE.arg(packFilename));
-            if(datapackData.isEmpty())
-            {
-                logEvent(LOG_EVENT_DATA_PACK_FROM_ARCHIVE_NOT_FOUND);
-                CoreError err(CoreError::CannotObtainDatapack);
-                postDirective<DError>(err);
-                return err;
-            }
+            TArchiveFetch* fetchTask = new TArchiveFetch(*this);
+            fetchTask->setStage(Task::Stage::Auxiliary);
+            fetchTask->setArchive(mGamesArchive.get());
+            fetchTask->setPathInArchive(DATA_PACK_FROM_ARCHIVE_TEMPLATE.arg(packFilename));
+            fetchTask->setDestinationPath(packPath);
+            fetchTask->setSha256(gameData.sha256());
 
-            logEvent(LOG_EVENT_DATA_PACK_FROM_ARCHIVE_FOUND);
-            if(gameData.sha256().compare(Qx::Integrity::generateChecksum(datapackData, QCryptographicHash::Sha256), Qt::CaseInsensitive) != 0)
-            {
-                logEvent(LOG_EVENT_DATA_PACK_FROM_ARCHIVE_CORRUPT);
-                CoreError err(CoreError::CannotObtainDatapack);
-                postDirective<DError>(err);
-                return err;
-            }
-
-            // Save to disk
-            QFile packFile(packPath);
-            if(auto writeOp = Qx::writeBytesToFile(packFile, datapackData); writeOp.isFailure())
-                return writeOp;
-
-            logEvent(LOG_EVENT_DATA_PACK_FROM_ARCHIVE_SAVED);
+            // Like a download, this overlaps with service startup
+            enqueueTask(fetchTask, {});
+            packAcquisition.insert(fetchTask);
 
             // Add task to update DB with onDiskState
-            addOnDiskUpdateTask(gameData.id());
+            addOnDiskUpdateTask(gameData.id(), {fetchTask});
         }
         else // Basically just Infinity
         {
@@ -717,11 +950,13 @@ Qx::Error Core::enqueueDataPackTasks(const Fp::GameData& gameData)
                 return packError;
             }
 
-            mTaskQueue.push(downloadTask);
-            logTask(downloadTask);
+            // Nothing needs to happen first, so this overlaps with service startup
+            enqueueTask(downloadTask, {});
+            packAcquisition.insert(downloadTask);
+            packDownload = downloadTask;
 
             // Add task to update DB with onDiskState
-            addOnDiskUpdateTask(gameData.id());
+            addOnDiskUpdateTask(gameData.id(), {downloadTask});
         }
     }
     else
@@ -749,39 +984,113 @@ Qx::Error Core::enqueueDataPackTasks(const Fp::GameData& gameData)
             extractTask->setPathInPack(u"content"_s);
             extractTask->setDestinationPath(extractRoot.absolutePath());
 
-            mTaskQueue.push(extractTask);
-            logTask(extractTask);
+            // Extract as the pack arrives, the task itself still waits for the verified download
+            if(packDownload)
+                extractTask->setStreamSource(packDownload);
+
+            enqueueTask(extractTask, packAcquisition);
         }
     }
     else
     {
         logEvent(LOG_EVENT_DATA_PACK_NEEDS_MOUNT);
 
-        // Create task
-        TMount* mountTask = new TMount(*this);
-        mountTask->setStage(Task::Stage::Auxiliary);
-        mountTask->setTitleId(gameData.gameId());
-        mountTask->setPath(packPath);
-        mountTask->setDaemon(mFlashpointInstall->outfittedDaemon());
+        // Also needs the services to be up
+        QSet<const Task*> mountDeps = packAcquisition + incompleteTasks(Task::Stage::Startup);
 
-        mTaskQueue.push(mountTask);
-        logTask(mountTask);
+        // Join the mount that hasn't started yet if there is one, so that all packs go out together
+        if(mBatchMount && extendPendingTask(mBatchMount, mountDeps))
+        {
+            logEvent(LOG_EVENT_DATA_PACK_JOINS_MOUNT);
+            mBatchMount->addPack(gameData.gameId(), packPath);
+        }
+        else
+        {
+            // Create task
+            TMount* mountTask = new TMount(*this);
+            mountTask->setStage(Task::Stage::Auxiliary);
+            mountTask->addPack(gameData.gameId(), packPath);
+            mountTask->setDaemon(mFlashpointInstall->outfittedDaemon());
+
+            enqueueTask(mountTask, mountDeps);
+            mBatchMount = mountTask;
+        }
     }
 
     // Return success
     return CoreError();
 }
 
-void Core::enqueueSingleTask(Task* task) { mTaskQueue.push(task); logTask(task); }
+void Core::enqueueSingleTask(Task* task)
+{
+    // Runs after everything enqueued before it, which gives plain queue behavior
+    enqueueTask(task, QSet<const Task*>(mIncompleteTasks.cbegin(), mIncompleteTasks.cend()));
+}
+
+void Core::enqueueTask(Task* task, const QSet<const Task*>& dependencies)
+{
+    Q_ASSERT(!dependencies.contains(task));
+
+    // Dependencies that already completed are of no concern
+    QSet<const Task*> blockers;
+    for(const Task* d : dependencies)
+        if(mIncompleteTasks.contains(d))
+            blockers.insert(d);
+
+    mPendingTasks.push_back({.task = task, .blockers = blockers});
+    mIncompleteTasks.append(task);
+
+    logTask(task);
+    if(!blockers.isEmpty())
+        logDebug(LOG_EVENT_TASK_DEPS, task->name(), blockers.size());
+}
 
 Director* Core::director() { return &mDirector; }
 Core::ServicesMode Core::mode() const { return mServicesMode; }
 Fp::Install& Core::fpInstall() { return *mFlashpointInstall; }
+
+LocalHttpClient* Core::localHttpClient()
+{
+    // Created on first use, then shared by everything for the rest of the run
+    if(!mLocalHttpClient)
+        mLocalHttpClient = std::make_unique<LocalHttpClient>(&mDirector);
+    return mLocalHttpClient.get();
+}
+
+MountCache::Session Core::mountSession()
+{
+    // Finding the server means walking the process table, so only do it until it works once
+    if(!mMountSession.isValid())
+        mMountSession = MountCache::serverSession(TMount::GAME_SERVER_PORT);
+    return mMountSession;
+}
 const QProcessEnvironment& Core::childTitleProcessEnvironment() { return mChildTitleProcEnv; }
-size_t Core::taskCount() const { return mTaskQueue.size(); }
-bool Core::hasTasks() const { return mTaskQueue.size() > 0; }
-Task* Core::frontTask() { return mTaskQueue.front(); }
-void Core::removeFrontTask() { mTaskQueue.pop(); }
+size_t Core::taskCount() const { return mPendingTasks.size(); }
+bool Core::hasTasks() const { return !mPendingTasks.empty(); }
+
+QList<Task*> Core::takeReadyTasks()
+{
+    QList<Task*> ready;
+    for(auto itr = mPendingTasks.begin(); itr != mPendingTasks.end();)
+    {
+        if(itr->blockers.isEmpty())
+        {
+            ready.append(itr->task);
+            itr = mPendingTasks.erase(itr);
+        }
+        else
+            ++itr;
+    }
+
+    return ready;
+}
+
+void Core::completeTask(const Task* task)
+{
+    mIncompleteTasks.removeOne(task);
+    for(TaskNode& node : mPendingTasks)
+        node.blockers.remove(task);
+}
 
 BuildInfo Core::buildInfo() const
 {
@@ -2,7 +2,7 @@
 #define CORE_H
 
 // Standard Library Includes
-#include <queue>
+#include <list>
 
 // Qt Includes
 #include <QString>
@@ -12,12 +12,13 @@
 #include <QUuid>
 
 // Qx Includes
-#include <qx/core/qx-processbider.h>
 
 // Project Includes
 #include "kernel/buildinfo.h"
 #include "kernel/directorate.h"
 #include "task/task.h"
+#include "tools/mountcache.h"
+#include "tools/processwatcher.h"
 #include "_backend_project_vars.h"
 
 /* TODO: It's time to cleanout the old unused mounter support (i.e. docker, QEMU, etc),
@@ -84,9 +85,12 @@ namespace Fp
 {
 class Install;
 class GameData;
+struct StartStop;
 }
 class TExec;
+class TMount;
 class ArchiveAccess;
+class LocalHttpClient;
 
 class Core : public QObject, public Directorate
 {
@@ -95,6 +99,14 @@ class Core : public QObject, public Directorate
 public:
     enum ServicesMode { Standalone, Companion };
 
+//-Class Structs------------------------------------------------------------------------------------------------------
+private:
+    struct TaskNode
+    {
+        Task* task;
+        QSet<const Task*> blockers; // Dependencies that have yet to complete
+    };
+
 //-Class Variables------------------------------------------------------------------------------------------------------
 public:
     // Single Instance ID
@@ -111,6 +123,8 @@ public:
 
     // Logging - Errors
     static inline const QString LOG_ERR_INVALID_PARAM = u"Invalid parameters provided"_s;
+    static inline const QString LOG_ERR_INVALID_LOG_LEVEL = u"Invalid log level \"%1\""_s;
+    static inline const QString LOG_ERR_INVALID_PROGRESS_RATE = u"Invalid progress rate \"%1\""_s;
     static inline const QString LOG_ERR_FAILED_SETTING_RUFFLE_PERMS= u"Failed to mark ruffle as executable!"_s;
 
     // Logging - Messages
@@ -130,26 +144,27 @@ public:
     static inline const QString LOG_EVENT_ENQ_STOP = u"Enqueuing shutdown tasks..."_s;
     static inline const QString LOG_EVENT_ENQ_DATA_PACK = u"Enqueuing Data Pack tasks..."_s;
     static inline const QString LOG_EVENT_TASK_ENQ = u"Enqueued %1: {%2}"_s;
+    static inline const QString LOG_EVENT_TASK_DEPS = u"%1 depends on %2 earlier task(s)"_s;
     static inline const QString LOG_EVENT_DATA_PACK_PATH = u"Title Data Pack path is: %1"_s;
     static inline const QString LOG_EVENT_DATA_PACK_MISS = u"Title Data Pack is not available locally"_s;
     static inline const QString LOG_EVENT_DATA_PACK_FOUND = u"Title Data Pack with correct hash is already present, no need to download"_s;
     static inline const QString LOG_EVENT_DATA_PACK_NEEDS_MOUNT = u"Title Data Pack requires mounting"_s;
+    static inline const QString LOG_EVENT_DATA_PACK_JOINS_MOUNT = u"Title Data Pack added to pending mount"_s;
     static inline const QString LOG_EVENT_DATA_PACK_NEEDS_EXTRACT = u"Title Data Pack requires extraction"_s;
     static inline const QString LOG_EVENT_DATA_PACK_ALREADY_EXTRACTED = u"Extracted files already present"_s;
     static inline const QString LOG_EVENT_DATA_PACK_FROM_ARCHIVE = u"Retrieving Data Pack from archive"_s;
-    static inline const QString LOG_EVENT_DATA_PACK_FROM_ARCHIVE_NOT_FOUND = u"Data Pack could not be found in the archive!"_s;
-    static inline const QString LOG_EVENT_DATA_PACK_FROM_ARCHIVE_CORRUPT = u"Data Pack from archive is corrupted!"_s;
-    static inline const QString LOG_EVENT_DATA_PACK_FROM_ARCHIVE_FOUND = u"Data Pack found in archive."_s;
-    static inline const QString LOG_EVENT_DATA_PACK_FROM_ARCHIVE_SAVED = u"Sourced Data Pack from archive."_s;
     static inline const QString LOG_EVENT_APP_PATH_ALT = u"App path \"%1\" maps to alternative \"%2\"."_s;
+    static inline const QString LOG_EVENT_SERVICE_GROUP = u"%1 %2 service entries will run concurrently"_s;
     static inline const QString LOG_EVENT_SERVICES_FROM_LAUNCHER = u"Using services from standard Launcher due to companion mode."_s;
-    static inline const QString LOG_EVENT_LAUNCHER_WATCH = u"Starting bide on Launcher process..."_s;
-    static inline const QString LOG_EVENT_LAUNCHER_WATCH_HOOKED = u"Launcher hooked for waiting"_s;
+    static inline const QString LOG_EVENT_LAUNCHER_WATCH = u"Starting watch on Launcher process..."_s;
+    static inline const QString LOG_EVENT_LAUNCHER_WATCH_HOOKED = u"Launcher ( %1 ) hooked for waiting via %2"_s;
     static inline const QString LOG_EVENT_LAUNCHER_CLOSED_RESULT = u"CLIFp cannot continue running in companion mode without the launcher's services."_s;
 
     // Logging - Linux Specific Startup Steps
     static inline const QString LOG_EVENT_LINUX_SPECIFIC_STARTUP_STEPS= u"Handling Linux specific startup steps..."_s;
     static inline const QString LOG_EVENT_LINUX_BUILD_TYPE = u"Linux build %1 mutable."_s;
+    static inline const QString LOG_EVENT_ENV_SNAPSHOT_HIT = u"Reusing startup environment snapshot"_s;
+    static inline const QString LOG_EVENT_ENV_SNAPSHOT_MISS = u"Derived startup environment and saved snapshot"_s;
     static inline const QString LOG_EVENT_LINUX_GTK3_MISSING = u"GTK3 isn't installed, setting GTK_USE_PORTAL=1"_s;
     static inline const QString LOG_EVENT_LINUX_SERVER_NOOP = u"Skipping server start ('read' no-op detected)"_s;
 
@@ -179,13 +194,32 @@ public:
     static inline const QString CL_OPT_SILENT_L_NAME = u"silent"_s;
     static inline const QString CL_OPT_SILENT_DESC = u"Silences all messages (takes precedence over quiet mode)."_s;
 
+    static inline const QString CL_OPT_TRACE_L_NAME = u"trace"_s;
+    static inline const QString CL_OPT_TRACE_VALUE = u"file"_s;
+    static inline const QString CL_OPT_TRACE_DESC = u"Records a timeline of the run to the given file, viewable with Perfetto (ui.perfetto.dev) or chrome://tracing."_s;
+
+    static inline const QString CL_OPT_EVENT_LOG_L_NAME = u"event-log"_s;
+    static inline const QString CL_OPT_EVENT_LOG_DESC = u"Also records the log as structured events (JSON lines) for use with clifp-logq."_s;
+
+    static inline const QString CL_OPT_PROGRESS_RATE_L_NAME = u"progress-rate"_s;
+    static inline const QString CL_OPT_PROGRESS_RATE_VALUE = u"hz"_s;
+    static inline const QString CL_OPT_PROGRESS_RATE_DESC = u"Limits how often progress is updated per second, 0 for no limit (default: 30)."_s;
+
+    static inline const QString CL_OPT_LOG_LEVEL_L_NAME = u"log-level"_s;
+    static inline const QString CL_OPT_LOG_LEVEL_VALUE = u"trace|debug|info"_s;
+    static inline const QString CL_OPT_LOG_LEVEL_DESC = u"Sets how much detail is recorded in the log (default: debug)."_s;
+
     // Global command line options
     static inline const QCommandLineOption CL_OPTION_HELP{{CL_OPT_HELP_S_NAME, CL_OPT_HELP_E_NAME, CL_OPT_HELP_L_NAME}, CL_OPT_HELP_DESC}; // Boolean option
     static inline const QCommandLineOption CL_OPTION_VERSION{{CL_OPT_VERSION_S_NAME, CL_OPT_VERSION_L_NAME}, CL_OPT_VERSION_DESC}; // Boolean option
     static inline const QCommandLineOption CL_OPTION_QUIET{{CL_OPT_QUIET_S_NAME, CL_OPT_QUIET_L_NAME}, CL_OPT_QUIET_DESC}; // Boolean option
     static inline const QCommandLineOption CL_OPTION_SILENT{{CL_OPT_SILENT_S_NAME, CL_OPT_SILENT_L_NAME}, CL_OPT_SILENT_DESC}; // Boolean option
+    static inline const QCommandLineOption CL_OPTION_TRACE{{CL_OPT_TRACE_L_NAME}, CL_OPT_TRACE_DESC, CL_OPT_TRACE_VALUE}; // Takes value
+    static inline const QCommandLineOption CL_OPTION_EVENT_LOG{{CL_OPT_EVENT_LOG_L_NAME}, CL_OPT_EVENT_LOG_DESC}; // Boolean option
+    static inline const QCommandLineOption CL_OPTION_PROGRESS_RATE{{CL_OPT_PROGRESS_RATE_L_NAME}, CL_OPT_PROGRESS_RATE_DESC, CL_OPT_PROGRESS_RATE_VALUE}; // Takes value
+    static inline const QCommandLineOption CL_OPTION_LOG_LEVEL{{CL_OPT_LOG_LEVEL_L_NAME}, CL_OPT_LOG_LEVEL_DESC, CL_OPT_LOG_LEVEL_VALUE}; // Takes value
 
-    static inline const QList<const QCommandLineOption*> CL_OPTIONS_ALL{&CL_OPTION_HELP, &CL_OPTION_VERSION, &CL_OPTION_QUIET, &CL_OPTION_SILENT};
+    static inline const QList<const QCommandLineOption*> CL_OPTIONS_ALL{&CL_OPTION_HELP, &CL_OPTION_VERSION, &CL_OPTION_QUIET, &CL_OPTION_SILENT, &CL_OPTION_TRACE, &CL_OPTION_EVENT_LOG, &CL_OPTION_LOG_LEVEL, &CL_OPTION_PROGRESS_RATE};
     static inline const QSet<const QCommandLineOption*> CL_OPTIONS_ACTIONABLE{&CL_OPTION_HELP, &CL_OPTION_VERSION};
 
     // Help template
@@ -219,6 +253,12 @@ public:
     // Meta
     static inline const QString NAME = u"core"_s;
 
+private:
+    // Services overlay
+    static inline const QString SERVICES_OVERLAY_FILE_NAME = u"clifp-services.json"_s;
+    static inline const QString SERVICES_OVERLAY_KEY_START = u"concurrentStart"_s;
+    static inline const QString SERVICES_OVERLAY_KEY_STOP = u"concurrentStop"_s;
+
 //-Instance Variables------------------------------------------------------------------------------------------------------
 private:
     // Director
@@ -227,14 +267,19 @@ private:
     // Handles
     std::unique_ptr<Fp::Install> mFlashpointInstall;
     std::unique_ptr<ArchiveAccess> mGamesArchive;
+    std::unique_ptr<LocalHttpClient> mLocalHttpClient;
 
     // Processing
     ServicesMode mServicesMode;
-    std::queue<Task*> mTaskQueue;
+    std::list<TaskNode> mPendingTasks; // In enqueue order
+    QList<const Task*> mIncompleteTasks; // Pending or underway, in enqueue order
+    TMount* mBatchMount; // Most recent mount task, gathers further packs while it's still pending
+    MountCache::Session mMountSession; // Looked up by the first mount that needs it
 
     // Other
+    QProcessEnvironment mBaseProcEnv; // What child processes inherit before the install's additions
     QProcessEnvironment mChildTitleProcEnv;
-    Qx::ProcessBider mLauncherWatcher;
+    ProcessWatcher mLauncherWatcher;
 
 //-Constructor----------------------------------------------------------------------------------------------------------
 public:
@@ -244,6 +289,13 @@ public:
 public:
     ~Core();
 
+//-Class Functions------------------------------------------------------------------------------------------------------
+private:
+    static void setupParser(QCommandLineParser& clParser);
+
+public:
+    static QString commandName(const QStringList& commandLine); // Command the arguments invoke, skipping global options
+
 //-Instance Functions------------------------------------------------------------------------------------------------------
 private:
     QString name() const override;
@@ -253,15 +305,23 @@ private:
 
     // Helper
     Qx::Error searchAndFilterEntity(QUuid& returnBuffer, QString name, bool exactName, QUuid parent = QUuid());
-    void addOnDiskUpdateTask(int gameDataId);
+    void addOnDiskUpdateTask(int gameDataId, const QSet<const Task*>& dependencies);
+    QSet<const Task*> incompleteTasks(Task::Stage stage) const;
+    bool extendPendingTask(const Task* task, const QSet<const Task*>& dependencies);
+    QSet<QString> concurrentServiceEntries(const QString& key) const;
+    void enqueueServiceEntries(const QList<Fp::StartStop>& entries, Task::Stage stage, const QSet<QString>& concurrent);
     void logTask(const Task* task);
 
 public:
     // Setup
     Qx::Error initialize(QStringList& commandLine);
-    void setServicesMode(ServicesMode mode = ServicesMode::Standalone);
-    void watchLauncher();
+    void setServicesMode(ServicesMode mode = ServicesMode::Standalone, quint32 launcherPid = 0);
+    void watchLauncher(quint32 launcherPid = 0);
+    void setBaseProcessEnvironment(const QProcessEnvironment& environment); // Must be called before attachFlashpoint()
     void attachFlashpoint(std::unique_ptr<Fp::Install> flashpointInstall);
+    std::unique_ptr<Fp::Install> detachFlashpoint();
+    void attachLocalHttpClient(std::unique_ptr<LocalHttpClient> client);
+    std::unique_ptr<LocalHttpClient> detachLocalHttpClient();
 
     // Helper (TODO: Move some of these to libfp Toolkit)
     QString resolveFullAppPath(const QString& appPath, const QString& platform);
@@ -274,16 +334,19 @@ public:
     void enqueueShutdownTasks();
     Qx::Error enqueueDataPackTasks(const Fp::GameData& gameData);
     void enqueueSingleTask(Task* task);
+    void enqueueTask(Task* task, const QSet<const Task*>& dependencies);
 
     // Member access
     Director* director();
     ServicesMode mode() const;
     Fp::Install& fpInstall();
+    LocalHttpClient* localHttpClient();
+    MountCache::Session mountSession();
     const QProcessEnvironment& childTitleProcessEnvironment();
     size_t taskCount() const;
     bool hasTasks() const;
-    Task* frontTask();
-    void removeFrontTask();
+    QList<Task*> takeReadyTasks();
+    void completeTask(const Task* task);
 
     // Other
     BuildInfo buildInfo() const;
@@ -39,13 +39,19 @@ QString DirectorError::deriveSecondary() const { return mSpecific; }
 //-Constructor-------------------------------------------------------------
 //Public:
 Director::Director() :
-    mLogger(CLIFP_DIR_PATH + '/' + CLIFP_CUR_APP_BASENAME  + '.' + LOG_FILE_EXT),
+    mLogger(CLIFP_DIR_PATH + '/' + CLIFP_CUR_APP_BASENAME + LOG_DIR_SUFFIX),
     mVerbosity(Verbosity::Full),
-    mCriticalErrorOccurred(false)
+    mLogLevel(DEFAULT_LOG_LEVEL),
+    mCriticalErrorOccurred(false),
+    mProgressInterval(1000 / DEFAULT_PROGRESS_RATE),
+    mProgressTimer(this)
 {
     bool established = establishCanonDirector(*this);
     Q_ASSERT(established);  // No reason for more than one Director currently
 
+    mProgressTimer.setSingleShot(true);
+    connect(&mProgressTimer, &QTimer::timeout, this, &Director::flushProgress);
+
     mLogger.setApplicationName(PROJECT_SHORT_NAME);
     mLogger.setApplicationVersion(PROJECT_VERSION_STR);
     mLogger.setMaximumEntries(LOG_MAX_ENTRIES);
@@ -78,17 +84,17 @@ void Director::qtMessageHandler(QtMsgType type, const QMessageLogContext& contex
 
 //-Instance Functions-------------------------------------------------------------
 //Private:
-template<typename F>
-    requires Qx::defines_call_for_s<F, Qx::IoOpReport>
-void Director::log(F logFunc)
+bool Director::checkLog()
 {
-    if(mLogger.hasError())
-        return;
+    if(!mLogger.hasError())
+        return true;
 
-    if(auto r = logFunc(); r.isFailure())
-        postDirective(NAME, DError{Qx::Error(r).setSeverity(Qx::Warning)});
-}
+    // The writer can't post directives from its own thread, so its failures are reported from here
+    if(QString err; mLogger.takeError(err))
+        postDirective(NAME, DError{DirectorError(DirectorError::InternalError, err, Qx::Warning)});
 
+    return false;
+}
 
 bool Director::isLogOpen() const { return mLogger.isOpen(); }
 
@@ -127,14 +133,52 @@ void Director::logQtMessage(QtMsgType type, const QMessageLogContext& context, c
     }
 }
 
+void Director::coalesceProgress(const DProcedureProgress& progress)
+{
+    // Latest value wins
+    mPendingProgress = progress;
+    if(mProgressTimer.isActive())
+        return;
+
+    // Send right away if the last update was long enough ago, otherwise as soon as it has been
+    qint64 wait = mProgressClock.isValid() ? mProgressInterval - mProgressClock.elapsed() : 0;
+    if(wait <= 0)
+        flushProgress();
+    else
+        mProgressTimer.start(wait);
+}
+
+void Director::flushProgress()
+{
+    mProgressTimer.stop();
+    if(!mPendingProgress)
+        return;
+
+    DProcedureProgress progress = *mPendingProgress;
+    mPendingProgress.reset();
+    mProgressClock.start();
+
+    mTracer.instant(directiveName<DProcedureProgress>(), TRACE_CATEGORY_DIRECTIVE);
+    emit announceAsyncDirective(progress);
+}
+
 //Public:
 Director::Verbosity Director::verbosity() const { return mVerbosity; }
+Director::LogLevel Director::logLevel() const { return mLogLevel; }
+bool Director::isLogged(LogLevel level) const { return level >= mLogLevel; }
 bool Director::criticalErrorOccurred() const { return mCriticalErrorOccurred; }
+Tracer* Director::tracer() { return &mTracer; }
+
+void Director::setProgressRate(int hz)
+{
+    mProgressInterval = hz > 0 ? 1000 / hz : 0;
+    logEvent(NAME, LOG_EVENT_PROGRESS_RATE.arg(hz > 0 ? QString::number(hz) : u"unlimited"_s));
+}
 
 void Director::openLog(const QStringList& arguments)
 {
-    mLogger.setApplicationArguments(arguments);
-    log([&](){ return mLogger.openLog(); });
+    if(QString err; !mLogger.open(arguments, err))
+        checkLog();
 }
 
 void Director::setVerbosity(Verbosity verbosity)
@@ -143,27 +187,72 @@ void Director::setVerbosity(Verbosity verbosity)
     logEvent(NAME, LOG_EVENT_NOTIFCATION_LEVEL.arg(ENUM_NAME(verbosity)));
 }
 
-void Director::logError(const QString& src, const Qx::Error& error)
+void Director::setLogLevel(LogLevel level)
 {
-    log([&](){ return mLogger.recordErrorEvent(src, error); });
+    mLogLevel = level;
+    logEvent(NAME, LOG_EVENT_LOG_LEVEL.arg(ENUM_NAME(level)));
+}
+
+void Director::enableEventLog() { mLogger.setEventLogPath(CLIFP_DIR_PATH + '/' + CLIFP_CUR_APP_BASENAME + EVENT_LOG_DIR_SUFFIX); }
+
+void Director::logError(const QString& src, const Qx::Error& error, int task)
+{
+    if(checkLog())
+        mLogger.recordError(src, error, task);
 
     if(error.severity() == Qx::Critical)
         mCriticalErrorOccurred = true;
 }
 
-void Director::logEvent(const QString& src, const QString& event)
+void Director::logEvent(const QString& src, const QString& event, int task)
+{
+    if(checkLog())
+        mLogger.recordEvent(src, event, task);
+}
+
+void Director::logEvent(const QString& src, LogLevel level, std::function<QString()>&& formatter, int task)
+{
+    // Tag anything more detailed than normal so it stands out
+    static const QString debugTag = u"DEBUG"_s;
+    static const QString traceTag = u"TRACE"_s;
+
+    if(isLogged(level) && checkLog())
+        mLogger.recordEvent(src, level == LogLevel::Info ? QString() : level == LogLevel::Debug ? debugTag : traceTag, std::move(formatter), task);
+}
+
+void Director::logTaskStart(const QString& task, int number)
+{
+    if(checkLog())
+        mLogger.recordTaskStart(task, number);
+}
+
+void Director::logTaskEnd(const QString& task, int number)
 {
-    log([&](){ return mLogger.recordGeneralEvent(src, event); });
+    if(checkLog())
+        mLogger.recordTaskEnd(task, number);
 }
 
 ErrorCode Director::logFinish(const QString& src, const Qx::Error& errorState)
 {
+    // Don't leave the frontend behind on the last update
+    flushProgress();
+
     if(mCriticalErrorOccurred)
         logEvent(src, LOG_ERR_CRITICAL);
 
     ErrorCode code = errorState.typeCode();
 
-    log([&](){ return mLogger.finish(code); });
+    if(mTracer.isEnabled())
+    {
+        if(QString err; mTracer.write(&err))
+            logEvent(src, LOG_EVENT_TRACE_WRITTEN.arg(mTracer.filePath()));
+        else
+            logError(src, DirectorError(DirectorError::InternalError, LOG_ERR_TRACE_WRITE.arg(mTracer.filePath(), err), Qx::Warning));
+    }
+
+    // Waits for everything to be written and synced
+    if(QString err; checkLog() && !mLogger.finish(code, err))
+        checkLog();
 
     // Return exit code so main function can return with this one
     return code;
@@ -1,17 +1,24 @@
 #ifndef DIRECTOR_H
 #define DIRECTOR_H
 
+// Standard Library Includes
+#include <concepts>
+#include <optional>
+
 // Qt Includes
 #include <QString>
 #include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
 
 // Qx Includes
-#include <qx/io/qx-applicationlogger.h>
 #include <qx/utility/qx-concepts.h>
 
 // Project Includes
 #include "kernel/directive.h"
 #include "kernel/errorcode.h"
+#include "kernel/logwriter.h"
+#include "kernel/tracer.h"
 
 class Task;
 
@@ -62,6 +69,7 @@ class Director : public QObject
 //-Class Enums-----------------------------------------------------------------------
 public:
     enum class Verbosity { Full, Quiet, Silent };
+    enum class LogLevel { Trace, Debug, Info }; // Errors are always logged
 
 //-Class Variables------------------------------------------------------------------------------------------------------
 private:
@@ -71,23 +79,43 @@ private:
 
     // Logging
     static const int LOG_MAX_ENTRIES = 50;
-    static inline const QString LOG_FILE_EXT = u"log"_s;
+    static const LogLevel DEFAULT_LOG_LEVEL = LogLevel::Debug;
+    static inline const QString LOG_DIR_SUFFIX = u"-logs"_s;
+    static inline const QString EVENT_LOG_DIR_SUFFIX = u"-events"_s;
 
     // Logging - Messages
     static inline const QString LOG_EVENT_NOTIFCATION_LEVEL = u"Notification Level is: %1"_s;
+    static inline const QString LOG_EVENT_LOG_LEVEL = u"Log Level is: %1"_s;
+    static inline const QString LOG_EVENT_TRACE_WRITTEN = u"Trace written to: %1"_s;
+
+    // Tracing
+    static inline const QString TRACE_CATEGORY_DIRECTIVE = u"directive"_s;
+
+    // Progress
+    static const int DEFAULT_PROGRESS_RATE = 30; // Hz
+    static inline const QString LOG_EVENT_PROGRESS_RATE = u"Progress Rate is: %1 Hz"_s;
 
     // Logging - Errors
     static inline const QString LOG_ERR_CRITICAL = u"Aborting execution due to previous critical errors"_s;
+    static inline const QString LOG_ERR_TRACE_WRITE = u"Failed to write trace to %1 (%2)"_s;
 
     // Meta
     static inline const QString NAME = u"Director"_s;
 
 //-Instance Variables------------------------------------------------------------------------------------------------------
 private:
-    Qx::ApplicationLogger mLogger;
+    LogWriter mLogger;
+    Tracer mTracer;
     Verbosity mVerbosity;
+    LogLevel mLogLevel;
     bool mCriticalErrorOccurred;
 
+    // Progress coalescing
+    int mProgressInterval; // ms, 0 for no limit
+    QTimer mProgressTimer;
+    QElapsedTimer mProgressClock; // Since the last progress update went out
+    std::optional<DProcedureProgress> mPendingProgress;
+
 //-Constructor------------------------------------------------------------------------------------------------------------
 public:
     Director();
@@ -101,14 +129,18 @@ private:
 //-Instance Functions------------------------------------------------------------------------------------------------------
 private:
     // Logging
-    template<typename F>
-        requires Qx::defines_call_for_s<F, Qx::IoOpReport>
-    void log(F logFunc);
-
+    bool checkLog(); // Reports a failure of the log writer once, returns false if it's unusable
     bool isLogOpen() const;
     void logQtMessage(QtMsgType type, const QMessageLogContext& context, const QString& msg);
 
+    // Directives
+    void coalesceProgress(const DProcedureProgress& progress);
+    void flushProgress();
+
     // Helper
+    template<DirectiveT T>
+    static QString directiveName() { return QString::fromLatin1(QMetaType::fromType<T>().name()); }
+
     template<DirectiveT T>
     auto ddr() // Default directive return helper
     {
@@ -119,23 +151,32 @@ private:
 public:
     // Data
     Verbosity verbosity() const;
+    LogLevel logLevel() const;
+    bool isLogged(LogLevel level) const;
     bool criticalErrorOccurred() const;
+    Tracer* tracer();
+    void setProgressRate(int hz); // 0 for no limit
 
     // Logging
     void openLog(const QStringList& arguments);
     void setVerbosity(Verbosity verbosity);
-    void logError(const QString& src, const Qx::Error& error);
-    void logEvent(const QString& src, const QString& event);
+    void setLogLevel(LogLevel level);
+    void enableEventLog(); // Must be called before the log is opened
+    void logError(const QString& src, const Qx::Error& error, int task = -1);
+    void logEvent(const QString& src, const QString& event, int task = -1);
+    void logEvent(const QString& src, LogLevel level, std::function<QString()>&& formatter, int task = -1);
+    void logTaskStart(const QString& task, int number);
+    void logTaskEnd(const QString& task, int number);
     ErrorCode logFinish(const QString& src, const Qx::Error& errorState);
 
     // Directives
     template<DirectiveT T>
-    auto postDirective(const QString& src, const T& directive)
+    auto postDirective(const QString& src, const T& directive, int task = -1)
     {
         // Special handling
         if constexpr(Qx::any_of<T, DError, DBlockingError>)
         {
-            logError(src, directive.error);
+            logError(src, directive.error, task);
             if(mVerbosity == Verbosity::Silent || (mVerbosity == Verbosity::Quiet && directive.error.severity() != Qx::Critical))
                 return ddr<T>();
         }
@@ -145,11 +186,30 @@ public:
                 return ddr<T>();
         }
 
+        /* Progress can be reported far more often than is worth redrawing, so only the latest value is sent, at
+         * a limited rate. Everything else flushes any held back progress first so that order is preserved
+         * (e.g. the final progress of a procedure still arrives before it's stopped).
+         */
+        if constexpr(std::same_as<T, DProcedureProgress>)
+        {
+            coalesceProgress(directive);
+            return;
+        }
+        else
+            flushProgress();
+
         // Send
         if constexpr(AsyncDirectiveT<T>)
+        {
+            mTracer.instant(directiveName<T>(), TRACE_CATEGORY_DIRECTIVE);
             emit announceAsyncDirective(directive);
+        }
         else if constexpr(SyncDirectiveT<T>)
+        {
+            // Spans the time spent blocked on the frontend
+            Tracer::Span span = mTracer.span(directiveName<T>(), TRACE_CATEGORY_DIRECTIVE);
             emit announceSyncDirective(directive);
+        }
         else
         {
             static_assert(RequestDirectiveT<T>);
@@ -165,6 +225,7 @@ public:
              * overload.
              */
             auto response = ddr<T>();
+            Tracer::Span span = mTracer.span(directiveName<T>(), TRACE_CATEGORY_DIRECTIVE);
             emit announceRequestDirective(directive, &response);
             return response;
         }
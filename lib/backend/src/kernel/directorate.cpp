@@ -13,11 +13,12 @@ Directorate::Directorate(Director* director) :
 
 //-Instance Functions-------------------------------------------------------------
 //Protected:
-void Directorate::logError(const Qx::Error& error) const { Q_ASSERT(mDirector); mDirector->logError(name(), error); }
-void Directorate::logEvent(const QString& event) const { Q_ASSERT(mDirector); mDirector->logEvent(name(), event); }
+void Directorate::logError(const Qx::Error& error) const { Q_ASSERT(mDirector); mDirector->logError(name(), error, logTaskNumber()); }
+void Directorate::logEvent(const QString& event) const { Q_ASSERT(mDirector); mDirector->logEvent(name(), event, logTaskNumber()); }
 
-//Public:
 Director* Directorate::director() const { return mDirector; }
+Tracer* Directorate::tracer() const { Q_ASSERT(mDirector); return mDirector->tracer(); }
+int Directorate::logTaskNumber() const { return -1; }
 
 //Public:
 void Directorate::setDirector(Director* director) { mDirector = director; }
@@ -2,13 +2,48 @@
 #define DIRECTORATE_H
 
 // Standard Library Includes
+#include <concepts>
+#include <type_traits>
 #include <utility>
 
 // Qt Includes
 #include <QString>
+#include <QStringList>
 
 // Project Includes
 #include "kernel/director.h"
+#include "utility.h"
+
+/* Values captured by the deferred logging functions of Directorate, which are only turned into text on the log
+ * writer's thread. Callables are invoked up front (on the caller's thread, and only if the event will be
+ * logged at all) and their result captured instead, which allows for arguments that are expensive to produce
+ * or that reference objects that might not be around by the time the event is written.
+ */
+template<typename T>
+auto captureLogArg(T&& arg)
+{
+    if constexpr(std::invocable<T>)
+        return std::invoke(std::forward<T>(arg));
+    else
+        return std::decay_t<T>(std::forward<T>(arg));
+}
+
+template<typename T>
+QString logArgString(const T& arg)
+{
+    static_assert(!std::same_as<T, QStringView> && !std::same_as<T, QLatin1StringView>, "Views could dangle before the event is written");
+
+    if constexpr(std::is_enum_v<T>)
+        return ENUM_NAME(arg);
+    else if constexpr(std::same_as<T, bool>)
+        return arg ? u"true"_s : u"false"_s;
+    else if constexpr(std::is_arithmetic_v<T>)
+        return QString::number(arg);
+    else if constexpr(std::same_as<T, QStringList>)
+        return arg.join(u", "_s);
+    else
+        return QString(arg);
+}
 
 class Directorate
 {
@@ -25,16 +60,48 @@ public:
     virtual ~Directorate() = default; // Future proofing if this is ever used polymorphically
 
 //-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    template<typename... Args>
+    void logDeferred(Director::LogLevel level, const QString& format, Args&&... args) const
+    {
+        Q_ASSERT(mDirector);
+        if(!mDirector->isLogged(level))
+            return; // Nothing is formatted, or even evaluated if passed as a callable
+
+        mDirector->logEvent(name(), level, [format, ...captured = captureLogArg(std::forward<Args>(args))]{
+            if constexpr(sizeof...(captured) == 0)
+                return format;
+            else
+                return format.arg(logArgString(captured)...);
+        }, logTaskNumber());
+    }
+
 protected:
     void logError(const Qx::Error& error) const;
     void logEvent(const QString& event) const;
 
+    // Deferred logging, 'format' is filled in with the arguments by the log writer
+    template<typename... Args>
+        requires (sizeof...(Args) > 0)
+    void logEvent(const QString& format, Args&&... args) const { logDeferred(Director::LogLevel::Info, format, std::forward<Args>(args)...); }
+
+    template<typename... Args>
+    void logDebug(const QString& format, Args&&... args) const { logDeferred(Director::LogLevel::Debug, format, std::forward<Args>(args)...); }
+
+    template<typename... Args>
+    void logTrace([[maybe_unused]] const QString& format, [[maybe_unused]] Args&&... args) const
+    {
+#ifndef CLIFP_STRIP_TRACE_LOGS
+        logDeferred(Director::LogLevel::Trace, format, std::forward<Args>(args)...);
+#endif
+    }
+
     // These two only return a value when a RequestDirective is used, otherwise 'return' is ignored
     template<DirectiveT T>
     [[nodiscard]] auto postDirective(const T& t) const
     {
         Q_ASSERT(mDirector);
-        return mDirector->postDirective(name(), t);
+        return mDirector->postDirective(name(), t, logTaskNumber());
     }
 
     template<DirectiveT T, typename... Args>
@@ -45,6 +112,8 @@ protected:
 
 protected:
     Director* director() const;
+    Tracer* tracer() const;
+    virtual int logTaskNumber() const; // Task that the event log attributes entries to, -1 for none
 
 public:
     virtual QString name() const = 0;
@@ -4,6 +4,12 @@
 
 // Qt Includes
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
 
 // Qx Includes
 #include <qx/core/qx-system.h>
@@ -14,9 +20,12 @@
 
 // Project Includes
 #include "kernel/core.h"
+#include "kernel/serve.h"
 #include "command/command.h"
+#include "command/c-serve.h"
 #include "command/c-update.h"
 #include "task/t-exec.h"
+#include "tools/localhttpclient.h"
 #include "utility.h"
 
 //===============================================================================================================
@@ -53,14 +62,30 @@ DriverPrivate::DriverPrivate(Driver* q, QStringList arguments) :
     mArguments(arguments),
     mCore(nullptr),
     mErrorStatus(),
-    mCurrentTask(nullptr),
-    mCurrentTaskNumber(-1),
-    mQuitRequested(false)
+    mActiveTasks(),
+    mTaskNumber(-1),
+    mQuitRequested(false),
+    mStopServing(false),
+    mServeClient(nullptr),
+    mResidentBusy(false)
 {
     // Required in order to ensure the commands aren't discarded when this is a static lib
     Command::registerAllCommands();
 }
 
+//-Destructor--------------------------------------------------------------------
+//Public:
+DriverPrivate::~DriverPrivate() = default;
+
+//-Class Functions-------------------------------------------------------------
+//Private:
+QString DriverPrivate::installCachePath()
+{
+    // Separate deployments of CLIFp (e.g. in different installs) share the cache location, so each gets its own file
+    QByteArray originHash = QCryptographicHash::hash(CLIFP_DIR_PATH.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + '/' + INSTALL_CACHE_FILE_TEMPLATE.arg(QString::fromLatin1(originHash));
+}
+
 //-Instance Functions-------------------------------------------------------------
 //Private:
 QString DriverPrivate::name() const { return NAME; }
@@ -79,6 +104,10 @@ void DriverPrivate::init()
     mCore = std::make_unique<Core>();
     Director* dtor = mCore->director();
     setDirector(mCore->director());
+    if(mWarmHttpClient)
+        mCore->attachLocalHttpClient(std::move(mWarmHttpClient));
+    if(!mSessionEnvironment.isEmpty())
+        mCore->setBaseProcessEnvironment(mSessionEnvironment);
 
     //-Setup Core & Director---------------------------
     QObject::connect(mCore.get(), &Core::abort, q, [this](CoreError err){
@@ -86,9 +115,19 @@ void DriverPrivate::init()
         mErrorStatus = err;
         quit();
     });
-    QObject::connect(dtor, &Director::announceAsyncDirective, q, &Driver::asyncDirectiveAccounced);
-    QObject::connect(dtor, &Director::announceSyncDirective, q, &Driver::syncDirectiveAccounced);
-    QObject::connect(dtor, &Director::announceRequestDirective, q, &Driver::requestDirectiveAccounced);
+    if(mServeHost) // Directives of a forwarded invocation belong to its client
+    {
+        ServeHost* host = mServeHost.get();
+        QObject::connect(dtor, &Director::announceAsyncDirective, host, &ServeHost::relayAsyncDirective);
+        QObject::connect(dtor, &Director::announceSyncDirective, host, &ServeHost::relaySyncDirective);
+        QObject::connect(dtor, &Director::announceRequestDirective, host, &ServeHost::relayRequestDirective);
+    }
+    else
+    {
+        QObject::connect(dtor, &Director::announceAsyncDirective, q, &Driver::asyncDirectiveAccounced);
+        QObject::connect(dtor, &Director::announceSyncDirective, q, &Driver::syncDirectiveAccounced);
+        QObject::connect(dtor, &Director::announceRequestDirective, q, &Driver::requestDirectiveAccounced);
+    }
 
     //-Setup deferred process manager------
     /* NOTE: It looks like the manager should just be a stack member of TExec that is constructed
@@ -104,26 +143,41 @@ void DriverPrivate::init()
     TExec::installDeferredProcessManager(dpm);
 }
 
-void DriverPrivate::startNextTask()
+void DriverPrivate::reset()
 {
-    Q_Q(Driver);
+    mErrorStatus.reset();
+    mActiveTasks.clear();
+    mTaskNumber = -1;
+    mQuitRequested = false;
+}
+
+void DriverPrivate::startReadyTasks()
+{
+    // Start everything whose dependencies are satisfied, in enqueue order
+    const QList<Task*> ready = mCore->takeReadyTasks();
+    for(Task* task : ready)
+        startTask(task);
+
+    // Since tasks only depend on those enqueued before them, something must always be ready or underway
+    if(mActiveTasks.isEmpty() && mCore->hasTasks())
+        qFatal("Task graph stalled with tasks remaining.");
+}
 
-    // Ensure tasks exist
-    if(!mCore->hasTasks())
-        qFatal("Called with no tasks remaining.");
+void DriverPrivate::startTask(Task* task)
+{
+    Q_Q(Driver);
 
-    // Take task at front of queue
-    mCurrentTask = mCore->frontTask();
-    mCore->removeFrontTask();
-    mCurrentTaskNumber++;
+    int number = ++mTaskNumber;
+    mActiveTasks.insert(task, number);
+    task->setNumber(number);
+    tracer()->beginAsync(task->name(), number, TRACE_CATEGORY_TASK);
+    director()->logTaskStart(task->name(), number);
 
     // Log task start
-    logEvent(LOG_EVENT_TASK_START.arg(QString::number(mCurrentTaskNumber),
-                                                   mCurrentTask->name(),
-                                                   ENUM_NAME(mCurrentTask->stage())));
+    logEvent(LOG_EVENT_TASK_START, number, task->name(), task->stage());
 
     // Only execute task after an error/quit if it is a Shutdown task
-    bool isShutdown = mCurrentTask->stage() == Task::Stage::Shutdown;
+    bool isShutdown = task->stage() == Task::Stage::Shutdown;
     bool erroring = mErrorStatus.isSet();
     bool qutting = mQuitRequested;
     bool skip = (erroring || qutting) && !isShutdown;
@@ -133,18 +187,27 @@ void DriverPrivate::startNextTask()
         logEvent(erroring ? LOG_EVENT_TASK_SKIP_ERROR : LOG_EVENT_TASK_SKIP_QUIT);
 
         // Queue up finished handler directly (executes on next event loop cycle) since task was skipped
-        // Can't connect directly because newer connect syntax doesn't support default args
-        QTimer::singleShot(0, q, [this](){ completeTaskHandler(); });
+        QTimer::singleShot(0, q, [this, task](){ completeTaskHandler(task); });
     }
     else
     {
         // QueuedConnection, allow event processing between tasks
-        QObject::connect(mCurrentTask, &Task::completed, q, [this](const Qx::Error& e){
-            completeTaskHandler(e);
+        QObject::connect(task, &Task::completed, q, [this, task](const Qx::Error& e){
+            completeTaskHandler(task, e);
         }, Qt::QueuedConnection);
 
         // Perform task
-        mCurrentTask->perform();
+        task->perform();
+    }
+}
+
+void DriverPrivate::stopActiveTasks(bool includeShutdown)
+{
+    for(auto [task, number] : mActiveTasks.asKeyValueRange())
+    {
+        Q_UNUSED(number);
+        if(includeShutdown || task->stage() != Task::Stage::Shutdown)
+            task->stop();
     }
 }
 
@@ -174,19 +237,242 @@ void DriverPrivate::finish()
             logEvent(LOG_EVENT_CLEARED_UPDATE_CACHE);
     }
 
-    emit q->finished(logFinish(mErrorStatus.value()));
+    ErrorCode code = logFinish(mErrorStatus.value());
+
+    // Forwarded invocations report back to their client instead
+    if(mServeHost && mServeHost->hasSession())
+    {
+        mServeHost->endSession(code);
+
+        // Core may be further up the stack here, so tear down on the next cycle
+        QTimer::singleShot(0, q, [this]{
+            retireCore();
+            if(mStopServing)
+                stopServing();
+            else
+                mServeHost->acceptNext();
+        });
+    }
+    else
+        emit q->finished(code);
 }
 
 void DriverPrivate::quit()
 {
     mQuitRequested = true;
 
-    // Stop current task (assuming it can be)
-    if(mCurrentTask)
-        mCurrentTask->stop();
+    // Stop active tasks (assuming they can be)
+    stopActiveTasks(true);
+}
+
+void DriverPrivate::handleQuitRequest()
+{
+    // Handle quit state
+    if(mQuitRequested)
+    {
+        logEvent(LOG_EVENT_QUIT_REQUEST_REDUNDANT);
+        return;
+    }
+
+    logEvent(LOG_EVENT_QUIT_REQUEST);
+    quit();
+}
+
+// Resident mode
+bool DriverPrivate::isResidentInvocation() const
+{
+    return Core::commandName(mArguments) == CServe::NAME;
+}
+
+bool DriverPrivate::forwardToResident()
+{
+    Q_Q(Driver);
+
+    auto client = std::make_unique<ServeClient>(q);
+    if(!client->connectToHost())
+        return false;
+
+    /* From here on this instance is only a relay, and the resident instance does the work (and the logging).
+     * The connections go straight to the Driver signals, which are blocking for sync and request directives,
+     * so the client doesn't answer the resident instance until the frontend has.
+     */
+    mServeClient = client.release();
+    QObject::connect(mServeClient, &ServeClient::asyncDirectiveReceived, q, &Driver::asyncDirectiveAccounced);
+    QObject::connect(mServeClient, &ServeClient::syncDirectiveReceived, q, &Driver::syncDirectiveAccounced);
+    QObject::connect(mServeClient, &ServeClient::requestDirectiveReceived, q, &Driver::requestDirectiveAccounced);
+    QObject::connect(mServeClient, &ServeClient::finished, q, &Driver::finished);
+    QObject::connect(mServeClient, &ServeClient::busy, q, [this]{
+        // Another session is underway, so run here instead if that doesn't step on the resident instance
+        mServeClient->deleteLater();
+        mServeClient = nullptr;
+        mResidentBusy = true;
+        run();
+    }, Qt::QueuedConnection);
+    QObject::connect(mServeClient, &ServeClient::connectionLost, q, [q]{
+        DriverError err(DriverError::ResidentConnectionLost);
+        emit q->asyncDirectiveAccounced(DError{err});
+        emit q->finished(Qx::Error(err).typeCode());
+    });
+
+    mServeClient->sendCommand(mArguments);
+    return true;
+}
+
+void DriverPrivate::startServing()
+{
+    Q_Q(Driver);
+
+    mServeHost = std::make_unique<ServeHost>();
+    if(!mServeHost->listen())
+    {
+        DriverError err(DriverError::ResidentListenFailed, mServeHost->errorString());
+        postDirective<DError>(err);
+        mErrorStatus = err;
+        mServeHost.reset();
+        finish();
+        return;
+    }
+    logEvent(LOG_EVENT_RESIDENT_START.arg(ServeHost::serverName()));
+
+    QObject::connect(mServeHost.get(), &ServeHost::sessionRequested, q, [this](const QStringList& arguments, const QString& workingDir,
+                                                                               const QProcessEnvironment& environment){
+        startSession(arguments, workingDir, environment);
+    });
+    QObject::connect(mServeHost.get(), &ServeHost::cancelRequested, q, [this]{
+        cancelActiveLongTask();
+    });
+    QObject::connect(mServeHost.get(), &ServeHost::quitRequested, q, [this]{
+        if(mCore)
+            handleQuitRequest();
+    });
+
+    /* The hosting run ends here as far as logging goes, each forwarded invocation gets its own core
+     * (and therefore log) while the install, and the single instance lock, stay with this instance.
+     */
+    logFinish(mErrorStatus.value());
+    QTimer::singleShot(0, q, [this]{
+        retireCore();
+        mServeHost->acceptNext();
+    });
+}
+
+void DriverPrivate::startSession(const QStringList& arguments, const QString& workingDir, const QProcessEnvironment& environment)
+{
+    // Relative paths belong to the invoker, as does the environment titles and services should see
+    if(!workingDir.isEmpty())
+        QDir::setCurrent(workingDir);
+    mSessionEnvironment = environment;
+
+    mArguments = arguments;
+    run();
+}
+
+void DriverPrivate::retireCore()
+{
+    if(!mCore)
+        return;
+
+    if(!mWarmInstall)
+        mWarmInstall = mCore->detachFlashpoint();
+    if(mServeHost)
+        mWarmHttpClient = mCore->detachLocalHttpClient();
+
+    TExec::installDeferredProcessManager(nullptr);
+    setDirector(nullptr);
+    mCore.reset();
+    reset();
+}
+
+void DriverPrivate::stopServing()
+{
+    Q_Q(Driver);
+
+    retireCore();
+    mServeHost.reset();
+    mWarmInstall.reset();
+    mWarmHttpClient.reset();
+    emit q->finished(0);
 }
 
 // Helper functions
+std::unique_ptr<Fp::Install> DriverPrivate::acquireFlashpointInstall()
+{
+    if(mWarmInstall)
+    {
+        logEvent(LOG_EVENT_FLASHPOINT_WARM);
+        return std::move(mWarmInstall);
+    }
+
+    if(auto cached = cachedFlashpointInstall())
+        return cached;
+
+    logEvent(LOG_EVENT_FLASHPOINT_SEARCH);
+    auto found = findFlashpointInstall();
+    if(found)
+        cacheFlashpointInstall(*found);
+    return found;
+}
+
+std::unique_ptr<Fp::Install> DriverPrivate::cachedFlashpointInstall()
+{
+    QFile cacheFile(installCachePath());
+    if(!cacheFile.open(QIODevice::ReadOnly))
+    {
+        logEvent(LOG_EVENT_FLASHPOINT_CACHE_MISS);
+        return nullptr;
+    }
+
+    QJsonObject entry = QJsonDocument::fromJson(cacheFile.readAll()).object();
+    QDir root(entry.value(INSTALL_CACHE_KEY_ROOT).toString());
+
+    // Only cheap checks before committing to loading the install
+    if(entry.value(INSTALL_CACHE_KEY_ORIGIN).toString() != CLIFP_DIR_PATH)
+    {
+        logEvent(LOG_EVENT_FLASHPOINT_CACHE_STALE.arg(u"CLIFp moved"_s));
+        return nullptr;
+    }
+
+    QFileInfo versionInfo(root.absoluteFilePath(INSTALL_VERSION_FILE));
+    if(!versionInfo.exists() || versionInfo.lastModified().toMSecsSinceEpoch() != entry.value(INSTALL_CACHE_KEY_VERSION_MTIME).toInteger())
+    {
+        logEvent(LOG_EVENT_FLASHPOINT_CACHE_STALE.arg(u"version changed"_s));
+        return nullptr;
+    }
+
+    auto fpInstall = std::make_unique<Fp::Install>(root.absolutePath());
+    if(!fpInstall->isValid() || static_cast<int>(fpInstall->outfittedDaemon()) != entry.value(INSTALL_CACHE_KEY_DAEMON).toInt())
+    {
+        logEvent(LOG_EVENT_FLASHPOINT_CACHE_STALE.arg(u"install changed"_s));
+        return nullptr;
+    }
+
+    logEvent(LOG_EVENT_FLASHPOINT_CACHE_HIT.arg(QDir::toNativeSeparators(root.absolutePath())));
+    return fpInstall;
+}
+
+void DriverPrivate::cacheFlashpointInstall(const Fp::Install& install)
+{
+    QDir root = install.dir();
+    QFileInfo versionInfo(root.absoluteFilePath(INSTALL_VERSION_FILE));
+    if(!versionInfo.exists())
+        return; // Nothing cheap to validate against
+
+    QJsonObject entry{
+        {INSTALL_CACHE_KEY_ORIGIN, CLIFP_DIR_PATH},
+        {INSTALL_CACHE_KEY_ROOT, root.absolutePath()},
+        {INSTALL_CACHE_KEY_VERSION_MTIME, versionInfo.lastModified().toMSecsSinceEpoch()},
+        {INSTALL_CACHE_KEY_DAEMON, static_cast<int>(install.outfittedDaemon())}
+    };
+
+    // Best effort, a failure here only means the next run searches again
+    QSaveFile cacheFile(installCachePath());
+    if(QDir().mkpath(QFileInfo(cacheFile.fileName()).absolutePath()) && cacheFile.open(QIODevice::WriteOnly))
+    {
+        cacheFile.write(QJsonDocument(entry).toJson(QJsonDocument::Compact));
+        cacheFile.commit();
+    }
+}
+
 std::unique_ptr<Fp::Install> DriverPrivate::findFlashpointInstall()
 {
     QDir currentDir(CLIFP_DIR_PATH);
@@ -222,23 +508,35 @@ std::unique_ptr<Fp::Install> DriverPrivate::findFlashpointInstall()
 
 //-Slots--------------------------------------------------------------------------------
 //Private:
-void DriverPrivate::completeTaskHandler(const Qx::Error& e)
+void DriverPrivate::completeTaskHandler(Task* task, const Qx::Error& e)
 {
+    int number = mActiveTasks.take(task);
+
     // Handle errors
     if(e.isValid())
     {
         mErrorStatus = e;
-        logEvent(LOG_EVENT_TASK_FINISH_ERR.arg(mCurrentTaskNumber)); // Record early end of task
+        logEvent(LOG_EVENT_TASK_FINISH_ERR, number); // Record early end of task
+
+        // Whatever else is underway was started before the error and its result can no longer be used
+        if(!mActiveTasks.isEmpty() && task->stage() != Task::Stage::Shutdown)
+        {
+            logEvent(LOG_EVENT_TASK_STOP_OTHERS, mActiveTasks.size());
+            stopActiveTasks(false);
+        }
     }
 
     // Cleanup handled task
-    logEvent(LOG_EVENT_TASK_FINISH.arg(mCurrentTaskNumber));
-    qxDelete(mCurrentTask);
+    tracer()->endAsync(task->name(), number, TRACE_CATEGORY_TASK);
+    director()->logTaskEnd(task->name(), number);
+    logEvent(LOG_EVENT_TASK_FINISH, number);
+    mCore->completeTask(task);
+    qxDelete(task);
 
-    // Perform next task if any remain
+    // Perform tasks that are now unblocked, if any remain
     if(mCore->hasTasks())
-        startNextTask();
-    else
+        startReadyTasks();
+    else if(mActiveTasks.isEmpty())
     {
         logEvent(LOG_EVENT_QUEUE_FINISH);
         cleanup();
@@ -246,14 +544,15 @@ void DriverPrivate::completeTaskHandler(const Qx::Error& e)
     }
 }
 
-//Public:
-void DriverPrivate::drive()
+void DriverPrivate::run()
 {
     // Initialize
     init();
 
     //-Initialize Core--------------------------------------------------------------------------
     mErrorStatus = mCore->initialize(mArguments);
+    if(mServeHost)
+        logEvent(LOG_EVENT_RESIDENT_SESSION);
     if(mErrorStatus.isSet() || mArguments.empty()) // Terminate if error or no command
     {
         finish();
@@ -271,11 +570,13 @@ void DriverPrivate::drive()
     }
 
     bool runCommand;
+    Tracer::Span processSpan = tracer()->span(u"Command::process"_s, TRACE_CATEGORY_PHASE);
     if(auto err = commandProcessor->process(runCommand); err.isValid())
     {
         postDirective<DError>(err);
         mErrorStatus = err;
     }
+    processSpan.end();
     if(!runCommand) // Help or the like was requested, nothing to do
     {
         finish();
@@ -285,11 +586,14 @@ void DriverPrivate::drive()
     //-Set Service Mode--------------------------------------------------------------------
 
     // Check state of standard launcher
-    bool launcherRunning = Qx::processIsRunning(Fp::Install::LAUNCHER_NAME);
-    mCore->setServicesMode(launcherRunning && commandProcessor->requiresServices() ? Core::Companion : Core::Standalone);
+    quint32 launcherPid = Qx::processId(Fp::Install::LAUNCHER_NAME);
+    bool companion = launcherPid && commandProcessor->requiresServices();
+    mCore->setServicesMode(companion ? Core::Companion : Core::Standalone, launcherPid);
 
     //-Restrict app to only one instance---------------------------------------------------
-    if(commandProcessor->autoBlockNewInstances() && !mCore->blockNewInstances())
+    bool blocked = mResidentBusy ? commandProcessor->requiresServices() : // Resident instance holds the lock and the services
+                   commandProcessor->autoBlockNewInstances() && !mServeHost && !mCore->blockNewInstances(); // Resident instance already holds the lock
+    if(blocked)
     {
         DriverError err(DriverError::AlreadyOpen);
         postDirective<DError>(err);
@@ -303,9 +607,11 @@ void DriverPrivate::drive()
     {
         // Find and link to Flashpoint Install
         std::unique_ptr<Fp::Install> flashpointInstall;
-        logEvent(LOG_EVENT_FLASHPOINT_SEARCH);
+        Tracer::Span findSpan = tracer()->span(u"findFlashpointInstall"_s, TRACE_CATEGORY_PHASE);
+        flashpointInstall = acquireFlashpointInstall();
+        findSpan.end();
 
-        if(!(flashpointInstall = findFlashpointInstall()))
+        if(!flashpointInstall)
         {
             DriverError err(DriverError::InvalidInstall, ERR_INSTALL_INVALID_TIP);
             postDirective<DError>(err);
@@ -316,12 +622,14 @@ void DriverPrivate::drive()
         logEvent(LOG_EVENT_FLASHPOINT_LINK.arg(QDir::toNativeSeparators(flashpointInstall->dir().absolutePath())));
 
         // Insert into core
+        Tracer::Span attachSpan = tracer()->span(u"attachFlashpoint"_s, TRACE_CATEGORY_PHASE);
         mCore->attachFlashpoint(std::move(flashpointInstall));
     }
 
     //-Catch early core errors-------------------------------------------------------------------
-    // This is basically just for Companion mode, where something changes with the FP launcher just after we start-up
-    QThread::msleep(100);
+    /* This is basically just for Companion mode, where something changes with the FP launcher just after we start-up.
+     * The launcher watch is event driven, so anything that already happened is waiting in the queue.
+     */
     QCoreApplication::processEvents();
     if(mErrorStatus.isSet())
     {
@@ -330,42 +638,89 @@ void DriverPrivate::drive()
     }
 
     //-Process command-----------------------------------------------------------------------------
+    Tracer::Span performSpan = tracer()->span(u"perform"_s, TRACE_CATEGORY_PHASE);
     mErrorStatus = commandProcessor->perform();
+    performSpan.end();
     if(mErrorStatus.isSet())
     {
         finish();
         return;
     }
 
+    //-Become resident if requested-----------------------------------------------------------------------
+    if(commandProcessor->startsResidentMode())
+    {
+        // A forwarded invocation can't make the resident instance start over
+        if(mServeHost)
+        {
+            DriverError err(DriverError::AlreadyResident);
+            postDirective<DError>(err);
+            mErrorStatus = err;
+            finish();
+        }
+        else
+            startServing();
+        return;
+    }
+
     //-Handle Tasks-----------------------------------------------------------------------
-    logEvent(LOG_EVENT_TASK_COUNT.arg(mCore->taskCount()));
+    logEvent(LOG_EVENT_TASK_COUNT, mCore->taskCount());
     if(mCore->hasTasks())
     {
         // Process task queue
         logEvent(LOG_EVENT_QUEUE_START);
-        startNextTask();
+        startReadyTasks();
     }
     else
         finish();
 }
 
+//Public:
+void DriverPrivate::drive()
+{
+    // Defer to resident instance if there is one
+    if(!isResidentInvocation() && forwardToResident())
+        return;
+
+    run();
+}
+
 void DriverPrivate::cancelActiveLongTask()
 {
-    if(mCurrentTask)
-        mCurrentTask->stop();
+    if(mServeClient)
+        mServeClient->sendCancel();
+    else
+    {
+        // Only the title's own work is cancelled, services keep starting and shutdown still runs
+        for(auto [task, number] : mActiveTasks.asKeyValueRange())
+        {
+            Q_UNUSED(number);
+            if(task->stage() == Task::Stage::Primary || task->stage() == Task::Stage::Auxiliary)
+                task->stop();
+        }
+    }
 }
 
 void DriverPrivate::quitNow()
 {
-    // Handle quit state
-    if(mQuitRequested)
+    if(mServeClient)
     {
-        logEvent(LOG_EVENT_QUIT_REQUEST_REDUNDANT);
+        mServeClient->sendQuit();
         return;
     }
 
-    logEvent(LOG_EVENT_QUIT_REQUEST);
-    quit();
+    if(mServeHost)
+    {
+        // Stop being resident once the current session, if any, wraps up
+        mStopServing = true;
+        if(!mCore)
+        {
+            stopServing();
+            return;
+        }
+    }
+
+    handleQuitRequest();
 }
 
 //===============================================================================================================
@@ -14,6 +14,9 @@
 
 class Driver;
 class Core;
+class ServeHost;
+class ServeClient;
+class LocalHttpClient;
 namespace Fp { class Install; }
 
 class QX_ERROR_TYPE(DriverError, "DriverError", 1202)
@@ -26,6 +29,9 @@ public:
         NoError,
         AlreadyOpen,
         InvalidInstall,
+        ResidentListenFailed,
+        ResidentConnectionLost,
+        AlreadyResident
     };
 
 //-Class Variables-------------------------------------------------------------
@@ -33,7 +39,10 @@ private:
     static inline const QHash<Type, QString> ERR_STRINGS{
         {NoError, u""_s},
         {AlreadyOpen, u"Only one instance of CLIFp can be used at a time!"_s},
-        {InvalidInstall, u"CLIFp does not appear to be deployed in a valid Flashpoint install"_s}
+        {InvalidInstall, u"CLIFp does not appear to be deployed in a valid Flashpoint install"_s},
+        {ResidentListenFailed, u"Could not start listening for further invocations."_s},
+        {ResidentConnectionLost, u"Lost connection to the resident instance of CLIFp."_s},
+        {AlreadyResident, u"This instance of CLIFp is already resident."_s}
     };
 
 //-Instance Variables-------------------------------------------------------------
@@ -76,6 +85,7 @@ private:
     static inline const QString LOG_EVENT_TASK_START = u"Handling task %1 [%2] (%3)"_s;
     static inline const QString LOG_EVENT_TASK_FINISH = u"End of task %1"_s;
     static inline const QString LOG_EVENT_TASK_FINISH_ERR = u"Premature end of task %1"_s;
+    static inline const QString LOG_EVENT_TASK_STOP_OTHERS = u"Stopping %1 other active task(s) due to error"_s;
     static inline const QString LOG_EVENT_QUEUE_FINISH = u"Finished processing Task queue"_s;
     static inline const QString LOG_EVENT_ENDING_CHILD_PROCESSES = u"Closing deferred processes..."_s;
     static inline const QString LOG_EVENT_CLEANUP_START = u"Cleaning up..."_s;
@@ -87,6 +97,24 @@ private:
     static inline const QString LOG_EVENT_CLEARED_UPDATE_CACHE = u"Cleared stale update cache."_s;
     static inline const QString LOG_EVENT_CORE_ABORT = u"Core abort signaled, quitting now."_s;
     static inline const QString LOG_EVENT_FINISH = u"Finishing run..."_s;
+    static inline const QString LOG_EVENT_FLASHPOINT_WARM = u"Reusing Flashpoint install held by resident instance"_s;
+    static inline const QString LOG_EVENT_FLASHPOINT_CACHE_HIT = uR"(Using cached Flashpoint root "%1")"_s;
+    static inline const QString LOG_EVENT_FLASHPOINT_CACHE_STALE = u"Cached Flashpoint root is stale (%1)"_s;
+    static inline const QString LOG_EVENT_FLASHPOINT_CACHE_MISS = u"No cached Flashpoint root"_s;
+    static inline const QString LOG_EVENT_RESIDENT_START = u"Now resident, listening for further invocations on: %1"_s;
+    static inline const QString LOG_EVENT_RESIDENT_SESSION = u"Handling invocation forwarded to resident instance"_s;
+
+    // Install discovery cache
+    static inline const QString INSTALL_CACHE_FILE_TEMPLATE = u"install-%1.json"_s; // Hash of the CLIFp location
+    static inline const QString INSTALL_CACHE_KEY_ORIGIN = u"origin"_s;
+    static inline const QString INSTALL_CACHE_KEY_ROOT = u"root"_s;
+    static inline const QString INSTALL_CACHE_KEY_VERSION_MTIME = u"versionModified"_s;
+    static inline const QString INSTALL_CACHE_KEY_DAEMON = u"daemon"_s;
+    static inline const QString INSTALL_VERSION_FILE = u"version.txt"_s;
+
+    // Tracing
+    static inline const QString TRACE_CATEGORY_PHASE = u"phase"_s;
+    static inline const QString TRACE_CATEGORY_TASK = u"task"_s;
 
     // Meta
     static inline const QString NAME = u"driver"_s;
@@ -113,15 +141,32 @@ private:
 
     ErrorStatus mErrorStatus;
 
-    Task* mCurrentTask;
-    int mCurrentTaskNumber;
+    QHash<Task*, int> mActiveTasks; // Task -> Number
+    int mTaskNumber;
 
     bool mQuitRequested;
 
+    // Resident mode
+    std::unique_ptr<ServeHost> mServeHost; // Set when this instance is resident
+    std::unique_ptr<Fp::Install> mWarmInstall; // Kept by the resident instance between sessions
+    std::unique_ptr<LocalHttpClient> mWarmHttpClient; // Same, keeps connections to the services alive
+    QProcessEnvironment mSessionEnvironment; // That of the invoker of the current session, if forwarded
+    bool mStopServing;
+    ServeClient* mServeClient; // Set when forwarding to a resident instance
+    bool mResidentBusy; // Resident instance turned this invocation away
+
 //-Constructor-------------------------------------------------------------------------------------------------
 public:
     DriverPrivate(Driver* q, QStringList arguments);
 
+//-Destructor-------------------------------------------------------------------------------------------------
+public:
+    ~DriverPrivate();
+
+//-Class Functions------------------------------------------------------------------------------------------------------------
+private:
+    static QString installCachePath();
+
 //-Instance Functions------------------------------------------------------------------------------------------------------------
 private:
     QString name() const override;
@@ -129,17 +174,33 @@ private:
 
     // Setup
     void init();
+    void reset();
 
     // Process
-    void startNextTask();
-    void completeTaskHandler(const Qx::Error& e = {});
+    void run();
+    void startReadyTasks();
+    void startTask(Task* task);
+    void stopActiveTasks(bool includeShutdown);
+    void completeTaskHandler(Task* task, const Qx::Error& e = {});
     void cleanup();
 
     void finish();
     void quit();
+    void handleQuitRequest();
+
+    // Resident mode
+    bool isResidentInvocation() const;
+    bool forwardToResident();
+    void startServing();
+    void startSession(const QStringList& arguments, const QString& workingDir, const QProcessEnvironment& environment);
+    void retireCore();
+    void stopServing();
 
     // Helper
+    std::unique_ptr<Fp::Install> acquireFlashpointInstall();
     std::unique_ptr<Fp::Install> findFlashpointInstall();
+    std::unique_ptr<Fp::Install> cachedFlashpointInstall();
+    void cacheFlashpointInstall(const Fp::Install& install);
 
 public:
     void drive();
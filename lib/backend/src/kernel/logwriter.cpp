@@ -0,0 +1,447 @@
+// Unit Include
+#include "logwriter.h"
+
+// Qt Includes
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+// Project Includes
+#include "utility.h"
+
+//===============================================================================================================
+// LogWriter
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Public:
+LogWriter::LogWriter(const QString& dirPath) :
+    mMaxEntries(0),
+    mRing(std::make_unique<Record[]>(RING_CAPACITY)),
+    mHead(0),
+    mTail(0),
+    mProducer(QThread::currentThreadId()),
+    mSidePending(false),
+    mUrgent(false),
+    mStop(false),
+    mStore(dirPath, LOG_SEGMENT_PREFIX, LOG_SEGMENT_EXT),
+    mEpoch(std::chrono::steady_clock::now()),
+    mOpen(false),
+    mFailed(false),
+    mErrorReported(false)
+{}
+
+//-Destructor-------------------------------------------------------------
+//Public:
+LogWriter::~LogWriter() { stopWriter(); }
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+int LogWriter::threadNumber()
+{
+    // Small, stable numbers are far easier to follow in the event log than native thread IDs
+    static thread_local int number = smThreadCount++;
+    return number;
+}
+
+qint64 LogWriter::monotonic() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mEpoch).count();
+}
+
+void LogWriter::push(Record&& record)
+{
+    bool urgent = record.sync;
+    record.mono = monotonic();
+    record.thread = threadNumber();
+
+    // Other threads are rare, so they just take a lock
+    if(QThread::currentThreadId() != mProducer)
+    {
+        {
+            std::lock_guard lock(mSideMutex);
+            mSide.append(std::move(record));
+        }
+        mSidePending.store(true, std::memory_order_release);
+        if(urgent)
+            wake();
+        return;
+    }
+
+    quint64 head = mHead.load(std::memory_order_relaxed);
+    quint64 used = head - mTail.load(std::memory_order_acquire);
+    while(used >= RING_CAPACITY)
+    {
+        // Nothing is draining the ring before the log is opened, so drop instead of waiting forever
+        if(!mOpen.load(std::memory_order_relaxed))
+            return;
+
+        wake();
+        std::this_thread::yield();
+        used = head - mTail.load(std::memory_order_acquire);
+    }
+
+    mRing[head & RING_MASK] = std::move(record);
+    mHead.store(head + 1, std::memory_order_release);
+
+    if(urgent || used + 1 == RING_WAKE_THRESHOLD)
+        wake();
+}
+
+void LogWriter::wake()
+{
+    mUrgent.store(true, std::memory_order_release);
+    mWake.notify_one();
+}
+
+void LogWriter::run()
+{
+    QString batch;
+    QByteArray events;
+    for(;;)
+    {
+        bool sync = false;
+        batch.clear();
+        events.clear();
+        drain(batch, events, sync);
+
+        if(!batch.isEmpty() && !mFailed)
+        {
+            if(QString err; !mStore.append(batch.toUtf8(), err))
+                fail(err);
+        }
+
+        if(mEvents && !events.isEmpty())
+        {
+            if(QString err; !mEvents->append(events, err))
+                disableEventLog(err);
+        }
+
+        if(sync && !mFailed && (!mStore.file().flush() || !syncFile(mStore.file())))
+            fail(ERR_SYNC.arg(mStore.filePath()));
+
+        if(sync && mEvents && (!mEvents->file().flush() || !syncFile(mEvents->file())))
+            disableEventLog(ERR_SYNC.arg(mEvents->filePath()));
+
+        // Only stop once everything has been written
+        if(mStop.load(std::memory_order_acquire) && mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_relaxed) &&
+           !mSidePending.load(std::memory_order_acquire))
+            break;
+
+        std::unique_lock lock(mWakeMutex);
+        mWake.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT), [this]{
+            return mUrgent.exchange(false, std::memory_order_acq_rel) || mStop.load(std::memory_order_acquire);
+        });
+    }
+
+    mStore.close();
+    mEvents.reset();
+}
+
+void LogWriter::drain(QString& batch, QByteArray& events, bool& sync)
+{
+    quint64 tail = mTail.load(std::memory_order_relaxed);
+    quint64 head = mHead.load(std::memory_order_acquire);
+    for(; tail != head; ++tail)
+    {
+        Record& r = mRing[tail & RING_MASK];
+        take(r, batch, events, sync);
+        r = {}; // Release the strings here instead of on the producer
+    }
+    mTail.store(tail, std::memory_order_release);
+
+    if(mSidePending.exchange(false, std::memory_order_acq_rel))
+    {
+        QList<Record> side;
+        {
+            std::lock_guard lock(mSideMutex);
+            side.swap(mSide);
+        }
+
+        for(Record& r : side)
+            take(r, batch, events, sync);
+    }
+}
+
+void LogWriter::take(Record& record, QString& batch, QByteArray& events, bool& sync) const
+{
+    // Deferred text is produced once, here, for both outputs
+    if(record.formatter)
+    {
+        record.text = record.formatter();
+        record.formatter = nullptr;
+    }
+
+    if(record.kind != Kind::TaskStart && record.kind != Kind::TaskEnd)
+        batch += format(record);
+    if(mEvents)
+        events += formatEvent(record);
+    sync |= record.sync;
+}
+
+QString LogWriter::format(const Record& record) const
+{
+    QString time = QDateTime::fromMSecsSinceEpoch(record.time).toString(TIME_FORMAT);
+
+    switch(record.kind)
+    {
+        case Kind::Event:
+            return record.tag.isEmpty() ? EVENT_TEMPLATE.arg(time, record.source, record.text) :
+                                          TAGGED_EVENT_TEMPLATE.arg(time, record.source, record.tag, record.text);
+
+        case Kind::Error:
+        {
+            const Qx::Error& e = record.error;
+            QString message = e.secondary().isEmpty() ? e.primary() : e.primary() + ' ' + e.secondary();
+            QString entry = ERROR_TEMPLATE.arg(time, record.source, ENUM_NAME(e.severity()), QString::number(e.typeCode(), 16), message);
+
+            if(QString details = e.details(); !details.isEmpty())
+            {
+                const QStringList lines = details.split('\n');
+                for(const QString& line : lines)
+                    entry += DETAILS_TEMPLATE.arg(line);
+            }
+            return entry;
+        }
+
+        case Kind::Finish:
+            return FINISH_TEMPLATE.arg(time, QString::number(record.code));
+
+        case Kind::TaskStart:
+        case Kind::TaskEnd:
+            return QString();
+    }
+
+    Q_UNREACHABLE();
+}
+
+QByteArray LogWriter::formatEvent(const Record& record) const
+{
+    QJsonObject event{
+        {EVENT_KEY_RUN, mRunId},
+        {EVENT_KEY_MONO, record.mono},
+        {EVENT_KEY_WALL, record.time},
+        {EVENT_KEY_THREAD, record.thread},
+        {EVENT_KEY_SOURCE, record.source}
+    };
+    if(record.task >= 0)
+        event[EVENT_KEY_TASK] = record.task;
+
+    switch(record.kind)
+    {
+        case Kind::Event:
+            event[EVENT_KEY_KIND] = u"event"_s;
+            event[EVENT_KEY_LEVEL] = record.tag.isEmpty() ? u"info"_s : record.tag.toLower();
+            event[EVENT_KEY_TEXT] = record.text;
+            break;
+
+        case Kind::Error:
+        {
+            const Qx::Error& e = record.error;
+            event[EVENT_KEY_KIND] = u"error"_s;
+            event[EVENT_KEY_SEVERITY] = ENUM_NAME(e.severity());
+            event[EVENT_KEY_CODE] = qint64(e.typeCode());
+            event[EVENT_KEY_TEXT] = e.secondary().isEmpty() ? e.primary() : e.primary() + ' ' + e.secondary();
+            if(QString details = e.details(); !details.isEmpty())
+                event[EVENT_KEY_DETAILS] = details;
+            break;
+        }
+
+        case Kind::Finish:
+            event[EVENT_KEY_KIND] = u"finish"_s;
+            event[EVENT_KEY_CODE] = qint64(record.code);
+            break;
+
+        case Kind::TaskStart:
+            event[EVENT_KEY_KIND] = u"task-start"_s;
+            break;
+
+        case Kind::TaskEnd:
+            event[EVENT_KEY_KIND] = u"task-end"_s;
+            break;
+    }
+
+    return QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n';
+}
+
+void LogWriter::openEventLog(const QStringList& arguments)
+{
+    mEvents = std::make_unique<SegmentStore>(mEventLogPath, EVENT_SEGMENT_PREFIX, EVENT_SEGMENT_EXT);
+    mEvents->setMaximumSegmentSize(EVENT_SEGMENT_SIZE);
+    mEvents->setMaximumSegments(EVENT_SEGMENT_COUNT);
+
+    if(QString err; !mEvents->open(mRunId, err))
+    {
+        disableEventLog(err);
+        return;
+    }
+
+    // Leads the run, the equivalent of the text log's header
+    QJsonObject run{
+        {EVENT_KEY_RUN, mRunId},
+        {EVENT_KEY_MONO, monotonic()},
+        {EVENT_KEY_WALL, QDateTime::currentMSecsSinceEpoch()},
+        {EVENT_KEY_THREAD, threadNumber()},
+        {EVENT_KEY_SOURCE, NAME},
+        {EVENT_KEY_KIND, u"run"_s},
+        {EVENT_KEY_APP, mAppName},
+        {EVENT_KEY_VERSION, mAppVersion},
+        {EVENT_KEY_ARGS, QJsonArray::fromStringList(arguments)},
+        {EVENT_KEY_PID, QCoreApplication::applicationPid()}
+    };
+
+    if(QString err; !mEvents->append(QJsonDocument(run).toJson(QJsonDocument::Compact) + '\n', err))
+        disableEventLog(err);
+}
+
+void LogWriter::disableEventLog(const QString& reason)
+{
+    // Not worth failing the whole log over, so just note it in the text log
+    mEvents.reset();
+    if(!mFailed)
+    {
+        QString time = QDateTime::currentDateTime().toString(TIME_FORMAT);
+        if(QString err; !mStore.append(EVENT_TEMPLATE.arg(time, NAME, EVENT_LOG_DISABLED.arg(reason)).toUtf8(), err))
+            fail(err);
+    }
+}
+
+void LogWriter::fail(const QString& errorString)
+{
+    std::lock_guard lock(mErrorMutex);
+    if(mFailed)
+        return;
+
+    mErrorString = errorString;
+    mFailed.store(true, std::memory_order_release);
+}
+
+void LogWriter::stopWriter()
+{
+    if(!mThread.joinable())
+        return;
+
+    mStop.store(true, std::memory_order_release);
+    wake();
+    mThread.join();
+}
+
+//Public:
+void LogWriter::setApplicationName(const QString& name) { mAppName = name; }
+void LogWriter::setApplicationVersion(const QString& version) { mAppVersion = version; }
+void LogWriter::setMaximumEntries(int max) { mMaxEntries = max; }
+void LogWriter::setEventLogPath(const QString& dirPath) { mEventLogPath = dirPath; }
+
+bool LogWriter::isOpen() const { return mOpen.load(std::memory_order_acquire); }
+bool LogWriter::hasError() const { return mFailed.load(std::memory_order_acquire); }
+
+bool LogWriter::takeError(QString& errorString)
+{
+    std::lock_guard lock(mErrorMutex);
+    if(!mFailed || mErrorReported)
+        return false;
+
+    mErrorReported = true;
+    errorString = mErrorString;
+    return true;
+}
+
+bool LogWriter::open(const QStringList& arguments, QString& errorString)
+{
+    Q_ASSERT(!mThread.joinable());
+
+    // Shared by both logs so that a run can be matched up between them
+    mRunId = QDateTime::currentDateTimeUtc().toString(RUN_ID_FORMAT) + '-' + QString::number(QCoreApplication::applicationPid());
+
+    // Only ever creates the run's segment (and drops the oldest), the history itself isn't touched
+    mStore.setMaximumSegmentRuns(LOG_SEGMENT_RUNS);
+    mStore.setMaximumSegments(mMaxEntries > 0 ? (mMaxEntries + LOG_SEGMENT_RUNS - 1) / LOG_SEGMENT_RUNS : 0);
+    if(!mStore.open(mRunId, errorString))
+    {
+        fail(errorString);
+        return false;
+    }
+
+    // The header goes out right away, anything recorded before now follows it
+    QString start = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    QByteArray header = HEADER_TEMPLATE.arg(mAppName, mAppVersion, start, arguments.join(' ')).toUtf8();
+    if(!mStore.append(header, errorString))
+    {
+        fail(errorString);
+        mStore.close();
+        return false;
+    }
+
+    if(!mEventLogPath.isEmpty())
+        openEventLog(arguments);
+
+    mProducer = QThread::currentThreadId();
+    mStop = false;
+    mOpen = true;
+    mThread = std::thread(&LogWriter::run, this);
+    return true;
+}
+
+void LogWriter::recordEvent(const QString& source, const QString& event, int task)
+{
+    if(mFailed.load(std::memory_order_relaxed))
+        return;
+
+    push({.kind = Kind::Event, .time = QDateTime::currentMSecsSinceEpoch(), .task = task, .source = source, .text = event});
+}
+
+void LogWriter::recordEvent(const QString& source, const QString& tag, std::function<QString()>&& formatter, int task)
+{
+    if(mFailed.load(std::memory_order_relaxed))
+        return;
+
+    push({.kind = Kind::Event, .time = QDateTime::currentMSecsSinceEpoch(), .task = task, .source = source, .formatter = std::move(formatter), .tag = tag});
+}
+
+void LogWriter::recordError(const QString& source, const Qx::Error& error, int task)
+{
+    if(mFailed.load(std::memory_order_relaxed))
+        return;
+
+    // Get critical errors to disk immediately in case they're followed by a crash
+    bool critical = error.severity() == Qx::Critical;
+    push({.kind = Kind::Error, .sync = critical, .time = QDateTime::currentMSecsSinceEpoch(), .task = task, .source = source, .error = error});
+}
+
+void LogWriter::recordTaskStart(const QString& task, int number)
+{
+    if(mEventLogPath.isEmpty() || mFailed.load(std::memory_order_relaxed))
+        return;
+
+    push({.kind = Kind::TaskStart, .time = QDateTime::currentMSecsSinceEpoch(), .task = number, .source = task});
+}
+
+void LogWriter::recordTaskEnd(const QString& task, int number)
+{
+    if(mEventLogPath.isEmpty() || mFailed.load(std::memory_order_relaxed))
+        return;
+
+    push({.kind = Kind::TaskEnd, .time = QDateTime::currentMSecsSinceEpoch(), .task = number, .source = task});
+}
+
+bool LogWriter::finish(ErrorCode code, QString& errorString)
+{
+    if(!mOpen)
+        return true;
+
+    push({.kind = Kind::Finish, .sync = true, .time = QDateTime::currentMSecsSinceEpoch(), .code = code});
+    stopWriter();
+    mOpen = false;
+
+    if(mFailed)
+    {
+        std::lock_guard lock(mErrorMutex);
+        errorString = mErrorString;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,220 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+// Standard Library Includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Qt Includes
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QList>
+
+// Qx Includes
+#include <qx/core/qx-error.h>
+
+// Project Includes
+#include "kernel/errorcode.h"
+#include "kernel/segmentstore.h"
+
+/* Writes the application log from a background thread so that recording an entry costs the caller little
+ * more than a copy into memory.
+ *
+ * Entries from the thread that opened the log go through a fixed size single-producer/single-consumer ring,
+ * while the occasional entry from any other thread (i.e. Qt messages) goes through a small locked side queue.
+ * The writer thread wakes up periodically, or early when the ring starts to fill, and writes whatever has
+ * accumulated in one go. The file is only flushed to disk when the log is finished or when an entry
+ * requests it (e.g. a critical error), so that as little as possible is lost if the process dies.
+ *
+ * Each run goes to a segment file of its own within the log directory (see SegmentStore), so opening the log
+ * only ever creates one new file, and retention drops the segments of the oldest runs whole instead of
+ * rewriting what came before.
+ *
+ * Optionally, every entry is also written as one JSON object per line to a structured event log, for tools
+ * to consume. Each of these carries a monotonic timestamp (ns since the writer was created), the wall-clock
+ * time, the recording thread, the source, the kind of entry and the number of the task that recorded it, if
+ * any. The event log is kept in size-rotated segments (see SegmentStore).
+ */
+class LogWriter
+{
+//-Class Enums-----------------------------------------------------------------------
+private:
+    enum class Kind : quint8
+    {
+        Event,
+        Error,
+        Finish,
+        TaskStart, // Only written to the event log
+        TaskEnd
+    };
+
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+private:
+    struct Record
+    {
+        Kind kind;
+        bool sync;
+        qint64 time; // ms since epoch
+        qint64 mono; // ns since the writer was created
+        int thread;
+        int task = -1;
+        QString source;
+        QString text;
+        std::function<QString()> formatter; // Produces the text on the writer thread, if set
+        QString tag;
+        Qx::Error error;
+        ErrorCode code;
+    };
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    // Ring
+    static const quint64 RING_CAPACITY = 4096; // Must be a power of 2
+    static const quint64 RING_MASK = RING_CAPACITY - 1;
+    static const quint64 RING_WAKE_THRESHOLD = RING_CAPACITY / 4;
+
+    // Writer
+    static const int IDLE_WAIT = 100; // ms
+
+    // Meta
+    static inline const QString NAME = u"LogWriter"_s;
+
+    // Format
+    static inline const QString HEADER_TEMPLATE = u"=== %1 %2 Execution Log ===\nStarted: %3\nArguments: %4\n\n"_s;
+    static inline const QString EVENT_TEMPLATE = u" - [%1] (%2) %3\n"_s;
+    static inline const QString TAGGED_EVENT_TEMPLATE = u" - [%1] (%2) %3: %4\n"_s;
+    static inline const QString ERROR_TEMPLATE = u" - [%1] (%2) %3 (0x%4): %5\n"_s;
+    static inline const QString DETAILS_TEMPLATE = u"       %1\n"_s;
+    static inline const QString FINISH_TEMPLATE = u"\nFinished at %1 with code %2\n\n"_s;
+    static inline const QString TIME_FORMAT = u"hh:mm:ss.zzz"_s;
+    static inline const QString RUN_ID_FORMAT = u"yyyyMMdd'T'hhmmsszzz"_s;
+
+    // Text log
+    static const int LOG_SEGMENT_RUNS = 1;
+    static inline const QString LOG_SEGMENT_PREFIX = u"log"_s;
+    static inline const QString LOG_SEGMENT_EXT = u"log"_s;
+
+    // Event log
+    static const qint64 EVENT_SEGMENT_SIZE = 4 * 1024 * 1024;
+    static const int EVENT_SEGMENT_COUNT = 16;
+    static inline const QString EVENT_SEGMENT_PREFIX = u"events"_s;
+    static inline const QString EVENT_SEGMENT_EXT = u"jsonl"_s;
+    static inline const QString EVENT_LOG_DISABLED = u"Event log disabled: %1"_s;
+    static inline const QString EVENT_KEY_RUN = u"run"_s;
+    static inline const QString EVENT_KEY_MONO = u"mono"_s;
+    static inline const QString EVENT_KEY_WALL = u"wall"_s;
+    static inline const QString EVENT_KEY_THREAD = u"thread"_s;
+    static inline const QString EVENT_KEY_SOURCE = u"source"_s;
+    static inline const QString EVENT_KEY_KIND = u"kind"_s;
+    static inline const QString EVENT_KEY_LEVEL = u"level"_s;
+    static inline const QString EVENT_KEY_TASK = u"task"_s;
+    static inline const QString EVENT_KEY_TEXT = u"text"_s;
+    static inline const QString EVENT_KEY_SEVERITY = u"severity"_s;
+    static inline const QString EVENT_KEY_CODE = u"code"_s;
+    static inline const QString EVENT_KEY_DETAILS = u"details"_s;
+    static inline const QString EVENT_KEY_APP = u"app"_s;
+    static inline const QString EVENT_KEY_VERSION = u"version"_s;
+    static inline const QString EVENT_KEY_ARGS = u"args"_s;
+    static inline const QString EVENT_KEY_PID = u"pid"_s;
+
+    // Errors
+    static inline const QString ERR_SYNC = u"Could not flush log file %1 to disk"_s;
+
+    // Thread numbering
+    static inline std::atomic_int smThreadCount = 0;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    // Properties
+    QString mAppName;
+    QString mAppVersion;
+    int mMaxEntries;
+    QString mEventLogPath;
+
+    // Ring
+    std::unique_ptr<Record[]> mRing;
+    alignas(64) std::atomic<quint64> mHead; // Next slot the producer writes
+    alignas(64) std::atomic<quint64> mTail; // Next slot the writer reads
+    Qt::HANDLE mProducer;
+
+    // Side queue
+    std::mutex mSideMutex;
+    QList<Record> mSide;
+    std::atomic_bool mSidePending;
+
+    // Writer thread
+    std::thread mThread;
+    std::mutex mWakeMutex;
+    std::condition_variable mWake;
+    std::atomic_bool mUrgent;
+    std::atomic_bool mStop;
+    SegmentStore mStore; // Only touched by the writer thread while it runs
+    std::unique_ptr<SegmentStore> mEvents; // Ditto
+    QString mRunId;
+    std::chrono::steady_clock::time_point mEpoch;
+
+    // Status
+    std::atomic_bool mOpen;
+    std::atomic_bool mFailed;
+    std::mutex mErrorMutex;
+    QString mErrorString;
+    bool mErrorReported;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    explicit LogWriter(const QString& dirPath);
+    LogWriter(const LogWriter& other) = delete;
+
+//-Destructor----------------------------------------------------------------------------------------------------------
+public:
+    ~LogWriter();
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    // Platform specific
+    static bool syncFile(QFile& file);
+
+    static int threadNumber();
+    qint64 monotonic() const;
+    void push(Record&& record);
+    void wake();
+    void run();
+    void drain(QString& batch, QByteArray& events, bool& sync);
+    void take(Record& record, QString& batch, QByteArray& events, bool& sync) const;
+    QString format(const Record& record) const;
+    QByteArray formatEvent(const Record& record) const;
+    void openEventLog(const QStringList& arguments);
+    void disableEventLog(const QString& reason);
+    void fail(const QString& errorString);
+    void stopWriter();
+
+public:
+    void setApplicationName(const QString& name);
+    void setApplicationVersion(const QString& version);
+    void setMaximumEntries(int max);
+    void setEventLogPath(const QString& dirPath); // Empty to disable
+
+    bool isOpen() const;
+    bool hasError() const;
+    bool takeError(QString& errorString); // Returns true only once, for the first failure
+
+    bool open(const QStringList& arguments, QString& errorString);
+    void recordEvent(const QString& source, const QString& event, int task = -1);
+    void recordEvent(const QString& source, const QString& tag, std::function<QString()>&& formatter, int task = -1);
+    void recordError(const QString& source, const Qx::Error& error, int task = -1);
+    void recordTaskStart(const QString& task, int number);
+    void recordTaskEnd(const QString& task, int number);
+    bool finish(ErrorCode code, QString& errorString);
+
+//-Operators------------------------------------------------------------------------------------------------------
+public:
+    LogWriter& operator=(const LogWriter& other) = delete;
+};
+
+#endif // LOGWRITER_H
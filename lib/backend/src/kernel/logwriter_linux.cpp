@@ -0,0 +1,13 @@
+// Unit Include
+#include "logwriter.h"
+
+// System Includes
+#include <unistd.h>
+
+//===============================================================================================================
+// LogWriter
+//===============================================================================================================
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+bool LogWriter::syncFile(QFile& file) { return fdatasync(file.handle()) == 0; }
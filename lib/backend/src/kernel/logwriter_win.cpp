@@ -0,0 +1,16 @@
+// Unit Include
+#include "logwriter.h"
+
+// System Includes
+#include <io.h>
+
+// Qx Includes
+#include <qx/windows/qx-common-windows.h>
+
+//===============================================================================================================
+// LogWriter
+//===============================================================================================================
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+bool LogWriter::syncFile(QFile& file) { return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()))); }
@@ -0,0 +1,197 @@
+// Unit Include
+#include "segmentstore.h"
+
+// Qt Includes
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+//===============================================================================================================
+// SegmentStore
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Public:
+SegmentStore::SegmentStore(const QString& dirPath, const QString& prefix, const QString& extension) :
+    mDir(dirPath),
+    mPrefix(prefix),
+    mExtension(extension),
+    mMaxSegmentSize(0),
+    mMaxSegmentRuns(0),
+    mMaxSegments(0),
+    mNextId(1)
+{}
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+QString SegmentStore::segmentPath(quint64 id) const
+{
+    return mDir.absoluteFilePath(u"%1-%2.%3"_s.arg(mPrefix).arg(id, 6, 10, QChar('0')).arg(mExtension));
+}
+
+bool SegmentStore::lockManifest(QLockFile& lock, QString& errorString) const
+{
+    if(!lock.tryLock(LOCK_TIMEOUT))
+    {
+        errorString = ERR_LOCK.arg(mDir.absoluteFilePath(LOCK_NAME));
+        return false;
+    }
+
+    return true;
+}
+
+void SegmentStore::loadManifest()
+{
+    mSegments.clear();
+    mNextId = 1;
+
+    QFile manifest(mDir.absoluteFilePath(MANIFEST_NAME));
+    if(!manifest.open(QIODevice::ReadOnly))
+        return;
+
+    QJsonObject root = QJsonDocument::fromJson(manifest.readAll()).object();
+    if(root.value(KEY_VERSION).toInt() == MANIFEST_VERSION)
+    {
+        mNextId = root.value(KEY_NEXT).toInteger(1);
+
+        const QJsonArray segments = root.value(KEY_SEGMENTS).toArray();
+        for(const QJsonValue& v : segments)
+        {
+            QJsonObject so = v.toObject();
+            Segment s{.id = quint64(so.value(KEY_ID).toInteger())};
+            const QJsonArray runs = so.value(KEY_RUNS).toArray();
+            for(const QJsonValue& r : runs)
+                s.runs.append(r.toString());
+
+            // Segments that were removed behind our back are forgotten
+            if(QFile::exists(segmentPath(s.id)))
+                mSegments.append(s);
+        }
+    }
+
+    // Never reuse an id, even if the manifest was lost or mangled
+    const QStringList existing = mDir.entryList({mPrefix + u"-*."_s + mExtension}, QDir::Files);
+    for(const QString& name : existing)
+    {
+        QStringView idStr = QStringView(name).sliced(mPrefix.size() + 1).chopped(mExtension.size() + 1);
+        if(bool ok; quint64 id = idStr.toULongLong(&ok); ok)
+            mNextId = std::max(mNextId, id + 1);
+    }
+}
+
+bool SegmentStore::saveManifest(QString& errorString)
+{
+    QJsonArray segments;
+    for(const Segment& s : std::as_const(mSegments))
+        segments.append(QJsonObject{{KEY_ID, qint64(s.id)}, {KEY_RUNS, QJsonArray::fromStringList(s.runs)}});
+
+    QJsonObject root{
+        {KEY_VERSION, MANIFEST_VERSION},
+        {KEY_NEXT, qint64(mNextId)},
+        {KEY_SEGMENTS, segments}
+    };
+
+    QSaveFile manifest(mDir.absoluteFilePath(MANIFEST_NAME));
+    QByteArray data = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    if(!manifest.open(QIODevice::WriteOnly) || manifest.write(data) != data.size() || !manifest.commit())
+    {
+        errorString = ERR_WRITE.arg(manifest.fileName(), manifest.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool SegmentStore::openSegment(bool fresh, QString& errorString)
+{
+    if(fresh)
+    {
+        mSegments.append({.id = mNextId++, .runs = {mRun}});
+        applyRetention();
+    }
+    else
+        mSegments.last().runs.append(mRun);
+
+    mFile.setFileName(segmentPath(mSegments.last().id));
+    if(!mFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        errorString = ERR_OPEN.arg(mFile.fileName(), mFile.errorString());
+        return false;
+    }
+
+    // Record the segment before anything lands in it so readers can always find a run's data
+    return saveManifest(errorString);
+}
+
+void SegmentStore::applyRetention()
+{
+    while(mMaxSegments > 0 && mSegments.size() > mMaxSegments)
+        QFile::remove(segmentPath(mSegments.takeFirst().id));
+}
+
+//Public:
+void SegmentStore::setMaximumSegmentSize(qint64 bytes) { mMaxSegmentSize = bytes; }
+void SegmentStore::setMaximumSegmentRuns(int count) { mMaxSegmentRuns = count; }
+void SegmentStore::setMaximumSegments(int count) { mMaxSegments = count; }
+
+QString SegmentStore::dirPath() const { return mDir.absolutePath(); }
+QString SegmentStore::filePath() const { return mFile.fileName(); }
+QFile& SegmentStore::file() { return mFile; }
+bool SegmentStore::isOpen() const { return mFile.isOpen(); }
+
+bool SegmentStore::open(const QString& run, QString& errorString)
+{
+    Q_ASSERT(!mFile.isOpen());
+
+    if(!mDir.mkpath(u"."_s))
+    {
+        errorString = ERR_MAKE_DIR.arg(mDir.absolutePath());
+        return false;
+    }
+
+    // Held until the new run is recorded, so that another process can't allocate the same segment or drop ours
+    QLockFile lock(mDir.absoluteFilePath(LOCK_NAME));
+    if(!lockManifest(lock, errorString))
+        return false;
+
+    mRun = run;
+    loadManifest();
+
+    // Keep filling the newest segment if it has room
+    bool fresh = mSegments.isEmpty() ||
+                 (mMaxSegmentRuns > 0 && mSegments.last().runs.size() >= mMaxSegmentRuns) ||
+                 (mMaxSegmentSize > 0 && QFileInfo(segmentPath(mSegments.last().id)).size() >= mMaxSegmentSize);
+    return openSegment(fresh, errorString);
+}
+
+bool SegmentStore::append(const QByteArray& data, QString& errorString)
+{
+    Q_ASSERT(mFile.isOpen());
+
+    // Rotate between writes so that each write stays whole within one segment
+    if(mMaxSegmentSize > 0 && mFile.size() > 0 && mFile.size() + data.size() > mMaxSegmentSize)
+    {
+        mFile.close();
+
+        // Others may have changed the manifest since this run was opened
+        QLockFile lock(mDir.absoluteFilePath(LOCK_NAME));
+        if(!lockManifest(lock, errorString))
+            return false;
+
+        loadManifest();
+        if(!openSegment(true, errorString))
+            return false;
+    }
+
+    if(mFile.write(data) != data.size())
+    {
+        errorString = ERR_WRITE.arg(mFile.fileName(), mFile.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+void SegmentStore::close() { mFile.close(); }
@@ -0,0 +1,108 @@
+#ifndef SEGMENTSTORE_H
+#define SEGMENTSTORE_H
+
+// Qt Includes
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QDir>
+#include <QList>
+#include <QLockFile>
+
+/* Append-only storage split across numbered segment files, with a small manifest that records which runs
+ * ended up in which segment. Writing never touches anything but the newest segment, and retention simply
+ * deletes whole old segments, so the cost of using the store doesn't depend on how much history it holds.
+ * Readers can use the manifest to open only the segments that contain the runs they care about.
+ *
+ * A new segment is started once the current one reaches the maximum size (checked between writes), or when
+ * a run is opened and the current one already holds the maximum number of runs, whichever limits are set.
+ *
+ * Layout:
+ *   <dir>/manifest.json                         {"version":1,"next":N,"segments":[{"id":n,"runs":[...]}, ...]}
+ *   <dir>/manifest.lock
+ *   <dir>/<prefix>-<id, 6 digits>.<extension>
+ *
+ * Separate processes may share a store, so the manifest is only read and rewritten while holding the lock file.
+ * Otherwise not thread-safe, after opening the store is expected to be used by one thread at a time.
+ */
+class SegmentStore
+{
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+private:
+    struct Segment
+    {
+        quint64 id;
+        QStringList runs;
+    };
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    // Manifest
+    static inline const QString MANIFEST_NAME = u"manifest.json"_s;
+    static const int MANIFEST_VERSION = 1;
+    static inline const QString KEY_VERSION = u"version"_s;
+    static inline const QString KEY_NEXT = u"next"_s;
+    static inline const QString KEY_SEGMENTS = u"segments"_s;
+    static inline const QString KEY_ID = u"id"_s;
+    static inline const QString KEY_RUNS = u"runs"_s;
+
+    // Lock
+    static inline const QString LOCK_NAME = u"manifest.lock"_s;
+    static const int LOCK_TIMEOUT = 5000; // ms
+
+    // Errors
+    static inline const QString ERR_MAKE_DIR = u"Could not create directory %1"_s;
+    static inline const QString ERR_OPEN = u"Could not open %1 (%2)"_s;
+    static inline const QString ERR_WRITE = u"Could not write to %1 (%2)"_s;
+    static inline const QString ERR_LOCK = u"Could not lock %1"_s;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    // Properties
+    QDir mDir;
+    QString mPrefix;
+    QString mExtension;
+    qint64 mMaxSegmentSize;
+    int mMaxSegmentRuns;
+    int mMaxSegments;
+
+    // State
+    QList<Segment> mSegments;
+    quint64 mNextId;
+    QString mRun;
+    QFile mFile;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    SegmentStore(const QString& dirPath, const QString& prefix, const QString& extension);
+    SegmentStore(const SegmentStore& other) = delete;
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    QString segmentPath(quint64 id) const;
+    bool lockManifest(QLockFile& lock, QString& errorString) const;
+    void loadManifest();
+    bool saveManifest(QString& errorString);
+    bool openSegment(bool fresh, QString& errorString);
+    void applyRetention();
+
+public:
+    void setMaximumSegmentSize(qint64 bytes);
+    void setMaximumSegmentRuns(int count);
+    void setMaximumSegments(int count);
+
+    QString dirPath() const;
+    QString filePath() const;
+    QFile& file();
+    bool isOpen() const;
+
+    bool open(const QString& run, QString& errorString);
+    bool append(const QByteArray& data, QString& errorString);
+    void close();
+
+//-Operators------------------------------------------------------------------------------------------------------
+public:
+    SegmentStore& operator=(const SegmentStore& other) = delete;
+};
+
+#endif // SEGMENTSTORE_H
@@ -0,0 +1,587 @@
+// Unit Include
+#include "serve.h"
+
+// Qt Includes
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+
+// Qx Includes
+#include <qx/core/qx-genericerror.h>
+
+// Project Includes
+#include "utility.h"
+
+namespace
+{
+
+//-Directive Fields----------------------------------------------------------------------------------------------------
+#define DIRECTIVE_FIELDS(type, ...) \
+    template<typename D> requires std::same_as<std::remove_const_t<D>, type> \
+    auto fields([[maybe_unused]] D& d) { return std::tie(__VA_ARGS__); }
+
+DIRECTIVE_FIELDS(DMessage, d.text, d.selectable)
+DIRECTIVE_FIELDS(DError, d.error)
+DIRECTIVE_FIELDS(DProcedureStart, d.label)
+DIRECTIVE_FIELDS(DProcedureStop)
+DIRECTIVE_FIELDS(DProcedureProgress, d.current)
+DIRECTIVE_FIELDS(DProcedureScale, d.max)
+DIRECTIVE_FIELDS(DClipboardUpdate, d.text)
+DIRECTIVE_FIELDS(DStatusUpdate, d.heading, d.message)
+DIRECTIVE_FIELDS(DBlockingMessage, d.text, d.selectable)
+DIRECTIVE_FIELDS(DBlockingError, d.error, d.choices, d.defaultChoice)
+DIRECTIVE_FIELDS(DSaveFilename, d.caption, d.dir, d.extFilter, d.extFilterDesc)
+DIRECTIVE_FIELDS(DExistingDir, d.caption, d.startingDir)
+DIRECTIVE_FIELDS(DItemSelection, d.caption, d.label, d.items)
+DIRECTIVE_FIELDS(DYesOrNo, d.question)
+
+#undef DIRECTIVE_FIELDS
+
+//-Values--------------------------------------------------------------------------------------------------------------
+template<typename T>
+void writeValue(QDataStream& ds, const T& v)
+{
+    if constexpr(std::same_as<T, Qx::Error>)
+    {
+        /* The concrete error type cannot be reconstructed on the other side, so the error is
+         * reduced to its presentable parts and rebuilt as a generic error.
+         */
+        ds << v.isValid();
+        if(v.isValid())
+            ds << static_cast<quint8>(v.severity()) << v.value() << v.primary() << v.secondary() << v.details() << v.caption();
+    }
+    else
+        ds << v;
+}
+
+template<typename T>
+void readValue(QDataStream& ds, T& v)
+{
+    if constexpr(std::same_as<T, Qx::Error>)
+    {
+        bool valid;
+        ds >> valid;
+        if(!valid)
+        {
+            v = Qx::Error();
+            return;
+        }
+
+        quint8 severity;
+        quint32 value;
+        QString primary, secondary, details, caption;
+        ds >> severity >> value >> primary >> secondary >> details >> caption;
+        v = Qx::GenericError(static_cast<Qx::Severity>(severity), value, primary, secondary, details, caption);
+    }
+    else
+        ds >> v;
+}
+
+template<typename D>
+void writeFields(QDataStream& ds, const D& d)
+{
+    std::apply([&ds](const auto&... f){ (writeValue(ds, f), ...); }, fields(d));
+}
+
+template<typename D>
+void readFields(QDataStream& ds, D& d)
+{
+    std::apply([&ds](auto&... f){ (readValue(ds, f), ...); }, fields(d));
+}
+
+//-Variants------------------------------------------------------------------------------------------------------------
+template<typename V>
+void writeVariant(QDataStream& ds, const V& v)
+{
+    ds << static_cast<quint8>(v.index());
+    std::visit([&ds](const auto& d){ writeFields(ds, d); }, v);
+}
+
+template<typename V, std::size_t I = 0>
+void emplaceVariant(QDataStream& ds, V& v, std::size_t index)
+{
+    if constexpr(I < std::variant_size_v<V>)
+    {
+        if(index == I)
+            readFields(ds, v.template emplace<I>());
+        else
+            emplaceVariant<V, I + 1>(ds, v, index);
+    }
+    else
+        ds.setStatus(QDataStream::ReadCorruptData);
+}
+
+template<typename V>
+void readVariant(QDataStream& ds, V& v)
+{
+    quint8 index;
+    ds >> index;
+    if(ds.status() == QDataStream::Ok)
+        emplaceVariant(ds, v, index);
+}
+
+}
+
+//===============================================================================================================
+// ServeLink
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Protected:
+ServeLink::ServeLink(QObject* parent) :
+    QObject(parent)
+{
+    mStream.setVersion(STREAM_VERSION);
+}
+
+//-Class Functions--------------------------------------------------------------
+//Public:
+QString ServeLink::serverName()
+{
+    // Scope to the deployment so that separate installs don't pick up each other's resident instance
+    QByteArray key = QCryptographicHash::hash(CLIFP_DIR_PATH.toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+    return SERVER_NAME_TEMPLATE.arg(QString::fromLatin1(key));
+}
+
+//-Instance Functions-------------------------------------------------------------
+//Protected:
+void ServeLink::setSocket(QLocalSocket* socket)
+{
+    mSocket = socket;
+    mStream.setDevice(socket);
+    mStream.resetStatus();
+}
+
+void ServeLink::releaseSocket()
+{
+    if(mSocket)
+    {
+        mSocket->disconnect(this);
+        mSocket->disconnectFromServer();
+        mSocket->deleteLater();
+    }
+
+    mSocket = nullptr;
+    mStream.setDevice(nullptr);
+}
+
+void ServeLink::beginFrame(Frame f)
+{
+    Q_ASSERT(mSocket);
+    mStream << static_cast<quint8>(f);
+}
+
+void ServeLink::endFrame() { mSocket->flush(); }
+
+void ServeLink::writeDirective(QDataStream& ds, const AsyncDirective& ad) { writeVariant(ds, ad); }
+void ServeLink::writeDirective(QDataStream& ds, const SyncDirective& sd) { writeVariant(ds, sd); }
+void ServeLink::writeDirective(QDataStream& ds, const RequestDirective& rd) { writeVariant(ds, rd); }
+void ServeLink::readDirective(QDataStream& ds, AsyncDirective& ad) { readVariant(ds, ad); }
+void ServeLink::readDirective(QDataStream& ds, SyncDirective& sd) { readVariant(ds, sd); }
+void ServeLink::readDirective(QDataStream& ds, RequestDirective& rd) { readVariant(ds, rd); }
+
+void ServeLink::writeResponse(QDataStream& ds, const RequestDirective& rd, const void* response)
+{
+    std::visit([&](const auto& d){
+        using R = typename std::decay_t<decltype(d)>::response_type;
+        ds << *static_cast<const R*>(response);
+    }, rd);
+}
+
+void ServeLink::readResponse(QDataStream& ds, const RequestDirective& rd, void* response)
+{
+    std::visit([&](const auto& d){
+        using R = typename std::decay_t<decltype(d)>::response_type;
+        ds >> *static_cast<R*>(response);
+    }, rd);
+}
+
+//Public:
+bool ServeLink::isConnected() const { return mSocket && mSocket->state() == QLocalSocket::ConnectedState; }
+
+//===============================================================================================================
+// ServeHost
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Public:
+ServeHost::ServeHost(QObject* parent) :
+    ServeLink(parent),
+    mServer(this),
+    mSessionActive(false),
+    mAwaitingReply(false),
+    mPendingRequest(nullptr),
+    mPendingResponse(nullptr)
+{
+    mServer.setSocketOptions(QLocalServer::UserAccessOption);
+    connect(&mServer, &QLocalServer::newConnection, this, &ServeHost::handleNewConnection);
+}
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+void ServeHost::awaitReply()
+{
+    // Block the calling (driver) thread until the client answers, like a blocking queued connection would
+    mAwaitingReply = true;
+    while(mAwaitingReply && isConnected())
+    {
+        readFrames();
+        if(mAwaitingReply && !mSocket->waitForReadyRead(-1))
+            break;
+    }
+
+    mAwaitingReply = false;
+    mPendingRequest = nullptr;
+    mPendingResponse = nullptr;
+}
+
+//Public:
+bool ServeHost::listen()
+{
+    /* The caller holds the single instance lock at this point, so any existing server entry can only
+     * be a leftover from a resident instance that didn't shut down cleanly.
+     */
+    const QString name = serverName();
+    QLocalServer::removeServer(name);
+    return mServer.listen(name);
+}
+
+QString ServeHost::errorString() const { return mServer.errorString(); }
+bool ServeHost::hasSession() const { return mSessionActive; }
+
+void ServeHost::endSession(ErrorCode errorCode)
+{
+    if(isConnected())
+    {
+        beginFrame(Frame::Finished);
+        mStream << errorCode;
+        endFrame();
+    }
+
+    releaseSocket();
+    mSessionActive = false;
+}
+
+void ServeHost::acceptNext()
+{
+    if(!mSocket && mServer.hasPendingConnections())
+        handleNewConnection();
+}
+
+void ServeHost::turnAwayPending()
+{
+    // Only one session runs at a time, so tell anyone else straight away instead of leaving them in the backlog
+    while(QLocalSocket* socket = mServer.nextPendingConnection())
+    {
+        QDataStream ds(socket);
+        ds.setVersion(STREAM_VERSION);
+        ds << static_cast<quint8>(Frame::Busy);
+        socket->flush();
+
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        socket->disconnectFromServer();
+    }
+}
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+//Private Slots:
+void ServeHost::handleNewConnection()
+{
+    if(mSocket)
+    {
+        turnAwayPending();
+        return;
+    }
+
+    QLocalSocket* socket = mServer.nextPendingConnection();
+    if(!socket)
+        return;
+
+    setSocket(socket);
+    connect(socket, &QLocalSocket::readyRead, this, &ServeHost::readFrames);
+    connect(socket, &QLocalSocket::disconnected, this, &ServeHost::handleDisconnect);
+
+    // Data may have arrived before the connection was picked up
+    if(socket->bytesAvailable())
+        readFrames();
+}
+
+void ServeHost::handleDisconnect()
+{
+    if(mSessionActive)
+    {
+        // Client went away mid-session, so wind the session down; it ends as normal afterwards
+        QMetaObject::invokeMethod(this, &ServeHost::quitRequested, Qt::QueuedConnection);
+    }
+    else
+    {
+        releaseSocket();
+        acceptNext();
+    }
+}
+
+void ServeHost::readFrames()
+{
+    while(mSocket && mSocket->bytesAvailable())
+    {
+        mStream.startTransaction();
+
+        quint8 tag;
+        mStream >> tag;
+        Frame frame = static_cast<Frame>(tag);
+
+        QStringList arguments;
+        QString workingDir;
+        QStringList environment;
+        switch(frame)
+        {
+            case Frame::Command:
+                mStream >> arguments >> workingDir >> environment;
+                break;
+
+            case Frame::Response:
+                if(!mPendingRequest)
+                {
+                    mStream.abortTransaction();
+                    break;
+                }
+                readResponse(mStream, *mPendingRequest, mPendingResponse);
+                break;
+
+            case Frame::SyncAck:
+            case Frame::Cancel:
+            case Frame::Quit:
+                break;
+
+            default:
+                mStream.abortTransaction();
+        }
+
+        if(!mStream.commitTransaction())
+        {
+            // Either wait for the rest of the frame, or drop a client that is speaking nonsense
+            if(mStream.status() != QDataStream::ReadPastEnd)
+                mSocket->disconnectFromServer();
+            return;
+        }
+
+        switch(frame)
+        {
+            case Frame::Command:
+                if(!mSessionActive)
+                {
+                    // Queued so that the session doesn't run from within this handler
+                    mSessionActive = true;
+                    QMetaObject::invokeMethod(this, [this, arguments, workingDir, environment]{
+                        QProcessEnvironment env;
+                        for(const QString& var : environment)
+                            if(qsizetype eq = var.indexOf('='); eq > 0)
+                                env.insert(var.left(eq), var.sliced(eq + 1));
+                        emit sessionRequested(arguments, workingDir, env);
+                    }, Qt::QueuedConnection);
+                }
+                break;
+
+            case Frame::SyncAck:
+            case Frame::Response:
+                mAwaitingReply = false;
+                break;
+
+            case Frame::Cancel:
+                QMetaObject::invokeMethod(this, &ServeHost::cancelRequested, Qt::QueuedConnection);
+                break;
+
+            case Frame::Quit:
+                QMetaObject::invokeMethod(this, &ServeHost::quitRequested, Qt::QueuedConnection);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+//Public Slots:
+void ServeHost::relayAsyncDirective(const AsyncDirective& aDirective)
+{
+    if(!isConnected())
+        return;
+
+    beginFrame(Frame::Async);
+    writeDirective(mStream, aDirective);
+    endFrame();
+}
+
+void ServeHost::relaySyncDirective(const SyncDirective& sDirective)
+{
+    if(!isConnected())
+        return;
+
+    beginFrame(Frame::Sync);
+    writeDirective(mStream, sDirective);
+    endFrame();
+    awaitReply();
+}
+
+void ServeHost::relayRequestDirective(const RequestDirective& rDirective, void* response)
+{
+    // If the client is gone the response is left as the default, just like a silenced directive
+    if(!isConnected())
+        return;
+
+    mPendingRequest = &rDirective;
+    mPendingResponse = response;
+
+    beginFrame(Frame::Request);
+    writeDirective(mStream, rDirective);
+    endFrame();
+    awaitReply();
+}
+
+//===============================================================================================================
+// ServeClient
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Public:
+ServeClient::ServeClient(QObject* parent) :
+    ServeLink(parent),
+    mFinished(false)
+{}
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+bool ServeClient::connectToHost()
+{
+    QLocalSocket* socket = new QLocalSocket(this);
+    socket->connectToServer(serverName());
+    if(!socket->waitForConnected(CONNECT_TIMEOUT))
+    {
+        delete socket;
+        return false;
+    }
+
+    setSocket(socket);
+    connect(socket, &QLocalSocket::readyRead, this, &ServeClient::readFrames);
+    connect(socket, &QLocalSocket::disconnected, this, [this]{
+        if(!mFinished)
+            emit connectionLost();
+    });
+
+    return true;
+}
+
+void ServeClient::sendCommand(const QStringList& arguments)
+{
+    // The host acts on the invoker's behalf, so relative paths and child processes need to be as they'd be here
+    beginFrame(Frame::Command);
+    mStream << arguments << QDir::currentPath() << QProcessEnvironment::systemEnvironment().toStringList();
+    endFrame();
+}
+
+void ServeClient::sendCancel()
+{
+    if(!isConnected())
+        return;
+
+    beginFrame(Frame::Cancel);
+    endFrame();
+}
+
+void ServeClient::sendQuit()
+{
+    if(!isConnected())
+        return;
+
+    beginFrame(Frame::Quit);
+    endFrame();
+}
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+//Private Slots:
+void ServeClient::readFrames()
+{
+    while(!mFinished && mSocket && mSocket->bytesAvailable())
+    {
+        mStream.startTransaction();
+
+        quint8 tag;
+        mStream >> tag;
+        Frame frame = static_cast<Frame>(tag);
+
+        AsyncDirective ad;
+        SyncDirective sd;
+        RequestDirective rd;
+        ErrorCode errorCode = 0;
+        switch(frame)
+        {
+            case Frame::Async:
+                readDirective(mStream, ad);
+                break;
+
+            case Frame::Sync:
+                readDirective(mStream, sd);
+                break;
+
+            case Frame::Request:
+                readDirective(mStream, rd);
+                break;
+
+            case Frame::Finished:
+                mStream >> errorCode;
+                break;
+
+            case Frame::Busy:
+                break;
+
+            default:
+                mStream.abortTransaction();
+        }
+
+        if(!mStream.commitTransaction())
+        {
+            if(mStream.status() != QDataStream::ReadPastEnd)
+                mSocket->disconnectFromServer();
+            return;
+        }
+
+        switch(frame)
+        {
+            case Frame::Async:
+                emit asyncDirectiveReceived(ad);
+                break;
+
+            case Frame::Sync:
+                emit syncDirectiveReceived(sd);
+                beginFrame(Frame::SyncAck);
+                endFrame();
+                break;
+
+            case Frame::Request:
+                std::visit([&](const auto& d){
+                    using R = typename std::decay_t<decltype(d)>::response_type;
+                    R response{};
+                    emit requestDirectiveReceived(rd, &response);
+
+                    beginFrame(Frame::Response);
+                    writeResponse(mStream, rd, &response);
+                    endFrame();
+                }, rd);
+                break;
+
+            case Frame::Finished:
+                mFinished = true;
+                emit finished(errorCode);
+                break;
+
+            case Frame::Busy:
+                // Not an error, the caller decides what to do instead
+                mFinished = true;
+                emit busy();
+                break;
+
+            default:
+                break;
+        }
+    }
+}
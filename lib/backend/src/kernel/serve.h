@@ -0,0 +1,162 @@
+#ifndef SERVE_H
+#define SERVE_H
+
+// Qt Includes
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDataStream>
+#include <QPointer>
+#include <QProcessEnvironment>
+
+// Project Includes
+#include "kernel/directive.h"
+#include "kernel/errorcode.h"
+
+/* Resident mode is split into a host, which keeps the Flashpoint install warm and runs forwarded command lines one at
+ * a time, and a client, which only forwards its command line and relays the host's directives to its own frontend.
+ *
+ * Both sides speak the same small protocol over a local socket; each frame is a Frame tag followed by its payload,
+ * streamed with QDataStream.
+ */
+
+class ServeLink : public QObject
+{
+    Q_OBJECT;
+//-Class Enums-----------------------------------------------------------------------
+protected:
+    enum class Frame : quint8
+    {
+        Command,     // C -> H: QStringList arguments, QString working directory, QStringList environment
+        Async,       // H -> C: AsyncDirective
+        Sync,        // H -> C: SyncDirective
+        SyncAck,     // C -> H: (none)
+        Request,     // H -> C: RequestDirective
+        Response,    // C -> H: RequestDirective::response_type
+        Cancel,      // C -> H: (none)
+        Quit,        // C -> H: (none)
+        Finished,    // H -> C: ErrorCode
+        Busy         // H -> C: (none)
+    };
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+protected:
+    static const QDataStream::Version STREAM_VERSION = QDataStream::Qt_6_0;
+    static inline const QString SERVER_NAME_TEMPLATE = u"CLIFp_RESIDENT_%1"_s;
+
+//-Instance Variables------------------------------------------------------------------------------------------------------
+protected:
+    QPointer<QLocalSocket> mSocket;
+    QDataStream mStream;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+protected:
+    explicit ServeLink(QObject* parent = nullptr);
+
+//-Class Functions----------------------------------------------------------------------------------------------------------
+public:
+    static QString serverName();
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+protected:
+    void setSocket(QLocalSocket* socket);
+    void releaseSocket();
+    void beginFrame(Frame f);
+    void endFrame();
+
+    // Frame payload IO
+    static void writeDirective(QDataStream& ds, const AsyncDirective& ad);
+    static void writeDirective(QDataStream& ds, const SyncDirective& sd);
+    static void writeDirective(QDataStream& ds, const RequestDirective& rd);
+    static void readDirective(QDataStream& ds, AsyncDirective& ad);
+    static void readDirective(QDataStream& ds, SyncDirective& sd);
+    static void readDirective(QDataStream& ds, RequestDirective& rd);
+    static void writeResponse(QDataStream& ds, const RequestDirective& rd, const void* response);
+    static void readResponse(QDataStream& ds, const RequestDirective& rd, void* response);
+
+public:
+    bool isConnected() const;
+};
+
+class ServeHost : public ServeLink
+{
+    Q_OBJECT;
+//-Instance Variables------------------------------------------------------------------------------------------------------
+private:
+    QLocalServer mServer;
+    bool mSessionActive;
+
+    // Blocking exchange state
+    bool mAwaitingReply;
+    const RequestDirective* mPendingRequest;
+    void* mPendingResponse;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    explicit ServeHost(QObject* parent = nullptr);
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    void awaitReply();
+
+public:
+    bool listen();
+    QString errorString() const;
+    bool hasSession() const;
+    void endSession(ErrorCode errorCode);
+    void acceptNext();
+    void turnAwayPending();
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+private slots:
+    void handleNewConnection();
+    void handleDisconnect();
+    void readFrames();
+
+public slots:
+    void relayAsyncDirective(const AsyncDirective& aDirective);
+    void relaySyncDirective(const SyncDirective& sDirective);
+    void relayRequestDirective(const RequestDirective& rDirective, void* response);
+
+signals:
+    void sessionRequested(const QStringList& arguments, const QString& workingDir, const QProcessEnvironment& environment);
+    void cancelRequested();
+    void quitRequested();
+};
+
+class ServeClient : public ServeLink
+{
+    Q_OBJECT;
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    static const int CONNECT_TIMEOUT = 100;
+
+//-Instance Variables------------------------------------------------------------------------------------------------------
+private:
+    bool mFinished;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    explicit ServeClient(QObject* parent = nullptr);
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+public:
+    bool connectToHost();
+    void sendCommand(const QStringList& arguments); // Sent along with where and how this process was invoked
+    void sendCancel();
+    void sendQuit();
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+private slots:
+    void readFrames();
+
+signals:
+    void asyncDirectiveReceived(const AsyncDirective& aDirective);
+    void syncDirectiveReceived(const SyncDirective& sDirective);
+    void requestDirectiveReceived(const RequestDirective& rDirective, void* response);
+    void finished(ErrorCode errorCode);
+    void busy();
+    void connectionLost();
+};
+
+#endif // SERVE_H
@@ -0,0 +1,219 @@
+// Unit Include
+#include "tracer.h"
+
+// Qt Includes
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+//===============================================================================================================
+// Tracer::Span
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Private:
+Tracer::Span::Span(Tracer* tracer, const QString& name, const QString& category) :
+    mTracer(tracer),
+    mName(name),
+    mCategory(category),
+    mStart(tracer->now())
+{}
+
+//Public:
+Tracer::Span::Span() :
+    mTracer(nullptr),
+    mStart(0)
+{}
+
+Tracer::Span::Span(Span&& other) :
+    mTracer(std::exchange(other.mTracer, nullptr)),
+    mName(std::move(other.mName)),
+    mCategory(std::move(other.mCategory)),
+    mStart(other.mStart)
+{}
+
+//-Destructor--------------------------------------------------------------------
+//Public:
+Tracer::Span::~Span() { end(); }
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+void Tracer::Span::end()
+{
+    if(!mTracer)
+        return;
+
+    qint64 end = mTracer->now();
+    mTracer->record({
+        .name = std::move(mName),
+        .category = std::move(mCategory),
+        .phase = 'X',
+        .timestamp = mStart,
+        .duration = end - mStart,
+        .id = 0,
+        .thread = 0
+    });
+    mTracer = nullptr;
+}
+
+//-Operators--------------------------------------------------------------------
+//Public:
+Tracer::Span& Tracer::Span::operator=(Span&& other)
+{
+    if(this != &other)
+    {
+        end();
+        mTracer = std::exchange(other.mTracer, nullptr);
+        mName = std::move(other.mName);
+        mCategory = std::move(other.mCategory);
+        mStart = other.mStart;
+    }
+
+    return *this;
+}
+
+//===============================================================================================================
+// Tracer
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Public:
+Tracer::Tracer() :
+    mEnabled(false)
+{}
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+qint64 Tracer::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mOrigin).count();
+}
+
+int Tracer::threadId()
+{
+    Qt::HANDLE handle = QThread::currentThreadId();
+    if(auto itr = mThreadIds.constFind(handle); itr != mThreadIds.cend())
+        return *itr;
+
+    // Use sequential IDs for readability, and capture the name while on the thread in question
+    int id = mThreadIds.size();
+    mThreadIds.insert(handle, id);
+
+    QThread* thread = QThread::currentThread();
+    QString name = thread->objectName();
+    if(name.isEmpty())
+        name = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread() ? MAIN_THREAD_NAME : THREAD_NAME_TEMPLATE.arg(id);
+    mThreadNames.append(name);
+
+    return id;
+}
+
+void Tracer::record(Event&& e)
+{
+    QMutexLocker lock(&mMutex);
+    e.thread = threadId();
+    mEvents.append(std::move(e));
+}
+
+//Public:
+void Tracer::enable(const QString& filePath)
+{
+    mFilePath = filePath;
+    mOrigin = std::chrono::steady_clock::now();
+    mEnabled = true;
+}
+
+bool Tracer::isEnabled() const { return mEnabled; }
+QString Tracer::filePath() const { return mFilePath; }
+
+Tracer::Span Tracer::span(const QString& name, const QString& category)
+{
+    return mEnabled ? Span(this, name, category) : Span();
+}
+
+void Tracer::instant(const QString& name, const QString& category)
+{
+    if(!mEnabled)
+        return;
+
+    record({.name = name, .category = category, .phase = 'i', .timestamp = now(), .duration = 0, .id = 0, .thread = 0});
+}
+
+void Tracer::beginAsync(const QString& name, quint64 id, const QString& category)
+{
+    if(!mEnabled)
+        return;
+
+    record({.name = name, .category = category, .phase = 'b', .timestamp = now(), .duration = 0, .id = id, .thread = 0});
+}
+
+void Tracer::endAsync(const QString& name, quint64 id, const QString& category)
+{
+    if(!mEnabled)
+        return;
+
+    record({.name = name, .category = category, .phase = 'e', .timestamp = now(), .duration = 0, .id = id, .thread = 0});
+}
+
+bool Tracer::write(QString* errorString)
+{
+    if(!mEnabled)
+        return true;
+
+    QMutexLocker lock(&mMutex);
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    for(const Event& e : std::as_const(mEvents))
+    {
+        // Trace Event timestamps are in microseconds, fractions are allowed
+        QJsonObject obj{
+            {u"name"_s, e.name},
+            {u"cat"_s, e.category.isEmpty() ? DEFAULT_CATEGORY : e.category},
+            {u"ph"_s, QString(QChar(e.phase))},
+            {u"ts"_s, e.timestamp / 1000.0},
+            {u"pid"_s, pid},
+            {u"tid"_s, e.thread}
+        };
+
+        if(e.phase == 'X')
+            obj[u"dur"_s] = e.duration / 1000.0;
+        else if(e.phase == 'i')
+            obj[u"s"_s] = u"t"_s;
+        else
+            obj[u"id"_s] = QString::number(e.id, 16);
+
+        traceEvents.append(obj);
+    }
+
+    // Thread names
+    for(qsizetype i = 0; i < mThreadNames.size(); ++i)
+    {
+        traceEvents.append(QJsonObject{
+            {u"name"_s, u"thread_name"_s},
+            {u"ph"_s, u"M"_s},
+            {u"pid"_s, pid},
+            {u"tid"_s, i},
+            {u"args"_s, QJsonObject{{u"name"_s, mThreadNames.at(i)}}}
+        });
+    }
+
+    QJsonObject root{
+        {u"traceEvents"_s, traceEvents},
+        {u"displayTimeUnit"_s, u"ms"_s}
+    };
+
+    QSaveFile file(mFilePath);
+    if(!file.open(QIODevice::WriteOnly) ||
+       file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0 ||
+       !file.commit())
+    {
+        if(errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+// Standard Library Includes
+#include <chrono>
+
+// Qt Includes
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+
+// Qx Includes
+#include <qx/utility/qx-macros.h>
+
+/* Records a timeline of the run in the Chrome Trace Event format, which can be opened with Perfetto
+ * (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Recording is thread-safe and all timestamps come from a monotonic clock, relative to when tracing was
+ * enabled. When tracing isn't enabled every recording function returns immediately.
+ */
+class Tracer
+{
+//-Inner Classes-------------------------------------------------------------------------------------------------------
+public:
+    class Span
+    {
+        friend class Tracer;
+    //-Instance Variables------------------------------------------------------------------------------------------------
+    private:
+        Tracer* mTracer;
+        QString mName;
+        QString mCategory;
+        qint64 mStart;
+
+    //-Constructor----------------------------------------------------------------------------------------------------------
+    private:
+        Span(Tracer* tracer, const QString& name, const QString& category);
+
+    public:
+        Span();
+        Span(Span&& other);
+        Span(const Span& other) = delete;
+
+    //-Destructor----------------------------------------------------------------------------------------------------------
+    public:
+        ~Span();
+
+    //-Instance Functions------------------------------------------------------------------------------------------------------
+    public:
+        void end();
+
+    //-Operators------------------------------------------------------------------------------------------------------
+    public:
+        Span& operator=(Span&& other);
+        Span& operator=(const Span& other) = delete;
+    };
+
+//-Class Structs-------------------------------------------------------------------------------------------------------
+private:
+    struct Event
+    {
+        QString name;
+        QString category;
+        char phase;
+        qint64 timestamp; // ns
+        qint64 duration; // ns, complete events only
+        quint64 id; // Async events only
+        int thread;
+    };
+
+//-Class Variables-------------------------------------------------------------------------------------------------
+private:
+    static inline const QString DEFAULT_CATEGORY = u"clifp"_s;
+    static inline const QString THREAD_NAME_TEMPLATE = u"Thread %1"_s;
+    static inline const QString MAIN_THREAD_NAME = u"Main"_s;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    bool mEnabled;
+    QString mFilePath;
+    std::chrono::steady_clock::time_point mOrigin;
+
+    mutable QMutex mMutex;
+    QList<Event> mEvents;
+    QHash<Qt::HANDLE, int> mThreadIds;
+    QList<QString> mThreadNames;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    Tracer();
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    qint64 now() const;
+    int threadId(); // Requires lock
+    void record(Event&& e);
+
+public:
+    void enable(const QString& filePath);
+    bool isEnabled() const;
+    QString filePath() const;
+
+    [[nodiscard]] Span span(const QString& name, const QString& category = {});
+    void instant(const QString& name, const QString& category = {});
+    void beginAsync(const QString& name, quint64 id, const QString& category = {});
+    void endAsync(const QString& name, quint64 id, const QString& category = {});
+
+    bool write(QString* errorString = nullptr);
+};
+
+#endif // TRACER_H
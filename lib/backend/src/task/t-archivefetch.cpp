@@ -0,0 +1,197 @@
+// Unit Include
+#include "t-archivefetch.h"
+
+// Qt Includes
+#include <QDir>
+#include <QElapsedTimer>
+
+// Project Includes
+#include "tools/archiveaccess.h"
+
+//===============================================================================================================
+// TArchiveFetchError
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Private:
+TArchiveFetchError::TArchiveFetchError(Type t, const QString& s) :
+    mType(t),
+    mSpecific(s)
+{}
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+bool TArchiveFetchError::isValid() const { return mType != NoError; }
+QString TArchiveFetchError::specific() const { return mSpecific; }
+TArchiveFetchError::Type TArchiveFetchError::type() const { return mType; }
+
+//Private:
+Qx::Severity TArchiveFetchError::deriveSeverity() const { return Qx::Critical; }
+quint32 TArchiveFetchError::deriveValue() const { return mType; }
+QString TArchiveFetchError::derivePrimary() const { return ERR_STRINGS.value(mType); }
+QString TArchiveFetchError::deriveSecondary() const { return mSpecific; }
+
+//===============================================================================================================
+// TArchiveFetch
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Public:
+TArchiveFetch::TArchiveFetch(Core& core) :
+    Task(core),
+    mArchive(nullptr),
+    mHash(QCryptographicHash::Sha256),
+    mTransferred(0),
+    mStopRequested(false)
+{}
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+void TArchiveFetch::finalize()
+{
+    postDirective<DProcedureProgress>(mTransferred);
+    mSource.reset();
+
+    if(mHash.result().toHex().compare(mSha256.toLatin1(), Qt::CaseInsensitive) != 0)
+    {
+        finish(TArchiveFetchError(TArchiveFetchError::ChecksumMismatch, mPathInArchive));
+        return;
+    }
+
+    // Atomically move into place
+    if(!mDestination->commit())
+    {
+        finish(TArchiveFetchError(TArchiveFetchError::WriteDiskFile, mDestination->errorString()));
+        return;
+    }
+
+    logEvent(LOG_EVENT_FETCHED.arg(mTransferred));
+    finish(TArchiveFetchError());
+}
+
+void TArchiveFetch::finish(const Qx::Error& errorState)
+{
+    // Dropping an uncommitted QSaveFile discards the temporary file, leaving the destination untouched
+    mSource.reset();
+    mDestination.reset();
+    mBuffer = QByteArray();
+
+    postDirective<DProcedureStop>();
+    if(errorState.isValid())
+        postDirective<DError>(errorState);
+
+    complete(errorState);
+}
+
+//Public:
+QString TArchiveFetch::name() const { return NAME; }
+QStringList TArchiveFetch::members() const
+{
+    QStringList ml = Task::members();
+    ml.append(u".pathInArchive() = \""_s + mPathInArchive + u"\""_s);
+    ml.append(u".destinationPath() = \""_s + QDir::toNativeSeparators(mDestinationPath) + u"\""_s);
+    ml.append(u".sha256() = "_s + mSha256);
+    return ml;
+}
+
+ArchiveAccess* TArchiveFetch::archive() const { return mArchive; }
+QString TArchiveFetch::pathInArchive() const { return mPathInArchive; }
+QString TArchiveFetch::destinationPath() const { return mDestinationPath; }
+QString TArchiveFetch::sha256() const { return mSha256; }
+
+void TArchiveFetch::setArchive(ArchiveAccess* archive) { mArchive = archive; }
+void TArchiveFetch::setPathInArchive(const QString& path) { mPathInArchive = path; }
+void TArchiveFetch::setDestinationPath(const QString& path) { mDestinationPath = path; }
+void TArchiveFetch::setSha256(const QString& sha256) { mSha256 = sha256; }
+
+void TArchiveFetch::perform()
+{
+    Q_ASSERT(mArchive);
+
+    // Log/label string
+    QString label = LOG_EVENT_FETCHING.arg(QFileInfo(mDestinationPath).fileName());
+    logEvent(label);
+    postDirective<DProcedureStart>(label);
+
+    // Open source
+    if(ArchiveAccessError ae = mArchive->openFile(mSource, mPathInArchive); ae.isValid())
+    {
+        logError(ae);
+        finish(ae.type() == ArchiveAccessError::FileNotFound ?
+               TArchiveFetchError(TArchiveFetchError::NotInArchive, mPathInArchive) :
+               TArchiveFetchError(TArchiveFetchError::OpenArchiveFile, ae.specific()));
+        return;
+    }
+
+    // Open destination
+    QFileInfo destInfo(mDestinationPath);
+    mDestination = std::make_unique<QSaveFile>(mDestinationPath);
+    if(!destInfo.absoluteDir().mkpath(u"."_s) || !mDestination->open(QIODevice::WriteOnly))
+    {
+        finish(TArchiveFetchError(TArchiveFetchError::OpenDiskFile, mDestination->errorString()));
+        return;
+    }
+
+    // Start
+    mHash.reset();
+    mTransferred = 0;
+    mStopRequested = false;
+    mBuffer.resize(CHUNK_SIZE);
+    postDirective<DProcedureScale>(mSource->size());
+    postDirective<DProcedureProgress>(0);
+
+    QMetaObject::invokeMethod(this, &TArchiveFetch::transferSlice, Qt::QueuedConnection);
+}
+
+void TArchiveFetch::stop()
+{
+    if(mSource)
+    {
+        logEvent(LOG_EVENT_STOPPING);
+        mStopRequested = true;
+    }
+}
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------
+//Private Slots:
+void TArchiveFetch::transferSlice()
+{
+    if(mStopRequested)
+    {
+        finish(TArchiveFetchError(TArchiveFetchError::Aborted, mPathInArchive));
+        return;
+    }
+
+    QElapsedTimer slice;
+    slice.start();
+    do
+    {
+        qint64 read = mSource->read(mBuffer.data(), mBuffer.size());
+        if(read < 0)
+        {
+            finish(TArchiveFetchError(TArchiveFetchError::ReadArchiveFile, mSource->errorString()));
+            return;
+        }
+
+        if(read == 0)
+        {
+            finalize();
+            return;
+        }
+
+        QByteArrayView chunk(mBuffer.constData(), read);
+        mHash.addData(chunk);
+        if(mDestination->write(chunk.data(), chunk.size()) != read)
+        {
+            finish(TArchiveFetchError(TArchiveFetchError::WriteDiskFile, mDestination->errorString()));
+            return;
+        }
+
+        mTransferred += read;
+    }
+    while(slice.elapsed() < SLICE_DURATION);
+
+    // Yield so that progress, other tasks, and stop requests are serviced
+    postDirective<DProcedureProgress>(mTransferred);
+    QMetaObject::invokeMethod(this, &TArchiveFetch::transferSlice, Qt::QueuedConnection);
+}
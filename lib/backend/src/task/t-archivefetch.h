@@ -0,0 +1,142 @@
+#ifndef TARCHIVEFETCH_H
+#define TARCHIVEFETCH_H
+
+// Standard Library Includes
+#include <memory>
+
+// Qt Includes
+#include <QCryptographicHash>
+#include <QSaveFile>
+
+// Qx Includes
+#include <qx/utility/qx-macros.h>
+
+// Project Includes
+#include "task/task.h"
+
+class ArchiveAccess;
+
+class QX_ERROR_TYPE(TArchiveFetchError, "TArchiveFetchError", 1257)
+{
+    friend class TArchiveFetch;
+//-Class Enums-------------------------------------------------------------
+public:
+    enum Type
+    {
+        NoError,
+        NotInArchive,
+        OpenArchiveFile,
+        ReadArchiveFile,
+        OpenDiskFile,
+        WriteDiskFile,
+        ChecksumMismatch,
+        Aborted
+    };
+
+//-Class Variables-------------------------------------------------------------
+private:
+    static inline const QHash<Type, QString> ERR_STRINGS{
+        {NoError, u""_s},
+        {NotInArchive, u"The file could not be found in the archive."_s},
+        {OpenArchiveFile, u"Failed to open the file within the archive."_s},
+        {ReadArchiveFile, u"Failed to read the file from the archive."_s},
+        {OpenDiskFile, u"Failed to open disk file."_s},
+        {WriteDiskFile, u"Failed to write disk file."_s},
+        {ChecksumMismatch, u"The file from the archive is corrupted."_s},
+        {Aborted, u"The transfer was aborted."_s}
+    };
+
+//-Instance Variables-------------------------------------------------------------
+private:
+    Type mType;
+    QString mSpecific;
+
+//-Constructor-------------------------------------------------------------
+private:
+    TArchiveFetchError(Type t = NoError, const QString& s = {});
+
+//-Instance Functions-------------------------------------------------------------
+public:
+    bool isValid() const;
+    Type type() const;
+    QString specific() const;
+
+private:
+    Qx::Severity deriveSeverity() const override;
+    quint32 deriveValue() const override;
+    QString derivePrimary() const override;
+    QString deriveSecondary() const override;
+};
+
+/* Copies a file out of an archive to disk, in chunks, so that memory use doesn't scale with the size of
+ * the file. Each turn of the event loop processes a bounded slice of work so that progress is reported
+ * and the task can be stopped part way through.
+ *
+ * The data is hashed as it's written to a temporary file, which only replaces the destination if the
+ * checksum matches.
+ */
+class TArchiveFetch : public Task
+{
+    Q_OBJECT;
+//-Class Variables-------------------------------------------------------------------------------------------------
+private:
+    // Meta
+    static inline const QString NAME = u"TArchiveFetch"_s;
+
+    // Logging
+    static inline const QString LOG_EVENT_FETCHING = u"Retrieving %1 from archive"_s;
+    static inline const QString LOG_EVENT_FETCHED = u"Retrieved %1 bytes from archive, checksum matches"_s;
+    static inline const QString LOG_EVENT_STOPPING = u"Stopping archive retrieval..."_s;
+
+    // Transfer
+    static const qint64 CHUNK_SIZE = 1024 * 1024; // 1 MiB
+    static const int SLICE_DURATION = 20; // ms of work per event loop turn
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    // Data
+    ArchiveAccess* mArchive;
+    QString mPathInArchive;
+    QString mDestinationPath;
+    QString mSha256;
+
+    // Transfer
+    std::unique_ptr<QIODevice> mSource;
+    std::unique_ptr<QSaveFile> mDestination;
+    QCryptographicHash mHash;
+    QByteArray mBuffer;
+    qint64 mTransferred;
+    bool mStopRequested;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    TArchiveFetch(Core& core);
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    void finalize();
+    void finish(const Qx::Error& errorState);
+
+public:
+    QString name() const override;
+    QStringList members() const override;
+
+    ArchiveAccess* archive() const;
+    QString pathInArchive() const;
+    QString destinationPath() const;
+    QString sha256() const;
+
+    void setArchive(ArchiveAccess* archive);
+    void setPathInArchive(const QString& path);
+    void setDestinationPath(const QString& path);
+    void setSha256(const QString& sha256);
+
+    void perform() override;
+    void stop() override;
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+private slots:
+    void transferSlice();
+};
+
+#endif // TARCHIVEFETCH_H
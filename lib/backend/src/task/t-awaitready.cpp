@@ -0,0 +1,161 @@
+// Unit Include
+#include "t-awaitready.h"
+
+//===============================================================================================================
+// TAwaitReadyError
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Private:
+TAwaitReadyError::TAwaitReadyError(Type t, const QString& s) :
+    mType(t),
+    mSpecific(s)
+{}
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+bool TAwaitReadyError::isValid() const { return mType != NoError; }
+QString TAwaitReadyError::specific() const { return mSpecific; }
+TAwaitReadyError::Type TAwaitReadyError::type() const { return mType; }
+
+//Private:
+Qx::Severity TAwaitReadyError::deriveSeverity() const { return Qx::Warning; }
+quint32 TAwaitReadyError::deriveValue() const { return mType; }
+QString TAwaitReadyError::derivePrimary() const { return ERR_STRINGS.value(mType); }
+QString TAwaitReadyError::deriveSecondary() const { return mSpecific; }
+
+//===============================================================================================================
+// TAwaitReady
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Public:
+TAwaitReady::TAwaitReady(Core& core) :
+    Task(core),
+    mTimeout(0),
+    mInterval(DEFAULT_INTERVAL)
+{
+    connect(&mPollTimer, &QTimer::timeout, this, &TAwaitReady::pollTick);
+}
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+void TAwaitReady::probe(Probe& p)
+{
+    // One connection attempt in flight per endpoint at a time
+    if(p.ready || p.attempt)
+        return;
+
+    QTcpSocket* socket = new QTcpSocket(this);
+    p.attempt = socket;
+    qsizetype index = &p - mProbes.data();
+
+    connect(socket, &QTcpSocket::connected, this, [this, socket, index]{
+        if(index >= mProbes.size()) // Probing already concluded
+            return;
+
+        Probe& cp = mProbes[index];
+        cp.ready = true;
+        logEvent(LOG_EVENT_ENDPOINT_READY.arg(cp.endpoint.host).arg(cp.endpoint.port).arg(mElapsed.elapsed()));
+        socket->abort();
+        socket->deleteLater();
+
+        if(std::all_of(mProbes.cbegin(), mProbes.cend(), [](const Probe& p){ return p.ready; }))
+        {
+            logEvent(LOG_EVENT_ALL_READY);
+            finishProbing(TAwaitReadyError());
+        }
+    });
+    connect(socket, &QTcpSocket::errorOccurred, socket, &QObject::deleteLater); // Retried on a later tick
+
+    socket->connectToHost(p.endpoint.host, p.endpoint.port);
+}
+
+void TAwaitReady::finishProbing(const TAwaitReadyError& error)
+{
+    mPollTimer.stop();
+    for(Probe& p : mProbes)
+        if(p.attempt)
+            p.attempt->abort();
+    mProbes.clear();
+
+    // Not being ready isn't fatal, whatever needs the service will report its own error if it's truly missing
+    if(error.isValid())
+        logError(error);
+
+    emit complete(TAwaitReadyError());
+}
+
+//Public:
+QString TAwaitReady::name() const { return NAME; }
+QStringList TAwaitReady::members() const
+{
+    QStringList endpointStrs;
+    for(const Endpoint& e : mEndpoints)
+        endpointStrs.append(e.host + ':' + QString::number(e.port));
+
+    QStringList ml = Task::members();
+    ml.append(u".endpoints() = {"_s + endpointStrs.join(u", "_s) + u"}"_s);
+    ml.append(u".timeout() = "_s + QString::number(mTimeout));
+    ml.append(u".interval() = "_s + QString::number(mInterval));
+    return ml;
+}
+
+QList<TAwaitReady::Endpoint> TAwaitReady::endpoints() const { return mEndpoints; }
+uint TAwaitReady::timeout() const { return mTimeout; }
+uint TAwaitReady::interval() const { return mInterval; }
+
+void TAwaitReady::setEndpoints(const QList<Endpoint>& endpoints) { mEndpoints = endpoints; }
+void TAwaitReady::setTimeout(uint msecs) { mTimeout = msecs; }
+void TAwaitReady::setInterval(uint msecs) { mInterval = msecs; }
+
+void TAwaitReady::perform()
+{
+    if(mEndpoints.isEmpty())
+    {
+        emit complete(TAwaitReadyError());
+        return;
+    }
+
+    logEvent(LOG_EVENT_PROBING.arg(mTimeout).arg(mEndpoints.size()));
+
+    mProbes.clear();
+    for(const Endpoint& e : std::as_const(mEndpoints))
+        mProbes.append({.endpoint = e});
+
+    mElapsed.start();
+    mDeadline.setRemainingTime(mTimeout);
+    mPollTimer.start(mInterval);
+
+    // First attempt right away, most of the time a service is already up
+    for(Probe& p : mProbes)
+        probe(p);
+}
+
+void TAwaitReady::stop()
+{
+    if(mPollTimer.isActive())
+    {
+        logEvent(LOG_EVENT_PROBING_STOPPED);
+        finishProbing(TAwaitReadyError());
+    }
+}
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------
+//Private Slots:
+void TAwaitReady::pollTick()
+{
+    if(mDeadline.hasExpired())
+    {
+        QStringList waiting;
+        for(const Probe& p : std::as_const(mProbes))
+            if(!p.ready)
+                waiting.append(p.endpoint.host + ':' + QString::number(p.endpoint.port));
+
+        finishProbing(TAwaitReadyError(TAwaitReadyError::NotReady, waiting.join(u", "_s)));
+        return;
+    }
+
+    for(Probe& p : mProbes)
+        probe(p);
+}
@@ -0,0 +1,129 @@
+#ifndef TAWAITREADY_H
+#define TAWAITREADY_H
+
+// Qt Includes
+#include <QTimer>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTcpSocket>
+
+// Project Includes
+#include "task/task.h"
+
+class QX_ERROR_TYPE(TAwaitReadyError, "TAwaitReadyError", 1261)
+{
+    friend class TAwaitReady;
+//-Class Enums-------------------------------------------------------------
+public:
+    enum Type
+    {
+        NoError = 0,
+        NotReady = 1
+    };
+
+//-Class Variables-------------------------------------------------------------
+private:
+    static inline const QHash<Type, QString> ERR_STRINGS{
+        {NoError, u""_s},
+        {NotReady, u"A service did not become ready in time, continuing anyway."_s}
+    };
+
+//-Instance Variables-------------------------------------------------------------
+private:
+    Type mType;
+    QString mSpecific;
+
+//-Constructor-------------------------------------------------------------
+private:
+    TAwaitReadyError(Type t = NoError, const QString& s = {});
+
+//-Instance Functions-------------------------------------------------------------
+public:
+    bool isValid() const;
+    Type type() const;
+    QString specific() const;
+
+private:
+    Qx::Severity deriveSeverity() const override;
+    quint32 deriveValue() const override;
+    QString derivePrimary() const override;
+    QString deriveSecondary() const override;
+};
+
+class TAwaitReady : public Task
+{
+    Q_OBJECT;
+//-Class Structs-------------------------------------------------------------------------------------------------
+public:
+    struct Endpoint
+    {
+        QString host;
+        quint16 port;
+    };
+
+private:
+    struct Probe
+    {
+        Endpoint endpoint;
+        QPointer<QTcpSocket> attempt;
+        bool ready = false;
+    };
+
+//-Class Variables-------------------------------------------------------------------------------------------------
+private:
+    // Meta
+    static inline const QString NAME = u"TAwaitReady"_s;
+
+    // Logging
+    static inline const QString LOG_EVENT_PROBING = u"Waiting up to %1 milliseconds for %2 endpoint(s) to accept connections"_s;
+    static inline const QString LOG_EVENT_ENDPOINT_READY = u"%1:%2 is ready after %3 milliseconds"_s;
+    static inline const QString LOG_EVENT_ALL_READY = u"All endpoints are ready"_s;
+    static inline const QString LOG_EVENT_PROBING_STOPPED = u"Readiness probing stopped"_s;
+
+    // Functional
+    static const uint DEFAULT_INTERVAL = 25;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    // Functional
+    QTimer mPollTimer;
+    QDeadlineTimer mDeadline;
+    QElapsedTimer mElapsed;
+    QList<Probe> mProbes;
+
+    // Data
+    QList<Endpoint> mEndpoints;
+    uint mTimeout;
+    uint mInterval;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    TAwaitReady(Core& core);
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    void probe(Probe& p);
+    void finishProbing(const TAwaitReadyError& error);
+
+public:
+    QString name() const override;
+    QStringList members() const override;
+
+    QList<Endpoint> endpoints() const;
+    uint timeout() const;
+    uint interval() const;
+
+    void setEndpoints(const QList<Endpoint>& endpoints);
+    void setTimeout(uint msecs);
+    void setInterval(uint msecs);
+
+    void perform() override;
+    void stop() override;
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------
+private slots:
+    void pollTick();
+};
+
+#endif // TAWAITREADY_H
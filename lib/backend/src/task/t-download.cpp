@@ -1,6 +1,9 @@
 // Unit Include
 #include "t-download.h"
 
+// Qt Includes
+#include <QLocale>
+
 // Flashpoint Includes
 #include <fp/fp-toolkit.h>
 
@@ -16,11 +19,13 @@ TDownloadError::TDownloadError(Type t, const QString& s, const QString& d) :
     mDetails(d)
 {}
 
-TDownloadError::TDownloadError(Qx::DownloadManagerReport dmReport)
+TDownloadError::TDownloadError(const DownloaderError& downloaderError)
 {
-    mType = dmReport.wasSuccessful() ? NoError : Incomplete;
-    mSpecific = dmReport.outcomeString();
-    mDetails = dmReport.details();
+    mType = downloaderError.isValid() ? Incomplete : NoError;
+    mSpecific = Qx::Error(downloaderError).primary();
+    if(!downloaderError.specific().isEmpty())
+        mSpecific += u" ("_s + downloaderError.specific() + u")"_s;
+    mDetails = downloaderError.details();
 }
 
 //-Instance Functions-------------------------------------------------------------
@@ -43,15 +48,11 @@ QString TDownloadError::deriveDetails() const { return mDetails; }
 //-Constructor-------------------------------------------------------------
 //Public:
 TDownload::TDownload(Core& core) :
-    Task(core)
+    Task(core),
+    mDownloader(this, core.director())
 {
-    // Setup download manager
-    mDownloadManager.setOverwrite(true);
-    mDownloadManager.setDeletePartialDownloads(true);
-    mDownloadManager.setVerificationMethod(QCryptographicHash::Sha256);
-
     // Download event handlers
-    connect(&mDownloadManager, &Qx::AsyncDownloadManager::sslErrors, this, [this](Qx::Error errorMsg, bool* ignore) {
+    connect(&mDownloader, &Downloader::sslErrors, this, [this](const Qx::Error& errorMsg, bool* ignore) {
         auto choice = postDirective(DBlockingError{
             .error = errorMsg,
             .choices = DBlockingError::Choice::Yes | DBlockingError::Choice::No,
@@ -60,25 +61,14 @@ TDownload::TDownload(Core& core) :
         *ignore = choice == DBlockingError::Choice::Yes;
     });
 
-    connect(&mDownloadManager, &Qx::AsyncDownloadManager::authenticationRequired, this, [this](QString prompt) {
-        logEvent(LOG_EVENT_DOWNLOAD_AUTH.arg(prompt));
-    });
-
-    connect(&mDownloadManager, &Qx::AsyncDownloadManager::preSharedKeyAuthenticationRequired, this, [this](QString prompt) {
-        logEvent(LOG_EVENT_DOWNLOAD_AUTH.arg(prompt));
-    });
-
-    connect(&mDownloadManager, &Qx::AsyncDownloadManager::proxyAuthenticationRequired, this, [this](QString prompt) {
-        logEvent(LOG_EVENT_DOWNLOAD_AUTH.arg(prompt));
-    });
-
-    connect(&mDownloadManager, &Qx::AsyncDownloadManager::downloadTotalChanged, this, [this](qint64 total){
+    connect(&mDownloader, &Downloader::downloadTotalChanged, this, [this](qint64 total){
         postDirective<DProcedureScale>(total);
     });
-    connect(&mDownloadManager, &Qx::AsyncDownloadManager::downloadProgress, this, [this](qint64 bytes){
+    connect(&mDownloader, &Downloader::downloadProgress, this, [this](qint64 bytes){
         postDirective<DProcedureProgress>(bytes);
     });
-    connect(&mDownloadManager, &Qx::AsyncDownloadManager::finished, this, &TDownload::postDownload);
+    connect(&mDownloader, &Downloader::dataReceived, this, &TDownload::dataReceived);
+    connect(&mDownloader, &Downloader::finished, this, &TDownload::postDownload);
 }
 
 //-Instance Functions-------------------------------------------------------------
@@ -100,6 +90,9 @@ QStringList TDownload::members() const
     files += u"}"_s;
     ml.append(files);
     ml.append(u".description() = \""_s + mDescription + u"\""_s);
+    ml.append(u".maxSimultaneous() = "_s + QString::number(mDownloader.maxSimultaneous()));
+    ml.append(u".maxPerHost() = "_s + QString::number(mDownloader.maxPerHost()));
+    ml.append(u".isAdaptive() = "_s + (mDownloader.isAdaptive() ? u"true"_s : u"false"_s));
 
     return ml;
 }
@@ -108,6 +101,9 @@ bool TDownload::isEmpty() const { return mFiles.isEmpty(); }
 qsizetype TDownload::fileCount() const { return mFiles.size(); }
 QList<Qx::DownloadTask> TDownload::files() const { return mFiles; }
 QString TDownload::description() const { return mDescription; }
+int TDownload::maxSimultaneous() const { return mDownloader.maxSimultaneous(); }
+int TDownload::maxPerHost() const { return mDownloader.maxPerHost(); }
+bool TDownload::isAdaptive() const { return mDownloader.isAdaptive(); }
 
 void TDownload::addFile(const Qx::DownloadTask file) { mFiles.append(file); }
 
@@ -125,12 +121,15 @@ TDownloadError TDownload::addDatapack(const Fp::Toolkit* tk, const Fp::GameData*
 }
 
 void TDownload::setDescription(const QString& desc) { mDescription = desc; }
+void TDownload::setMaxSimultaneous(int max) { mDownloader.setMaxSimultaneous(max); }
+void TDownload::setMaxPerHost(int max) { mDownloader.setMaxPerHost(max); }
+void TDownload::setAdaptive(bool adaptive) { mDownloader.setAdaptive(adaptive); }
 
 void TDownload::perform()
 {
     // Add files
     for(const auto& f : mFiles)
-        mDownloadManager.appendTask(f);
+        mDownloader.appendTask(f);
 
     // Log/label string
     QString label = LOG_EVENT_DOWNLOAD.arg(mDescription);
@@ -138,31 +137,39 @@ void TDownload::perform()
 
     // Start download
     postDirective<DProcedureStart>(label);
-    mDownloadManager.processQueue();
+    mDownloader.processQueue();
 }
 
 void TDownload::stop()
 {
-    if(mDownloadManager.isProcessing())
+    if(mDownloader.isProcessing())
     {
         logEvent(LOG_EVENT_STOPPING_DOWNLOADS);
-        mDownloadManager.abort();
+        mDownloader.abort();
     }
 }
 
 //-Signals & Slots-------------------------------------------------------------------------------------------------------
 //Private Slots:
-void TDownload::postDownload(Qx::DownloadManagerReport downloadReport)
+void TDownload::postDownload(const DownloaderError& errorState)
 {
     Qx::Error errorStatus;
 
+    // Report throughput
+    QLocale locale;
+    logEvent(LOG_EVENT_THROUGHPUT,
+             locale.formattedDataSize(mDownloader.bytesTransferred()),
+             QString::number(mDownloader.transferDuration() / 1000.0, 'f', 1),
+             locale.formattedDataSize(qint64(mDownloader.throughput())));
+
     // Handle result
     postDirective<DProcedureStop>();
-    if(downloadReport.wasSuccessful()) 
+    if(!errorState.isValid())
         logEvent(LOG_EVENT_DOWNLOAD_SUCC);
     else
     {
-        errorStatus = TDownloadError(downloadReport);
+        logError(errorState);
+        errorStatus = TDownloadError(errorState);
         postDirective<DError>(errorStatus);
     }
 
@@ -7,6 +7,7 @@
 
 // Project Includes
 #include "task/task.h"
+#include "tools/downloader.h"
 
 // FP Forward Declarations
 namespace Fp
@@ -44,7 +45,7 @@ private:
 //-Constructor-------------------------------------------------------------
 private:
     TDownloadError(Type t = NoError, const QString& s = {}, const QString& d = {});
-    TDownloadError(Qx::DownloadManagerReport dmReport);
+    TDownloadError(const DownloaderError& downloaderError);
 
 //-Instance Functions-------------------------------------------------------------
 public:
@@ -71,8 +72,8 @@ private:
     // Logging
     static inline const QString LOG_EVENT_DOWNLOAD = u"Downloading %1"_s;
     static inline const QString LOG_EVENT_DOWNLOAD_SUCC = u"File(s) downloaded successfully"_s;
-    static inline const QString LOG_EVENT_DOWNLOAD_AUTH = u"File download unexpectedly requires authentication (%1)"_s;
-    static inline const QString LOG_EVENT_STOPPING_DOWNLOADS = u"Stopping current download(s)..."_s;
+    static inline const QString LOG_EVENT_THROUGHPUT = u"Transferred %1 in %2 s (%3/s)"_s;
+    static inline const QString LOG_EVENT_STOPPING_DOWNLOADS = u"Stopping current download(s), progress is kept..."_s;
 
     // Members
     static inline const QString FILE_NO_CHECKSUM = u"NO SUM"_s;
@@ -82,7 +83,7 @@ private:
 //-Instance Variables------------------------------------------------------------------------------------------------
 private:
     // Functional
-    Qx::AsyncDownloadManager mDownloadManager;
+    Downloader mDownloader;
 
     // Data
     QList<Qx::DownloadTask> mFiles;
@@ -101,17 +102,27 @@ public:
     qsizetype fileCount() const;
     QList<Qx::DownloadTask> files() const;
     QString description() const;
+    int maxSimultaneous() const;
+    int maxPerHost() const;
+    bool isAdaptive() const;
 
     void addFile(const Qx::DownloadTask file);
     TDownloadError addDatapack(const Fp::Toolkit* tk, const Fp::GameData* gameData);
     void setDescription(const QString& desc);
+    void setMaxSimultaneous(int max);
+    void setMaxPerHost(int max);
+    void setAdaptive(bool adaptive);
 
     void perform() override;
     void stop() override;
 
 //-Signals & Slots-------------------------------------------------------------------------------------------------------
 private slots:
-    void postDownload(Qx::DownloadManagerReport downloadReport);
+    void postDownload(const DownloaderError& errorState);
+
+signals:
+    // Lets consumers get to work on a file before the download is complete, verification comes later
+    void dataReceived(const QString& dest, qint64 offset, const QByteArray& data);
 };
 
 #endif // TDOWNLOAD_H
@@ -1,12 +1,53 @@
 // Unit Include
 #include "t-extract.h"
 
+// Standard Library Includes
+#include <atomic>
+#include <functional>
+
+// Qt Includes
+#include <QScopeGuard>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QUuid>
+
 // QuaZip Includes
 #include <quazip/quazip.h>
-#include <quazip/quazipdir.h>
-#include <quazip/quazipfile.h>
 
-// TODO: Should probably be treated as a long task and support stopping
+// Project Includes
+#include "kernel/tracer.h"
+#include "task/t-download.h"
+#include "tools/zipstreamextractor.h"
+
+// System Includes
+#ifdef __linux__
+    #include <cerrno>
+    #include <fcntl.h>
+#endif
+
+namespace // Unit helper functions
+{
+
+bool preallocate(QFile& file, qint64 size)
+{
+    // Reserving the whole extent up front avoids fragmentation, and failing here is cheaper than part way through
+    if(size <= 0)
+        return true;
+
+#ifdef __linux__
+    /* Not posix_fallocate(), which falls back to writing out every block where the filesystem can't reserve
+     * space, doubling the writes. Going without is fine.
+     */
+    if(fallocate(file.handle(), 0, 0, size) == 0)
+        return true;
+    return errno == EOPNOTSUPP || errno == ENOSYS;
+#else
+    return file.resize(size);
+#endif
+}
+
+}
 
 //===============================================================================================================
 // TExtractError
@@ -38,33 +79,78 @@ QString TExtractError::derivePrimary() const { return ERR_STRINGS.value(mType);
 QString TExtractError::deriveSecondary() const { return mArchName; }
 QString TExtractError::deriveDetails() const { return mSpecific; }
 
+//===============================================================================================================
+// TExtract::Extractor
+//===============================================================================================================
+
+/* Extracts using a pool of workers. The central directory is walked once up front to produce the list of
+ * entries to extract and to create every directory, after which the workers pull entries from the shared
+ * list, each using its own handle to the archive.
+ */
 class TExtract::Extractor
 {
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+private:
+    struct Entry
+    {
+        QString diskPath; // Relative to the destination
+        unz64_file_pos position;
+        qint64 size;
+    };
+
 //-Class Variables-------------------------------------------------------------------------------------------------
 private:
     static inline const QString ERR_CODE_TEMPLATE = u"Code: 0x%1"_s;
+    static inline const QString TRACE_CATEGORY = u"extract"_s;
+    static const qsizetype COPY_BUFFER_SIZE = 256 * 1024; // Per worker
 
 //-Instance Variables------------------------------------------------------------------------------------------------
 private:
     // Data
-    QuaZip mZip;
-    QuaZipFile mCurrentZipFile;
-    QuaZipDir mCurrentZipDir; // NOTE: empty string for root, only supports directories currently.
-    QFile mCurrentDiskFile;
-    QDir mCurrentDiskDir;
+    QString mZipPath;
+    QString mZipDirPath; // NOTE: empty string for root, otherwise has a trailing slash
+    QDir mDestinationDir;
+    QList<Entry> mEntries;
+
+    // Work
+    QThreadPool mPool;
+    int mWorkerCount;
+    std::atomic<qsizetype> mNextEntry;
+    std::atomic<int> mActiveWorkers;
+    std::atomic<qint64> mTotalSize;
+    std::atomic<qint64> mBytesWritten;
+    std::atomic_bool mStopRequested;
+    std::function<void(const TExtractError&)> mFinished;
+
+    // Status
+    QMutex mErrorMutex;
+    TExtractError mError;
+
+    // Diagnostics
+    Tracer* mTracer;
 
 //-Constructor----------------------------------------------------------------------------------------------------------
 public:
-    Extractor(const QString& zipPath, const QString& zipDirPath, const QDir& destinationDir) :
-        mZip(zipPath),
-        mCurrentZipFile(&mZip),
-        mCurrentZipDir(&mZip, sanitizeZipDirPath(zipDirPath)),
-        mCurrentDiskDir(destinationDir)
+    Extractor(const QString& zipPath, const QString& zipDirPath, const QDir& destinationDir, Tracer* tracer) :
+        mZipPath(zipPath),
+        mZipDirPath(sanitizeZipDirPath(zipDirPath)),
+        mDestinationDir(destinationDir),
+        mWorkerCount(0),
+        mNextEntry(0),
+        mActiveWorkers(0),
+        mTotalSize(-1),
+        mBytesWritten(0),
+        mStopRequested(false),
+        mTracer(tracer)
     {}
 
 //-Destructor----------------------------------------------------------------------------------------------------------
 public:
-    ~Extractor() { mZip.close(); }
+    ~Extractor()
+    {
+        mStopRequested = true;
+        mPool.waitForDone();
+    }
 
 //-Class Functions---------------------------------------------------------------------------------------------------------------
 private:
@@ -76,109 +162,222 @@ private:
         QString clean = zdp;
         if(clean.front() == '/')
             clean = clean.sliced(1);
-        if(clean.back() == '/')
-            clean.chop(1);
+        if(clean.back() != '/')
+            clean.append('/');
 
         return clean;
     }
 
+    static QString zipErrorString(int code) { return ERR_CODE_TEMPLATE.arg(code, 2, 16, QChar('0')); }
+
 //-Instance Functions------------------------------------------------------------------------------------------------------
 private:
-    QString zipErrorString() const { return ERR_CODE_TEMPLATE.arg(mZip.getZipError(), 2, 16, QChar('0')); }
-    TExtractError makeError(TExtractError::Type t, const QString& s = {}) const { return TExtractError(mZip.getZipName(), t, s); }
-    TExtractError makeZipError(TExtractError::Type t) const { return TExtractError(mZip.getZipName(), t, zipErrorString()); }
+    TExtractError makeError(TExtractError::Type t, const QString& s = {}) const { return TExtractError(mZipPath, t, s); }
 
-    bool diskCdDown(const QString& subFolder)
+    void recordError(const TExtractError& error)
     {
-        if(!mCurrentDiskDir.exists(subFolder) && !mCurrentDiskDir.mkdir(subFolder))
-            return false;
-
-        return mCurrentDiskDir.cd(subFolder);
+        // Only the first error is reported, it also winds down the other workers
+        QMutexLocker lock(&mErrorMutex);
+        if(!mError.isValid())
+            mError = error;
+        mStopRequested = true;
     }
 
-    TExtractError processDir(const QString& name = {})
+    TExtractError plan()
     {
-        // Move to dir, unless processing root
-        if(!name.isEmpty())
+        QuaZip zip(mZipPath);
+        if(!zip.open(QuaZip::mdUnzip))
+            return makeError(TExtractError::OpenArchive, zipErrorString(zip.getZipError()));
+
+        // Gather entries and the directories they need
+        unzFile uf = zip.getUnzFile();
+        QSet<QString> directories;
+        bool subPathFound = mZipDirPath.isEmpty();
+        qint64 totalSize = 0;
+
+        QByteArray rawName;
+        int code = unzGoToFirstFile(uf);
+        for(; code == UNZ_OK; code = unzGoToNextFile(uf))
         {
-            if(!mCurrentZipDir.cd(name))
-                return makeError(TExtractError::PathError);
-            if(!diskCdDown(name))
-                return makeError(TExtractError::MakePath);
+            unz_file_info64 info;
+            if((code = unzGetCurrentFileInfo64(uf, &info, nullptr, 0, nullptr, 0, nullptr, 0)) != UNZ_OK)
+                break;
+            rawName.resize(info.size_filename);
+            if((code = unzGetCurrentFileInfo64(uf, nullptr, rawName.data(), rawName.size(), nullptr, 0, nullptr, 0)) != UNZ_OK)
+                break;
+
+            QString name = QString::fromUtf8(rawName);
+            if(!name.startsWith(mZipDirPath))
+                continue;
+            subPathFound = true;
+
+            QString relPath = name.sliced(mZipDirPath.size());
+            if(relPath.isEmpty())
+                continue;
+
+            // Never write outside of the destination
+            bool isDir = relPath.endsWith('/');
+            relPath = QDir::cleanPath(relPath);
+            if(QDir::isAbsolutePath(relPath) || relPath == u".."_s || relPath.startsWith(u"../"_s))
+                return makeError(TExtractError::PathError, name);
+
+            if(isDir)
+            {
+                directories.insert(relPath);
+                continue;
+            }
+
+            if(qsizetype slash = relPath.lastIndexOf('/'); slash != -1)
+                directories.insert(relPath.left(slash));
+
+            unz64_file_pos pos;
+            if((code = unzGetFilePos64(uf, &pos)) != UNZ_OK)
+                break;
+
+            mEntries.append({.diskPath = relPath, .position = pos, .size = qint64(info.uncompressed_size)});
+            totalSize += info.uncompressed_size;
         }
 
-        // Process files
-        const QStringList files = mCurrentZipDir.entryList(QDir::Files);
-        for(const QString& f : files)
-            processFile(f);
+        if(code != UNZ_END_OF_LIST_OF_FILE)
+            return makeError(TExtractError::GeneralZip, zipErrorString(code));
 
-        // Process sub-folders
-        const QStringList subFolders = mCurrentZipDir.entryList(QDir::Dirs);
-        for(const QString& sf : subFolders)
-            processDir(sf);
+        if(!subPathFound)
+            return makeError(TExtractError::InvalidSubPath);
 
-        // Return to parent dir, unless root
-        if(!name.isEmpty())
-        {
-            if(!mCurrentZipDir.cdUp() || !mCurrentDiskDir.cdUp())
-                return makeError(TExtractError::PathError);
-        }
+        // Create all directories ahead of any file writes, shortest first so that parents come before children
+        if(!mDestinationDir.mkpath(u"."_s))
+            return makeError(TExtractError::MakePath, mDestinationDir.absolutePath());
+
+        QStringList sortedDirs(directories.cbegin(), directories.cend());
+        std::sort(sortedDirs.begin(), sortedDirs.end());
+        for(const QString& d : std::as_const(sortedDirs))
+            if(!mDestinationDir.mkpath(d))
+                return makeError(TExtractError::MakePath, d);
+
+        // Largest first so that a big file doesn't end up being the last thing a single worker is left with
+        std::sort(mEntries.begin(), mEntries.end(), [](const Entry& a, const Entry& b){ return a.size > b.size; });
+        mTotalSize = totalSize;
 
         return TExtractError();
     }
 
-    TExtractError processFile(const QString name)
+    TExtractError extractEntry(QuaZip& zip, const Entry& entry, QByteArray& buffer)
     {
-        // Change to archive file
-        if(!mZip.setCurrentFile(mCurrentZipDir.filePath(name)))
-            return makeError(TExtractError::PathError);
-
-        // Open archive file and read data
-        if(!mCurrentZipFile.open(QIODevice::ReadOnly))
-            return makeZipError(TExtractError::OpenArchiveFile);
+        Tracer::Span span = mTracer->span(entry.diskPath, TRACE_CATEGORY);
+
+        // Seek directly to the entry
+        unzFile uf = zip.getUnzFile();
+        unz64_file_pos pos = entry.position;
+        if(unzGoToFilePos64(uf, &pos) != UNZ_OK)
+            return makeError(TExtractError::PathError, entry.diskPath);
+        if(int code = unzOpenCurrentFile(uf); code != UNZ_OK)
+            return makeError(TExtractError::OpenArchiveFile, zipErrorString(code));
+
+        /* Open and reserve the disk file. A file that isn't completely written (error, CRC mismatch, or stop)
+         * is removed so that nothing truncated is left behind, while files that were finished are kept.
+         */
+        QFile diskFile(mDestinationDir.absoluteFilePath(entry.diskPath));
+        bool complete = false;
+        auto cleanup = qScopeGuard([&]{
+            unzCloseCurrentFile(uf); // No-op if already closed
+            if(!complete && diskFile.exists())
+                diskFile.remove();
+        });
+
+        if(!diskFile.open(QIODevice::WriteOnly))
+            return makeError(TExtractError::OpenDiskFile, diskFile.errorString());
+        if(!preallocate(diskFile, entry.size))
+            return makeError(TExtractError::WriteDiskFile, diskFile.fileName());
+
+        // Copy through the reusable buffer so that memory use is flat regardless of entry size
+        qint64 written = 0;
+        for(;;)
+        {
+            if(mStopRequested)
+                return makeError(TExtractError::Aborted);
 
-        QByteArray fileData = mCurrentZipFile.readAll();
-        mCurrentZipFile.close();
+            int read = unzReadCurrentFile(uf, buffer.data(), buffer.size());
+            if(read < 0)
+                return makeError(TExtractError::GeneralZip, zipErrorString(read));
+            if(read == 0)
+                break;
 
-        // Change to disk file
-        mCurrentDiskFile.setFileName(mCurrentDiskDir.absoluteFilePath(name));
+            if(diskFile.write(buffer.constData(), read) != read)
+                return makeError(TExtractError::WriteDiskFile, diskFile.fileName());
 
-        // Open disk file and write data
-        if(!mCurrentDiskFile.open(QIODevice::WriteOnly))
-            return makeError(TExtractError::OpenDiskFile, mCurrentDiskFile.errorString());
+            written += read;
+            mBytesWritten += read;
+        }
 
-        if(mCurrentDiskFile.write(fileData) != fileData.size())
-            return makeError(TExtractError::WriteDiskFile, mCurrentDiskFile.fileName());
+        // Closing verifies the CRC
+        if(int code = unzCloseCurrentFile(uf); code != UNZ_OK || written != entry.size)
+            return makeError(TExtractError::GeneralZip, zipErrorString(code));
 
-        mCurrentDiskFile.close();
+        diskFile.close();
+        if(diskFile.error() != QFileDevice::NoError)
+            return makeError(TExtractError::WriteDiskFile, diskFile.fileName());
 
+        complete = true;
         return TExtractError();
     }
 
-public:
-    TExtractError extract()
+    void work()
     {
-        // Open archive
-        if(!mZip.open(QuaZip::mdUnzip))
-            return makeZipError(TExtractError::OpenArchive);
+        QuaZip zip(mZipPath);
+        if(!zip.open(QuaZip::mdUnzip))
+            recordError(makeError(TExtractError::OpenArchive, zipErrorString(zip.getZipError())));
+        else
+        {
+            QByteArray buffer(COPY_BUFFER_SIZE, Qt::Uninitialized);
+            for(qsizetype i = mNextEntry++; i < mEntries.size() && !mStopRequested; i = mNextEntry++)
+                if(TExtractError err = extractEntry(zip, mEntries.at(i), buffer); err.isValid())
+                    recordError(err);
 
-        // Ensure zip sub-folder is valid
-        if(!mCurrentZipDir.exists())
-            return makeError(TExtractError::InvalidSubPath);
+            zip.close();
+        }
+
+        // Last one out reports
+        if(--mActiveWorkers == 0)
+        {
+            QMutexLocker lock(&mErrorMutex);
+            TExtractError err = mError;
+            if(!err.isValid() && mStopRequested)
+                err = makeError(TExtractError::Aborted);
+            lock.unlock();
 
-        // Ensure root destination folder is present
-        if(!mCurrentDiskDir.mkpath(u"."_s))
-            return makeError(TExtractError::MakePath);
+            mFinished(err);
+        }
+    }
 
-        // Recurse
-        TExtractError err = processDir();
+    void run()
+    {
+        if(TExtractError err = plan(); err.isValid() || mEntries.isEmpty() || mStopRequested)
+        {
+            mFinished(!err.isValid() && mStopRequested ? makeError(TExtractError::Aborted) : err);
+            return;
+        }
 
-         // Check for general zip error
-        if(!err.isValid() && mZip.getZipError() != UNZ_OK)
-            err = makeZipError(TExtractError::GeneralZip);
+        // Fan out, this thread is freed for use as soon as this function returns
+        mWorkerCount = std::min<qsizetype>(std::max(QThread::idealThreadCount(), 1), mEntries.size());
+        mActiveWorkers = mWorkerCount;
+        mPool.setMaxThreadCount(mWorkerCount);
+        for(int i = 0; i < mWorkerCount; i++)
+            mPool.start([this]{ work(); });
+    }
 
-        return err;
+public:
+    void start(std::function<void(const TExtractError&)> finished)
+    {
+        mFinished = std::move(finished);
+        mPool.start([this]{ run(); });
     }
+
+    void stop() { mStopRequested = true; }
+
+    qsizetype fileCount() const { return mEntries.size(); }
+    int workerCount() const { return mWorkerCount; }
+    qint64 totalSize() const { return mTotalSize; }
+    qint64 bytesWritten() const { return mBytesWritten; }
 };
 
 //===============================================================================================================
@@ -188,8 +387,15 @@ public:
 //-Constructor--------------------------------------------------------------------
 //Public:
 TExtract::TExtract(Core& core) :
-    Task(core)
-{}
+    Task(core),
+    mScaleKnown(false)
+{
+    connect(&mProgressTimer, &QTimer::timeout, this, &TExtract::progressTick);
+}
+
+//-Destructor--------------------------------------------------------------------
+//Public:
+TExtract::~TExtract() = default;
 
 //-Instance Functions-------------------------------------------------------------
 //Public:
@@ -211,17 +417,112 @@ void TExtract::setPackPath(QString path) { mPackPath = path; }
 void TExtract::setPathInPack(QString path) { mPathInPack = path; }
 void TExtract::setDestinationPath(QString path) { mDestinationPath = path; }
 
+void TExtract::setStreamSource(TDownload* download)
+{
+    connect(download, &TDownload::dataReceived, this, [this](const QString& dest, qint64 offset, const QByteArray& data){
+        if(dest != mPackPath)
+            return;
+
+        /* Stage next to the destination so that committing is just a rename, but outside of it since the
+         * destination may be served while the download is underway
+         */
+        if(!mStream)
+        {
+            QFileInfo destInfo(QDir::cleanPath(mDestinationPath));
+            QString staging = destInfo.fileName() + STAGING_FOLDER_TEMPLATE.arg(QUuid::createUuid().toString(QUuid::Id128));
+            mStream = std::make_unique<ZipStreamExtractor>(QDir(destInfo.absolutePath()).absoluteFilePath(staging), mPathInPack);
+        }
+
+        mStream->feed(offset, data);
+    });
+}
+
 void TExtract::perform()
 {
-    // Log string
+    // Log/label string
     QFileInfo packFileInfo(mPackPath);
-    logEvent(LOG_EVENT_EXTRACTING_ARCHIVE.arg(packFileInfo.fileName()));
+    QString label = LOG_EVENT_EXTRACTING_ARCHIVE.arg(packFileInfo.fileName());
+    logEvent(label);
+
+    // Use what was extracted during the download if possible, the pack has been verified by now
+    if(mStream)
+    {
+        QElapsedTimer commitTimer;
+        commitTimer.start();
+
+        QString reason;
+        if(mStream->state() != ZipStreamExtractor::State::Finished)
+            reason = mStream->state() == ZipStreamExtractor::State::Abandoned ? mStream->abandonReason() : u"incomplete"_s;
+        else if(mStream->commit(mDestinationPath, &reason))
+        {
+            logEvent(LOG_EVENT_STREAM_COMMITTED.arg(mStream->fileCount()).arg(mStream->bytesWritten()).arg(commitTimer.elapsed()));
+            mStream.reset();
+            complete(TExtractError());
+            return;
+        }
+
+        logEvent(LOG_EVENT_STREAM_ABANDONED.arg(reason));
+        mStream.reset(); // Discards anything staged
+    }
+
+    // Busy until the total size is known
+    postDirective<DProcedureStart>(label);
+    postDirective<DProcedureProgress>(0);
+    postDirective<DProcedureScale>(0);
+    mScaleKnown = false;
 
     // Extract pack
-    Extractor extractor(mPackPath, mPathInPack, mDestinationPath);
-    TExtractError ee = extractor.extract();
-    if(ee.isValid())
-        postDirective<DError>(ee);
+    mElapsed.start();
+    mExtractor = std::make_unique<Extractor>(mPackPath, mPathInPack, mDestinationPath, tracer());
+    mProgressTimer.start(PROGRESS_INTERVAL);
+    mExtractor->start([this](const TExtractError& err){
+        QMetaObject::invokeMethod(this, [this, err]{ postExtract(err); }, Qt::QueuedConnection);
+    });
+}
+
+void TExtract::stop()
+{
+    if(mExtractor)
+    {
+        logEvent(LOG_EVENT_STOPPING_EXTRACTION);
+        mExtractor->stop();
+    }
+}
+
+//-Signals & Slots-------------------------------------------------------------------------------------------------------
+//Private Slots:
+void TExtract::progressTick()
+{
+    if(!mScaleKnown)
+    {
+        qint64 total = mExtractor->totalSize();
+        if(total < 0)
+            return;
+
+        postDirective<DProcedureScale>(total);
+        mScaleKnown = true;
+    }
+
+    postDirective<DProcedureProgress>(mExtractor->bytesWritten());
+}
+
+void TExtract::postExtract(const TExtractError& errorStatus)
+{
+    mProgressTimer.stop();
+    progressTick();
+
+    if(!errorStatus.isValid())
+    {
+        logEvent(LOG_EVENT_EXTRACTION_STATS.arg(mExtractor->fileCount())
+                                           .arg(mExtractor->bytesWritten())
+                                           .arg(mExtractor->workerCount())
+                                           .arg(mElapsed.elapsed()));
+    }
+    mExtractor.reset(); // Joins the pool
+
+    postDirective<DProcedureStop>();
+    if(errorStatus.isValid())
+        postDirective<DError>(errorStatus);
 
-    complete(ee);
+    complete(errorStatus);
 }
@@ -1,8 +1,13 @@
 #ifndef TEXTRACT_H
 #define TEXTRACT_H
 
+// Standard Library Includes
+#include <memory>
+
 // Qt Includes
 #include <QDir>
+#include <QTimer>
+#include <QElapsedTimer>
 
 // Qx Includes
 #include <qx/utility/qx-macros.h>
@@ -10,7 +15,8 @@
 // Project Includes
 #include "task/task.h"
 
-class Extractor;
+class TDownload;
+class ZipStreamExtractor;
 
 class QX_ERROR_TYPE(TExtractError, "TExtractError", 1255)
 {
@@ -27,7 +33,8 @@ public:
         OpenArchiveFile,
         OpenDiskFile,
         WriteDiskFile,
-        GeneralZip
+        GeneralZip,
+        Aborted
     };
 
 //-Class Variables-------------------------------------------------------------
@@ -41,7 +48,8 @@ private:
         {OpenArchiveFile, u"Failed to open archive file."_s},
         {OpenDiskFile, u"Failed to open disk file."_s},
         {WriteDiskFile, u"Failed to write disk file."_s},
-        {GeneralZip, u"General zip error."_s}
+        {GeneralZip, u"General zip error."_s},
+        {Aborted, u"Extraction was aborted."_s}
     };
 
 //-Instance Variables-------------------------------------------------------------
@@ -70,6 +78,12 @@ private:
     QString deriveDetails() const override;
 };
 
+/* Extracts all or part of a zip archive to disk using a pool of workers.
+ *
+ * If the archive is still to be downloaded, the task can instead be fed by that download via setStreamSource(),
+ * in which case entries are extracted to a staging folder beside the destination while the data arrives and simply moved into place
+ * once the download has been verified, falling back to regular extraction if streaming wasn't possible.
+ */
 class TExtract : public Task
 {
     class Extractor;
@@ -82,6 +96,16 @@ private:
 
     // Logging
     static inline const QString LOG_EVENT_EXTRACTING_ARCHIVE = u"Extracting archive %1"_s;
+    static inline const QString LOG_EVENT_EXTRACTION_STATS = u"Extracted %1 file(s) (%2 bytes) with %3 worker(s) in %4 ms"_s;
+    static inline const QString LOG_EVENT_STOPPING_EXTRACTION = u"Stopping extraction..."_s;
+    static inline const QString LOG_EVENT_STREAM_COMMITTED = u"Extracted %1 file(s) (%2 bytes) during download, moved into place in %3 ms"_s;
+    static inline const QString LOG_EVENT_STREAM_ABANDONED = u"Could not extract during download (%1), extracting normally"_s;
+
+    // Streaming
+    static inline const QString STAGING_FOLDER_TEMPLATE = u".clifp-staging-%1"_s;
+
+    // Progress
+    static const int PROGRESS_INTERVAL = 100; // ms
 
 //-Instance Variables------------------------------------------------------------------------------------------------
 private:
@@ -90,10 +114,21 @@ private:
     QString mPathInPack; // NOTE: empty string for root, only supports directories currently.
     QString mDestinationPath;
 
+    // Functional
+    std::unique_ptr<Extractor> mExtractor;
+    std::unique_ptr<ZipStreamExtractor> mStream;
+    QTimer mProgressTimer;
+    QElapsedTimer mElapsed;
+    bool mScaleKnown;
+
 //-Constructor----------------------------------------------------------------------------------------------------------
 public:
     TExtract(Core& core);
 
+//-Destructor----------------------------------------------------------------------------------------------------------
+public:
+    ~TExtract();
+
 //-Instance Functions------------------------------------------------------------------------------------------------------
 public:
     QString name() const override;
@@ -106,8 +141,15 @@ public:
     void setPackPath(QString path);
     void setPathInPack(QString path);
     void setDestinationPath(QString path);
+    void setStreamSource(TDownload* download);
 
     void perform() override;
+    void stop() override;
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+private slots:
+    void progressTick();
+    void postExtract(const TExtractError& errorStatus);
 };
 
 #endif // TEXTRACT_H
@@ -12,6 +12,31 @@
 #include "kernel/core.h"
 #include "utility.h"
 
+//===============================================================================================================
+// TMountError
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Private:
+TMountError::TMountError(Type t, const QString& s, const QString& d) :
+    mType(t),
+    mSpecific(s),
+    mDetails(d)
+{}
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+bool TMountError::isValid() const { return mType != NoError; }
+QString TMountError::specific() const { return mSpecific; }
+TMountError::Type TMountError::type() const { return mType; }
+
+//Private:
+Qx::Severity TMountError::deriveSeverity() const { return Qx::Critical; }
+quint32 TMountError::deriveValue() const { return mType; }
+QString TMountError::derivePrimary() const { return ERR_STRINGS.value(mType); }
+QString TMountError::deriveSecondary() const { return mSpecific; }
+QString TMountError::deriveDetails() const { return mDetails; }
+
 //===============================================================================================================
 // TMount
 //===============================================================================================================
@@ -20,10 +45,11 @@
 //Public:
 TMount::TMount(Core& core) :
     Task(core),
+    mCore(core),
     mDirector(core.director()),
-    mMounterProxy(nullptr),
-    mMounterQmp(nullptr),
-    mMounterRouter(nullptr),
+    mHttpClient(core.localHttpClient()),
+    mOutstanding(0),
+    mNextMount(0),
     mMounting(false),
     mDaemon(Fp::FpProxy)
 {}
@@ -32,57 +58,32 @@ TMount::TMount(Core& core) :
 //Private:
 template<typename M>
     requires Qx::any_of<M, MounterGameServer, MounterQmp, MounterRouter>
-void TMount::initMounter(M*& mounter)
+void TMount::initMounter(M*& mounter, qsizetype packIndex)
 {
-    mounter = new M(this, mDirector);
-    connect(mounter, &M::mountFinished, this, &TMount::mounterFinishHandler);
-}
+    if constexpr(std::same_as<M, MounterQmp>)
+        mounter = new M(this, mDirector);
+    else
+        mounter = new M(this, mDirector, mHttpClient); // HTTP based
 
-//Public:
-QString TMount::name() const { return NAME; }
-QStringList TMount::members() const
-{
-    QStringList ml = Task::members();
-    ml.append(u".daemon() = \""_s + ENUM_NAME(mDaemon) + u"\""_s);
-    ml.append(u".titleId() = \""_s + mTitleId.toString() + u"\""_s);
-    ml.append(u".path() = \""_s + QDir::toNativeSeparators(mPath) + u"\""_s);
-    return ml;
+    M* m = mounter;
+    connect(mounter, &M::mountFinished, this, [this, packIndex, m](const auto& err){
+        mounterFinishHandler(packIndex, m, err);
+    });
 }
 
-QUuid TMount::titleId() const { return mTitleId; }
-QString TMount::path() const { return mPath; }
-Fp::Daemon TMount::daemon() const { return mDaemon; }
-
-void TMount::setTitleId(QUuid titleId) { mTitleId = titleId; }
-void TMount::setPath(QString path) { mPath = path; }
-void TMount::setDaemon(Fp::Daemon daemon) { mDaemon = daemon; }
-
-void TMount::perform()
+void TMount::setupMounters(PackMount& mount, qsizetype packIndex)
 {
-    mMounting = true;
-
-    // Log/label string
-    QFileInfo packFileInfo(mPath);
-    QString label = LOG_EVENT_MOUNTING_DATA_PACK.arg(packFileInfo.fileName());
-
-    // Start mount
-    postDirective<DProcedureStart>(label);
-
-    // Update state
-    postDirective<DProcedureProgress>(0);
-    postDirective<DProcedureScale>(0); // Cause busy state
-
-    //-Setup Mounter(s)------------------------------------
+    const QString& path = mount.pack.path;
 
     if(mDaemon == Fp::Daemon::FpProxy || mDaemon == Fp::Daemon::FpGameServer)
     {
-        initMounter(mMounterProxy);
-        mMounterProxy->setFilePath(mPath);
-        mMounterProxy->setGameServerPort(22501);
+        initMounter(mount.proxy, packIndex);
+        mount.proxy->setFilePath(path);
+        mount.proxy->setGameServerPort(GAME_SERVER_PORT);
     }
     else
     {
-        QString routerMountValue = QFileInfo(mPath).fileName();
+        QString routerMountValue = QFileInfo(path).fileName();
 
         if(mDaemon == Fp::Daemon::Qemu)
         {
@@ -98,45 +99,180 @@ void TMount::perform()
             // Convert UUID to 20 char drive serial by encoding to Base85
             Qx::Base85Encoding encoding(Qx::Base85Encoding::Btoa);
             encoding.resetZeroGroupCharacter(); // No shortcut characters
-            QByteArray rawTitleId = mTitleId.toRfc4122(); // Binary representation of UUID
+            QByteArray rawTitleId = mount.pack.titleId.toRfc4122(); // Binary representation of UUID
             Qx::Base85 driveSerialEnc = Qx::Base85::encode(rawTitleId, &encoding);
             QString driveSerial = driveSerialEnc.toString();
 
-            initMounter(mMounterQmp);
-            mMounterQmp->setDriveId(driveId);
-            mMounterQmp->setDriveSerial(driveSerial);
-            mMounterQmp->setFilePath(mPath);
-            mMounterQmp->setQemuMountPort(22501);
-            mMounterQmp->setQemuProdPort(0); // Unused
+            initMounter(mount.qmp, packIndex);
+            mount.qmp->setDriveId(driveId);
+            mount.qmp->setDriveSerial(driveSerial);
+            mount.qmp->setFilePath(path);
+            mount.qmp->setQemuMountPort(GAME_SERVER_PORT);
+            mount.qmp->setQemuProdPort(0); // Unused
 
             routerMountValue = driveSerial;
         }
 
-        initMounter(mMounterRouter);
-        mMounterRouter->setMountValue(routerMountValue);
-        mMounterRouter->setRouterPort(22500);
+        initMounter(mount.router, packIndex);
+        mount.router->setMountValue(routerMountValue);
+        mount.router->setRouterPort(ROUTER_PORT);
     }
+}
+
+QString TMount::traceName(const PackMount& mount, const QObject* mounter) const
+{
+    return mounter == mount.qmp ? TRACE_QMP_MOUNT : mounter == mount.router ? TRACE_ROUTER_MOUNT : TRACE_GAME_SERVER_MOUNT;
+}
+
+quint64 TMount::traceId(qsizetype packIndex) const
+{
+    // Unique among the mounts of every task
+    return (quint64(number()) << 32) | quint64(packIndex);
+}
 
-    // Mount
+void TMount::startMount(qsizetype packIndex)
+{
+    PackMount& mount = mMounts[packIndex];
     switch(mDaemon)
     {
         case Fp::Daemon::FpProxy:
         case Fp::Daemon::FpGameServer:
-            mMounterProxy->mount();
+            startMounter(packIndex, mount.proxy);
             break;
 
         case Fp::Daemon::Qemu:
-            mMounterQmp->mount();
+            startMounter(packIndex, mount.qmp);
             break;
 
         case Fp::Daemon::Docker:
-            mMounterRouter->mount();
+            startMounter(packIndex, mount.router);
             break;
 
         default:
             qCritical("Mount attempted with unknown daemon!");
             break;
     }
+}
+
+void TMount::startMounter(qsizetype packIndex, QObject* mounter)
+{
+    // Each round trip is spanned until its mounter finishes
+    PackMount& mount = mMounts[packIndex];
+    tracer()->beginAsync(traceName(mount, mounter), traceId(packIndex), TRACE_CATEGORY);
+
+    if(mounter == mount.proxy)
+        mount.proxy->mount();
+    else if(mounter == mount.qmp)
+        mount.qmp->mount();
+    else
+        mount.router->mount();
+}
+
+bool TMount::usesMountCache() const
+{
+    /* Only the launcher's services outlive a run. Those CLIFp starts itself, resident sessions included, are
+     * stopped again once the run is over, so a record could never be hit and finding the server isn't worth it.
+     *
+     * The session is that of whatever listens on the mount port, which is only the process that holds the
+     * mounts when the game server handles them itself. With QEMU/Docker that's a front for the VM/container,
+     * which can lose its mounts without the front restarting, so the cache would go stale.
+     */
+    return mCore.mode() == Core::Companion && (mDaemon == Fp::Daemon::FpProxy || mDaemon == Fp::Daemon::FpGameServer);
+}
+
+QList<TMount::Pack> TMount::filterMounted()
+{
+    // Packs stay mounted for as long as the server that mounted them is running
+    MountCache::Session session = mCore.mountSession();
+    if(!session.isValid())
+    {
+        logEvent(LOG_EVENT_CACHE_UNAVAILABLE);
+        return mPacks;
+    }
+
+    bool current = mMountCache.load(session);
+    logEvent(LOG_EVENT_CACHE_SESSION.arg(session.pid).arg(current ? u"existing"_s : u"new"_s));
+
+    QList<Pack> needed;
+    for(const Pack& p : std::as_const(mPacks))
+    {
+        QString filename = QFileInfo(p.path).fileName();
+        if(mMountCache.contains(p.path))
+            logEvent(LOG_EVENT_CACHE_HIT.arg(filename));
+        else
+        {
+            logEvent(LOG_EVENT_CACHE_MISS.arg(filename));
+            needed.append(p);
+        }
+    }
+
+    return needed;
+}
+
+//Public:
+QString TMount::name() const { return NAME; }
+QStringList TMount::members() const
+{
+    QStringList ml = Task::members();
+    ml.append(u".daemon() = \""_s + ENUM_NAME(mDaemon) + u"\""_s);
+
+    QString packs = u".packs() = {\n"_s;
+    for(const Pack& p : mPacks)
+        packs += u"\t{.titleId = \""_s + p.titleId.toString() + u"\", .path = \""_s + QDir::toNativeSeparators(p.path) + u"\"}\n"_s;
+    packs += u"}"_s;
+    ml.append(packs);
+
+    return ml;
+}
+
+QList<TMount::Pack> TMount::packs() const { return mPacks; }
+Fp::Daemon TMount::daemon() const { return mDaemon; }
+
+void TMount::addPack(QUuid titleId, QString path) { mPacks.append({.titleId = titleId, .path = path}); }
+void TMount::setDaemon(Fp::Daemon daemon) { mDaemon = daemon; }
+
+void TMount::perform()
+{
+    Q_ASSERT(!mPacks.isEmpty());
+
+    // Skip what's already mounted
+    const QList<Pack> needed = usesMountCache() ? filterMounted() : mPacks;
+    if(needed.isEmpty())
+    {
+        logEvent(LOG_EVENT_CACHE_ALL_HIT);
+        complete(TMountError());
+        return;
+    }
+
+    mMounting = true;
+
+    // Log/label string
+    QString label = needed.size() == 1 ? LOG_EVENT_MOUNTING_DATA_PACK.arg(QFileInfo(needed.first().path).fileName()) :
+                                         LOG_EVENT_MOUNTING_DATA_PACKS.arg(needed.size());
+
+    // Start mount
+    postDirective<DProcedureStart>(label);
+
+    // Update state
+    postDirective<DProcedureProgress>(0);
+    postDirective<DProcedureScale>(0); // Cause busy state
+
+    // Setup mounters for every pack before any of them can finish
+    mMounts.clear();
+    mMounts.reserve(needed.size());
+    for(qsizetype i = 0; i < needed.size(); i++)
+    {
+        mMounts.append({.pack = needed.at(i)});
+        setupMounters(mMounts.last(), i);
+    }
+    mOutstanding = mMounts.size();
+
+    /* Mount all at once, the shared client pipelines the HTTP requests. QMP has a single client, so with
+     * QEMU the next pack is started once the previous one is through that step (see mounterFinishHandler()).
+     */
+    qsizetype initial = mDaemon == Fp::Daemon::Qemu ? 1 : mMounts.size();
+    for(mNextMount = 0; mNextMount < initial;)
+        startMount(mNextMount++);
 
     // Await finished signal(s)...
 }
@@ -147,35 +283,84 @@ void TMount::stop()
     {
         logEvent(LOG_EVENT_STOPPING_MOUNT);
 
+        // Packs still waiting their turn won't get one
+        for(; mNextMount < mMounts.size(); mNextMount++)
+        {
+            mMounts[mNextMount].error = TMountError(TMountError::Stopped);
+            mOutstanding--;
+        }
+
         // TODO: This could benefit from the mounters using a shared base, or
         // some other kind of type erasure like the duck typing above.
-        if(mMounterProxy && mMounterProxy->isMounting())
-            mMounterProxy->abort();
-        if(mMounterQmp && mMounterQmp->isMounting())
-            mMounterQmp->abort();
-        if(mMounterRouter && mMounterRouter->isMounting())
-            mMounterRouter->abort();
+        for(PackMount& m : mMounts)
+        {
+            if(m.proxy && m.proxy->isMounting())
+                m.proxy->abort();
+            if(m.qmp && m.qmp->isMounting())
+                m.qmp->abort();
+            if(m.router && m.router->isMounting())
+                m.router->abort();
+        }
     }
 }
 
 //-Signals & Slots-------------------------------------------------------------------------------------------------------
 //Private Slots:
-void TMount::mounterFinishHandler(Qx::Error err)
+void TMount::mounterFinishHandler(qsizetype packIndex, QObject* mounter, Qx::Error err)
 {
-    if(sender() == mMounterQmp && !err.isValid())
-        mMounterRouter->mount();
-    else
-        postMount(err);
+    PackMount& mount = mMounts[packIndex];
+    tracer()->endAsync(traceName(mount, mounter), traceId(packIndex), TRACE_CATEGORY);
+
+    if(mounter == mount.qmp)
+    {
+        // QMP is free for the next pack, the router step doesn't involve it
+        if(mNextMount < mMounts.size())
+            startMount(mNextMount++);
+
+        // QEMU mounts are completed by the router
+        if(!err.isValid())
+        {
+            startMounter(packIndex, mount.router);
+            return;
+        }
+    }
+
+    mount.error = err;
+    if(err.isValid())
+        logEvent(LOG_EVENT_PACK_FAILED.arg(QFileInfo(mount.pack.path).fileName()));
+
+    if(--mOutstanding == 0)
+        postMount();
 }
 
-void TMount::postMount(Qx::Error errorStatus)
+void TMount::postMount()
 {
     mMounting = false;
 
-    // Reset mounter pointers ('this' will delete them due to parenting so there's no leak)
-    mMounterProxy = nullptr;
-    mMounterQmp = nullptr;
-    mMounterRouter = nullptr;
+    // Aggregate failures, a lone pack's error is passed through as is
+    Qx::Error errorStatus;
+    QStringList failures;
+    for(const PackMount& m : std::as_const(mMounts))
+    {
+        if(!m.error.isValid())
+        {
+            mMountCache.insert(m.pack.path);
+            continue;
+        }
+
+        failures.append(ERR_PACK_LINE.arg(QFileInfo(m.pack.path).fileName(), m.error.primary() + u" "_s + m.error.secondary()));
+    }
+
+    if(QString cacheError; !mMountCache.save(&cacheError))
+        logEvent(LOG_EVENT_CACHE_SAVE_FAILED.arg(cacheError));
+
+    if(mMounts.size() == 1)
+        errorStatus = mMounts.first().error;
+    else if(!failures.isEmpty())
+        errorStatus = TMountError(TMountError::PacksFailed, ERR_PACKS_FAILED.arg(failures.size()).arg(mMounts.size()), failures.join('\n'));
+
+    // Mounters are deleted along with 'this' due to parenting, so there's no leak
+    mMounts.clear();
 
     // Handle result
     postDirective<DProcedureStop>();
@@ -12,10 +12,60 @@
 
 // Project Includes
 #include "task/task.h"
+#include "tools/mountcache.h"
 #include "tools/mounter_game_server.h"
 #include "tools/mounter_qmp.h"
 #include "tools/mounter_router.h"
 
+class QX_ERROR_TYPE(TMountError, "TMountError", 1258)
+{
+    friend class TMount;
+//-Class Enums-------------------------------------------------------------
+public:
+    enum Type
+    {
+        NoError,
+        PacksFailed,
+        Stopped
+    };
+
+//-Class Variables-------------------------------------------------------------
+private:
+    static inline const QHash<Type, QString> ERR_STRINGS{
+        {NoError, u""_s},
+        {PacksFailed, u"One or more data packs could not be mounted."_s},
+        {Stopped, u"Mounting was stopped before this data pack's turn."_s}
+    };
+
+//-Instance Variables-------------------------------------------------------------
+private:
+    Type mType;
+    QString mSpecific;
+    QString mDetails;
+
+//-Constructor-------------------------------------------------------------
+private:
+    TMountError(Type t = NoError, const QString& s = {}, const QString& d = {});
+
+//-Instance Functions-------------------------------------------------------------
+public:
+    bool isValid() const;
+    Type type() const;
+    QString specific() const;
+
+private:
+    Qx::Severity deriveSeverity() const override;
+    quint32 deriveValue() const override;
+    QString derivePrimary() const override;
+    QString deriveSecondary() const override;
+    QString deriveDetails() const override;
+};
+
+/* Mounts one or more data packs. Each pack gets its own set of mounters and all of them are mounted
+ * concurrently (none of the daemons accept more than one pack per request), with the task finishing once
+ * every pack has been handled. The exception is QEMU's QMP step, which is taken one pack at a time since
+ * its chardev only serves one client. Failures are collected per pack and reported together.
+ */
 class TMount : public Task
 {
     Q_OBJECT;
@@ -24,28 +74,74 @@ private:
     // Meta
     static inline const QString NAME = u"TMount"_s;
 
+public:
+    // Service ports
+    static const quint16 GAME_SERVER_PORT = 22501;
+    static const quint16 ROUTER_PORT = 22500;
+
+private:
     // Logging
     static inline const QString LOG_EVENT_MOUNTING_DATA_PACK = u"Mounting Data Pack %1"_s;
+    static inline const QString LOG_EVENT_MOUNTING_DATA_PACKS = u"Mounting %1 Data Packs"_s;
+    static inline const QString LOG_EVENT_PACK_FAILED = u"Failed to mount %1"_s;
     static inline const QString LOG_EVENT_MOUNT_INFO_DETERMINED = u"Mount Info: {.filePath = \"%1\", .driveId = \"%2\", .driveSerial = \"%3\"}"_s;
     static inline const QString LOG_EVENT_STOPPING_MOUNT = u"Stopping current mount(s)..."_s;
+    static inline const QString LOG_EVENT_CACHE_SESSION = u"Mount cache session: server PID %1 (%2 record)"_s;
+    static inline const QString LOG_EVENT_CACHE_UNAVAILABLE = u"Could not identify the server session, mount cache not used"_s;
+    static inline const QString LOG_EVENT_CACHE_HIT = u"Mount cache hit: %1 is already mounted"_s;
+    static inline const QString LOG_EVENT_CACHE_MISS = u"Mount cache miss: %1"_s;
+    static inline const QString LOG_EVENT_CACHE_ALL_HIT = u"All data packs are already mounted, skipping mount"_s;
+    static inline const QString LOG_EVENT_CACHE_SAVE_FAILED = u"Could not save mount cache: %1"_s;
+
+    // Tracing
+    static inline const QString TRACE_CATEGORY = u"mount"_s;
+    static inline const QString TRACE_GAME_SERVER_MOUNT = u"Game server mount"_s;
+    static inline const QString TRACE_QMP_MOUNT = u"QMP mount"_s;
+    static inline const QString TRACE_ROUTER_MOUNT = u"Router mount"_s;
+
+    // Errors
+    static inline const QString ERR_PACKS_FAILED = u"%1 of %2 failed"_s;
+    static inline const QString ERR_PACK_LINE = u"%1: %2"_s;
+
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+public:
+    struct Pack
+    {
+        QUuid titleId;
+        QString path;
+    };
+
+private:
+    struct PackMount
+    {
+        Pack pack;
+        MounterGameServer* proxy = nullptr;
+        MounterQmp* qmp = nullptr;
+        MounterRouter* router = nullptr;
+        Qx::Error error;
+    };
 
 //-Instance Variables------------------------------------------------------------------------------------------------
 private:
+    // Core
+    Core& mCore;
+
     // Director
     Director* mDirector; // TODO: Won't need to store this once the old mounter are dropped; pass to final mounters constructor
+    LocalHttpClient* mHttpClient;
 
     // Mounters
-    MounterGameServer* mMounterProxy;
-    MounterQmp* mMounterQmp;
-    MounterRouter* mMounterRouter;
+    QList<PackMount> mMounts; // One per pack that needs mounting, while mounting
+    qsizetype mOutstanding;
+    qsizetype mNextMount; // First of mMounts not yet started
 
     // Data
     bool mMounting;
+    MountCache mMountCache;
 
     // Properties
     Fp::Daemon mDaemon;
-    QUuid mTitleId;
-    QString mPath;
+    QList<Pack> mPacks;
 
 //-Constructor----------------------------------------------------------------------------------------------------------
 public:
@@ -55,18 +151,23 @@ public:
 private:
     template<typename M>
         requires Qx::any_of<M, MounterGameServer, MounterQmp, MounterRouter>
-    void initMounter(M*& mounter);
+    void initMounter(M*& mounter, qsizetype packIndex);
+    void setupMounters(PackMount& mount, qsizetype packIndex);
+    QString traceName(const PackMount& mount, const QObject* mounter) const;
+    quint64 traceId(qsizetype packIndex) const;
+    void startMount(qsizetype packIndex);
+    void startMounter(qsizetype packIndex, QObject* mounter);
+    bool usesMountCache() const;
+    QList<Pack> filterMounted();
 
 public:
     QString name() const override;
     QStringList members() const override;
 
-    QUuid titleId() const;
-    QString path() const;
+    QList<Pack> packs() const;
     Fp::Daemon daemon() const;
 
-    void setTitleId(QUuid titleId);
-    void setPath(QString path);
+    void addPack(QUuid titleId, QString path);
     void setDaemon(Fp::Daemon daemon);
 
     void perform() override;
@@ -74,8 +175,8 @@ public:
 
 //-Signals & Slots-------------------------------------------------------------------------------------------------------
 private slots:
-    void mounterFinishHandler(Qx::Error err);
-    void postMount(Qx::Error errorStatus);
+    void mounterFinishHandler(qsizetype packIndex, QObject* mounter, Qx::Error err);
+    void postMount();
 };
 
 #endif // TMOUNT_H
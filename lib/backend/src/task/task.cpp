@@ -20,18 +20,22 @@
 //Public:
 Task::Task(Core& core) :
     QObject(&core),
-    Directorate(core.director())
+    Directorate(core.director()),
+    mNumber(-1)
 {}
 
 //-Instance Functions-------------------------------------------------------------
 //Protected:
 void Task::complete(const Qx::Error& errorState) { emit completed(errorState); }
+int Task::logTaskNumber() const { return mNumber; }
 
 //Public:
 QStringList Task::members() const { return {u".stage() = "_s + ENUM_NAME(mStage)}; }
 
 Task::Stage Task::stage() const { return mStage; }
 void Task::setStage(Stage stage) { mStage = stage; }
+int Task::number() const { return mNumber; }
+void Task::setNumber(int number) { mNumber = number; }
 
 void Task::stop() { /* By default stopping isn't supported */ }
 
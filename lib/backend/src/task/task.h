@@ -23,6 +23,9 @@ public:
 protected:
     Stage mStage;
 
+private:
+    int mNumber;
+
 //-Constructor----------------------------------------------------------------------------------------------------------
 public:
     Task(Core& core);
@@ -34,12 +37,15 @@ public:
 //-Instance Functions------------------------------------------------------------------------------------------------------
 protected:
     virtual void complete(const Qx::Error& errorState = {});
+    int logTaskNumber() const override;
 
 public:
     virtual QStringList members() const;
 
     Stage stage() const;
     void setStage(Stage stage);
+    int number() const;
+    void setNumber(int number); // Assigned by the driver when the task is started
 
     virtual void perform() = 0;
     virtual void stop();
@@ -1,6 +1,10 @@
 // Unit Include
 #include "archiveaccess.h"
 
+// Qt Includes
+#include <QCryptographicHash>
+#include <QStandardPaths>
+
 // Qx Includes
 #include <qx/io/qx-common-io.h>
 
@@ -34,6 +38,94 @@ quint32 ArchiveAccessError::deriveValue() const { return mType; }
 QString ArchiveAccessError::derivePrimary() const { return ERR_STRINGS.value(mType); }
 QString ArchiveAccessError::deriveSecondary() const { return mSpecific; }
 
+//===============================================================================================================
+// ArchiveEntry
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Public:
+ArchiveEntry::ArchiveEntry(QuaZip& part, const ArchiveIndex::Entry& entry) :
+    mPart(part),
+    mEntry(entry),
+    mRemaining(0),
+    mFileOpen(false)
+{}
+
+//-Destructor-------------------------------------------------------------
+//Public:
+ArchiveEntry::~ArchiveEntry() { close(); }
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+bool ArchiveEntry::closeFile()
+{
+    if(!mFileOpen)
+        return true;
+
+    mFileOpen = false;
+    return unzCloseCurrentFile(mPart.getUnzFile()) == UNZ_OK;
+}
+
+//Protected:
+qint64 ArchiveEntry::readData(char* data, qint64 maxSize)
+{
+    if(!mFileOpen)
+        return mRemaining == 0 ? 0 : -1;
+
+    qint64 total = 0;
+    while(total < maxSize && mRemaining > 0)
+    {
+        unsigned int chunk = std::min<qint64>({maxSize - total, mRemaining, qint64(std::numeric_limits<int>::max())});
+        int read = unzReadCurrentFile(mPart.getUnzFile(), data + total, chunk);
+        if(read <= 0)
+        {
+            setErrorString(u"Failed to inflate %1 (%2)"_s.arg(mPart.getZipName()).arg(read));
+            closeFile();
+            return -1;
+        }
+
+        total += read;
+        mRemaining -= read;
+    }
+
+    // Closing checks the CRC now that the whole file has been read
+    if(mRemaining == 0 && !closeFile())
+    {
+        setErrorString(u"CRC mismatch in %1"_s.arg(mPart.getZipName()));
+        return -1;
+    }
+
+    return total;
+}
+
+qint64 ArchiveEntry::writeData(const char* data, qint64 maxSize) { Q_UNUSED(data); Q_UNUSED(maxSize); return -1; }
+
+//Public:
+bool ArchiveEntry::open(OpenMode mode)
+{
+    if(isOpen() || mode != QIODevice::ReadOnly)
+        return false;
+
+    unzFile uf = mPart.getUnzFile();
+    unz64_file_pos pos = mEntry.position;
+    if(unzGoToFilePos64(uf, &pos) != UNZ_OK || unzOpenCurrentFile(uf) != UNZ_OK)
+        return false;
+
+    mFileOpen = true;
+    mRemaining = mEntry.uncompressedSize;
+    return QIODevice::open(mode);
+}
+
+void ArchiveEntry::close()
+{
+    closeFile();
+    QIODevice::close();
+}
+
+bool ArchiveEntry::isSequential() const { return true; }
+qint64 ArchiveEntry::size() const { return mEntry.uncompressedSize; }
+qint64 ArchiveEntry::bytesAvailable() const { return mRemaining + QIODevice::bytesAvailable(); }
+
 //===============================================================================================================
 // ArchiveAccess
 //===============================================================================================================
@@ -43,7 +135,8 @@ QString ArchiveAccessError::deriveSecondary() const { return mSpecific; }
 ArchiveAccess::ArchiveAccess(Core& core, Type type) :
     Directorate(core.director()),
     mType(type),
-    mArchivesDir(core.fpInstall().archiveDataDirectory())
+    mArchivesDir(core.fpInstall().archiveDataDirectory()),
+    mIndexChecked(false)
 {
     logEvent(MSG_INIT.arg(ENUM_NAME(mType)));
 
@@ -63,7 +156,7 @@ ArchiveAccess::ArchiveAccess(Core& core, Type type) :
     logEvent(MSG_PART_COUNT.arg(mParts.size()));
 
     for(const auto& pp : std::as_const(partPaths))
-        mParts.emplace_back(pp);
+        mPartLookup.append(&mParts.emplace_back(pp));
 }
 
 //-Instance Functions-------------------------------------------------------------
@@ -86,18 +179,50 @@ bool ArchiveAccess::readyPart(QuaZip& part)
     return true;
 }
 
-//Public:
-QString ArchiveAccess::name() const { return NAME; }
+QString ArchiveAccess::indexPath() const
+{
+    // Keyed on the archive location so that multiple installs don't clobber each other's index
+    QByteArray key = QCryptographicHash::hash(mArchivesDir.absolutePath().toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + INDEX_DIR + '/' +
+           INDEX_NAME_TEMPLATE.arg(ENUM_NAME(mType), QString::fromLatin1(key));
+}
 
-QByteArray ArchiveAccess::getFileContents(const QString& inZipPath)
+void ArchiveAccess::prepareIndex()
 {
-    /* Maybe return an ArchiveAccessError, for cases where something unexpected happened
-     * (can't open zip, or file not found), and treat those cases as an error instead
-     * of a warning.
-     */
-    logEvent(MSG_FILE_SEARCH.arg(ENUM_NAME(mType), inZipPath));
+    // Only attempted once per instance, if it can't be loaded or built, lookups fall back to searching
+    if(mIndexChecked || mParts.empty())
+        return;
+    mIndexChecked = true;
+
+    QString path = indexPath();
+    QList<QFileInfo> partInfos;
+    for(const QuaZip* part : std::as_const(mPartLookup))
+        partInfos.append(QFileInfo(part->getZipName()));
+
+    if(mIndex.load(path, partInfos))
+    {
+        logEvent(MSG_INDEX_LOADED.arg(path).arg(mIndex.entryCount()));
+        return;
+    }
+
+    // (Re)build, which requires walking every part once
+    logEvent(MSG_INDEX_BUILDING.arg(path));
+    for(auto& part : mParts)
+        if(!readyPart(part))
+            return;
 
-    // Simply search all parts (what the stock launcher does, though I'm sure it could be more optimal)
+    QString errStr;
+    if(!QDir().mkpath(QFileInfo(path).absolutePath()))
+        logEvent(MSG_INDEX_FAILED.arg(path));
+    else if(!mIndex.build(path, mParts, &errStr))
+        logEvent(MSG_INDEX_FAILED.arg(errStr));
+    else
+        logEvent(MSG_INDEX_BUILT.arg(mIndex.entryCount()));
+}
+
+ArchiveAccessError ArchiveAccess::searchParts(std::unique_ptr<QIODevice>& file, const QString& inZipPath)
+{
+    // Simply search all parts (what the stock launcher does)
     for(auto& part : mParts)
     {
         if(!readyPart(part))
@@ -105,17 +230,42 @@ QByteArray ArchiveAccess::getFileContents(const QString& inZipPath)
 
         if(part.setCurrentFile(inZipPath))
         {
-            QuaZipFile file(&part); // auto-closes on destruct
-            if(!file.open(QIODevice::ReadOnly))
-            {
-                logError(ArchiveAccessError(ArchiveAccessError::CantOpenFile, part.getZipName()));
-                break;
-            }
-
-            return file.readAll();
+            auto zipFile = std::make_unique<QuaZipFile>(&part); // auto-closes on destruct
+            if(!zipFile->open(QIODevice::ReadOnly))
+                return ArchiveAccessError(ArchiveAccessError::CantOpenFile, part.getZipName());
+
+            file = std::move(zipFile);
+            return ArchiveAccessError();
         }
     }
 
-    logError(ArchiveAccessError(ArchiveAccessError::FileNotFound));
-    return {};
+    return ArchiveAccessError(ArchiveAccessError::FileNotFound);
+}
+
+//Public:
+QString ArchiveAccess::name() const { return NAME; }
+
+ArchiveAccessError ArchiveAccess::openFile(std::unique_ptr<QIODevice>& file, const QString& inZipPath)
+{
+    logEvent(MSG_FILE_SEARCH.arg(ENUM_NAME(mType), inZipPath));
+
+    prepareIndex();
+    if(!mIndex.isValid())
+        return searchParts(file, inZipPath);
+
+    // Single probe, then a single seek in the part that holds the file
+    std::optional<ArchiveIndex::Entry> entry = mIndex.find(inZipPath);
+    if(!entry)
+        return ArchiveAccessError(ArchiveAccessError::FileNotFound);
+
+    QuaZip& part = *mPartLookup.at(entry->part);
+    if(!readyPart(part))
+        return ArchiveAccessError(ArchiveAccessError::CantOpenPart, part.getZipName());
+
+    auto entryFile = std::make_unique<ArchiveEntry>(part, *entry);
+    if(!entryFile->open(QIODevice::ReadOnly))
+        return ArchiveAccessError(ArchiveAccessError::CantOpenFile, part.getZipName());
+
+    file = std::move(entryFile);
+    return ArchiveAccessError();
 }
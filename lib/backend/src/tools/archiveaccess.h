@@ -3,6 +3,7 @@
 
 // Standard Library Includes
 #include <list>
+#include <memory>
 
 // Qx Includes
 #include <qx/core/qx-error.h>
@@ -13,6 +14,7 @@
 
 // Project Includes
 #include "kernel/directorate.h"
+#include "tools/archiveindex.h"
 
 /* TODO: Arguably this should be part of libfp, though that would require
  * making Quazip/zlib a dependency for it as well. I'd like to have only
@@ -71,6 +73,43 @@ private:
     QString deriveSecondary() const override;
 };
 
+/* Reads a single file from an archive part using a position from the index, which avoids the
+ * central directory scan that QuaZipFile requires to locate the file. The CRC is verified once
+ * the end of the file is reached, with a failure reported as a read error.
+ */
+class ArchiveEntry : public QIODevice
+{
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    QuaZip& mPart;
+    ArchiveIndex::Entry mEntry;
+    qint64 mRemaining;
+    bool mFileOpen;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    ArchiveEntry(QuaZip& part, const ArchiveIndex::Entry& entry);
+
+//-Destructor----------------------------------------------------------------------------------------------------------
+public:
+    ~ArchiveEntry();
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    bool closeFile();
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+public:
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override;
+    qint64 size() const override;
+    qint64 bytesAvailable() const override;
+};
+
 class ArchiveAccess : public Directorate
 {
 //-Class Variables-------------------------------------------------------------------------------------------------
@@ -87,6 +126,14 @@ private:
     static inline const QString MSG_PREPARING_PART = u"Preparing part %1."_s;
     static inline const QString MSG_PART_OPEN = u"Part %1 is already open."_s;
     static inline const QString MSG_FILE_SEARCH = u"Searching %1 parts for %2."_s;
+    static inline const QString MSG_INDEX_LOADED = u"Loaded archive index %1 (%2 entries)."_s;
+    static inline const QString MSG_INDEX_BUILDING = u"Archive index is missing or stale, building %1..."_s;
+    static inline const QString MSG_INDEX_BUILT = u"Built archive index with %1 entries."_s;
+    static inline const QString MSG_INDEX_FAILED = u"Failed to build archive index (%1), falling back to a linear search."_s;
+
+    // Index
+    static inline const QString INDEX_DIR = u"/archive-index"_s;
+    static inline const QString INDEX_NAME_TEMPLATE = u"%1-%2.idx"_s;
 
 //-Class Enums------------------------------------------------------------------------------------------------
 public:
@@ -97,6 +144,9 @@ private:
     Type mType;
     QDir mArchivesDir;
     std::list<QuaZip> mParts; // QuaZip cannot be moved, so we cannot use QList/vector :/
+    QList<QuaZip*> mPartLookup; // Random access to the above
+    ArchiveIndex mIndex;
+    bool mIndexChecked;
 
 //-Constructor----------------------------------------------------------------------------------------------------------
 public:
@@ -105,10 +155,14 @@ public:
 //-Instance Functions------------------------------------------------------------------------------------------------------
 private:
     bool readyPart(QuaZip& part);
+    QString indexPath() const;
+    void prepareIndex();
+    ArchiveAccessError searchParts(std::unique_ptr<QIODevice>& file, const QString& inZipPath);
 
 public:
     QString name() const override;
-    QByteArray getFileContents(const QString& inZipPath); // Don't use leading slashes.
+    // Returns an open, sequential device for the file. Don't use leading slashes.
+    ArchiveAccessError openFile(std::unique_ptr<QIODevice>& file, const QString& inZipPath);
 
 };
 
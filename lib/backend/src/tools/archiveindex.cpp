@@ -0,0 +1,329 @@
+// Unit Include
+#include "archiveindex.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstring>
+
+// Qt Includes
+#include <QSaveFile>
+#include <QDateTime>
+
+namespace // Unit helper functions
+{
+
+bool unzFailure(int code, QString* errorString, const QString& zipName)
+{
+    if(code == UNZ_OK)
+        return false;
+
+    if(errorString)
+        *errorString = u"Failed to read the central directory of %1 (%2)"_s.arg(zipName).arg(code);
+    return true;
+}
+
+}
+
+//===============================================================================================================
+// ArchiveIndex
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Public:
+ArchiveIndex::ArchiveIndex() :
+    mData(nullptr),
+    mHeader(nullptr),
+    mParts(nullptr),
+    mEntries(nullptr),
+    mBuckets(nullptr),
+    mStrings(nullptr)
+{
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(PartRecord) % 8 == 0 && sizeof(EntryRecord) % 8 == 0,
+                  "Index records must keep 8 byte alignment when laid out back to back");
+}
+
+//-Class Functions-------------------------------------------------------------
+//Private:
+quint64 ArchiveIndex::hashPath(QByteArrayView path)
+{
+    // FNV-1a, as the value is persisted it must be stable across runs, unlike qHash()
+    quint64 hash = 14695981039346656037ULL;
+    for(char c : path)
+    {
+        hash ^= static_cast<uchar>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+bool ArchiveIndex::isValid() const { return mData; }
+quint32 ArchiveIndex::entryCount() const { return mHeader ? mHeader->entryCount : 0; }
+
+bool ArchiveIndex::load(const QString& indexPath, const QList<QFileInfo>& parts)
+{
+    close();
+
+    mFile.setFileName(indexPath);
+    if(!mFile.open(QIODevice::ReadOnly) || mFile.size() < qint64(sizeof(Header)))
+    {
+        close();
+        return false;
+    }
+
+    const uchar* data = mFile.map(0, mFile.size());
+    if(!data)
+    {
+        close();
+        return false;
+    }
+
+    // Check layout
+    auto header = reinterpret_cast<const Header*>(data);
+    if(std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+       header->partCount != parts.size() || header->bucketCount <= header->entryCount ||
+       (header->bucketCount & (header->bucketCount - 1)) != 0)
+    {
+        close();
+        return false;
+    }
+
+    quint64 partsOffset = sizeof(Header);
+    quint64 entriesOffset = partsOffset + quint64(header->partCount) * sizeof(PartRecord);
+    quint64 bucketsOffset = entriesOffset + quint64(header->entryCount) * sizeof(EntryRecord);
+    quint64 stringsOffset = bucketsOffset + quint64(header->bucketCount) * sizeof(quint32);
+    if(stringsOffset + header->stringsSize != quint64(mFile.size()))
+    {
+        close();
+        return false;
+    }
+
+    mData = data;
+    mHeader = header;
+    mParts = reinterpret_cast<const PartRecord*>(data + partsOffset);
+    mEntries = reinterpret_cast<const EntryRecord*>(data + entriesOffset);
+    mBuckets = reinterpret_cast<const quint32*>(data + bucketsOffset);
+    mStrings = reinterpret_cast<const char*>(data + stringsOffset);
+
+    // Check that the index was built from the current parts
+    mPartMap.fill(0, parts.size());
+    for(quint32 i = 0; i < header->partCount; i++)
+    {
+        const PartRecord& pr = mParts[i];
+        if(quint64(pr.nameOffset) + pr.nameLength > header->stringsSize)
+        {
+            close();
+            return false;
+        }
+
+        QString partName = QString::fromUtf8(mStrings + pr.nameOffset, pr.nameLength);
+        auto match = std::find_if(parts.cbegin(), parts.cend(), [&](const QFileInfo& fi){
+            return fi.fileName() == partName;
+        });
+
+        if(match == parts.cend() || match->size() != pr.size ||
+           match->lastModified().toMSecsSinceEpoch() != pr.modified)
+        {
+            close();
+            return false;
+        }
+
+        mPartMap[i] = std::distance(parts.cbegin(), match);
+    }
+
+    return true;
+}
+
+bool ArchiveIndex::build(const QString& indexPath, std::list<QuaZip>& parts, QString* errorString)
+{
+    close();
+
+    QList<PartRecord> partRecords;
+    std::vector<EntryRecord> entries;
+    QByteArray strings;
+    QList<QFileInfo> partInfos;
+
+    auto addString = [&strings](QByteArrayView str){
+        quint32 offset = strings.size();
+        strings.append(str);
+        return offset;
+    };
+
+    // Walk each central directory once
+    quint32 partIndex = 0;
+    for(QuaZip& part : parts)
+    {
+        QFileInfo partInfo(part.getZipName());
+        QByteArray partName = partInfo.fileName().toUtf8();
+        partInfos.append(partInfo);
+        partRecords.append({
+            .size = partInfo.size(),
+            .modified = partInfo.lastModified().toMSecsSinceEpoch(),
+            .nameOffset = addString(partName),
+            .nameLength = quint32(partName.size())
+        });
+
+        unzFile uf = part.getUnzFile();
+        if(!part.isOpen() || !uf)
+        {
+            if(errorString)
+                *errorString = u"Part %1 is not open"_s.arg(part.getZipName());
+            return false;
+        }
+
+        QByteArray nameBuffer;
+        int code = unzGoToFirstFile(uf);
+        while(code == UNZ_OK)
+        {
+            unz_file_info64 info;
+            if(unzFailure(unzGetCurrentFileInfo64(uf, &info, nullptr, 0, nullptr, 0, nullptr, 0), errorString, part.getZipName()))
+                return false;
+
+            nameBuffer.resize(info.size_filename);
+            if(unzFailure(unzGetCurrentFileInfo64(uf, nullptr, nameBuffer.data(), nameBuffer.size(), nullptr, 0, nullptr, 0), errorString, part.getZipName()))
+                return false;
+
+            // Only files are ever looked up
+            if(!nameBuffer.endsWith('/'))
+            {
+                unz64_file_pos pos;
+                if(unzFailure(unzGetFilePos64(uf, &pos), errorString, part.getZipName()))
+                    return false;
+
+                entries.push_back({
+                    .pathHash = hashPath(nameBuffer),
+                    .dirPosition = pos.pos_in_zip_directory,
+                    .fileNumber = pos.num_of_file,
+                    .compressedSize = info.compressed_size,
+                    .uncompressedSize = info.uncompressed_size,
+                    .pathOffset = addString(nameBuffer),
+                    .pathLength = quint32(nameBuffer.size()),
+                    .part = partIndex,
+                    .crc = quint32(info.crc)
+                });
+            }
+
+            code = unzGoToNextFile(uf);
+        }
+
+        if(code != UNZ_END_OF_LIST_OF_FILE && unzFailure(code, errorString, part.getZipName()))
+            return false;
+
+        partIndex++;
+    }
+
+    if(strings.size() > std::numeric_limits<quint32>::max())
+    {
+        if(errorString)
+            *errorString = u"Archive paths are too large to index"_s;
+        return false;
+    }
+
+    // Hash table, kept at most half full. The first part containing a path wins, same as a linear search would
+    quint32 bucketCount = entries.empty() ? 2 : qNextPowerOfTwo(quint32(entries.size()) * 2 - 1);
+    QList<quint32> buckets(bucketCount, 0);
+    quint32 mask = bucketCount - 1;
+    for(quint32 i = 0; i < quint32(entries.size()); i++)
+    {
+        const EntryRecord& er = entries[i];
+        for(quint32 b = er.pathHash & mask;; b = (b + 1) & mask)
+        {
+            if(buckets[b] == 0)
+            {
+                buckets[b] = i + 1;
+                break;
+            }
+
+            const EntryRecord& other = entries[buckets[b] - 1];
+            if(other.pathHash == er.pathHash && other.pathLength == er.pathLength &&
+               std::memcmp(strings.constData() + other.pathOffset, strings.constData() + er.pathOffset, er.pathLength) == 0)
+                break;
+        }
+    }
+
+    // Write
+    Header header{
+        .magic = {MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]},
+        .version = VERSION,
+        .partCount = quint32(partRecords.size()),
+        .entryCount = quint32(entries.size()),
+        .bucketCount = bucketCount,
+        .reserved = 0,
+        .stringsSize = quint64(strings.size())
+    };
+
+    QSaveFile file(indexPath);
+    if(!file.open(QIODevice::WriteOnly) ||
+       file.write(reinterpret_cast<const char*>(&header), sizeof(header)) < 0 ||
+       file.write(reinterpret_cast<const char*>(partRecords.constData()), partRecords.size() * sizeof(PartRecord)) < 0 ||
+       file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(EntryRecord)) < 0 ||
+       file.write(reinterpret_cast<const char*>(buckets.constData()), buckets.size() * sizeof(quint32)) < 0 ||
+       file.write(strings) < 0 ||
+       !file.commit())
+    {
+        if(errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+
+    // Map what was just written
+    if(!load(indexPath, partInfos))
+    {
+        if(errorString)
+            *errorString = u"The written index could not be read back"_s;
+        return false;
+    }
+
+    return true;
+}
+
+void ArchiveIndex::close()
+{
+    mFile.close(); // Unmaps
+    mData = nullptr;
+    mHeader = nullptr;
+    mParts = nullptr;
+    mEntries = nullptr;
+    mBuckets = nullptr;
+    mStrings = nullptr;
+    mPartMap.clear();
+}
+
+std::optional<ArchiveIndex::Entry> ArchiveIndex::find(const QString& inZipPath) const
+{
+    if(!mData || mHeader->entryCount == 0)
+        return std::nullopt;
+
+    QByteArray path = inZipPath.toUtf8();
+    quint64 hash = hashPath(path);
+    quint32 mask = mHeader->bucketCount - 1;
+
+    // A sound table always has an empty bucket to stop at, but a corrupt one may not, so never go round twice
+    for(quint32 i = 0, b = hash & mask; i < mHeader->bucketCount; i++, b = (b + 1) & mask)
+    {
+        quint32 slot = mBuckets[b];
+        if(slot == 0 || slot > mHeader->entryCount)
+            return std::nullopt;
+
+        const EntryRecord& er = mEntries[slot - 1];
+        if(er.pathHash == hash && er.pathLength == path.size() &&
+           quint64(er.pathOffset) + er.pathLength <= mHeader->stringsSize &&
+           std::memcmp(mStrings + er.pathOffset, path.constData(), path.size()) == 0)
+        {
+            if(er.part >= quint32(mPartMap.size()))
+                return std::nullopt;
+
+            return Entry{
+                .part = mPartMap.at(er.part),
+                .position = {.pos_in_zip_directory = er.dirPosition, .num_of_file = er.fileNumber},
+                .compressedSize = er.compressedSize,
+                .uncompressedSize = er.uncompressedSize,
+                .crc = er.crc
+            };
+        }
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,117 @@
+#ifndef ARCHIVEINDEX_H
+#define ARCHIVEINDEX_H
+
+// Standard Library Includes
+#include <list>
+#include <optional>
+
+// Qt Includes
+#include <QFile>
+#include <QFileInfo>
+
+// Qx Includes
+#include <qx/utility/qx-macros.h>
+
+// QuaZip Includes
+#include <quazip/quazip.h>
+
+/* Persistent lookup table for the entries of a multi-part archive, which avoids having QuaZip
+ * walk the central directory of each part every run.
+ *
+ * The index is a flat file made for memory mapping (all values are native endian):
+ *
+ *  Header | PartRecord[partCount] | EntryRecord[entryCount] | quint32 buckets[bucketCount] | UTF-8 string pool
+ *
+ * Buckets form an open addressing hash table keyed on the in-zip path, with each holding an entry
+ * index + 1 (0 being empty). The part records hold the name, size and modification time of each part
+ * the index was built from so that a stale index can be detected and rebuilt.
+ */
+class ArchiveIndex
+{
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+public:
+    struct Entry
+    {
+        quint32 part; // Index into the parts the archive was loaded/built with
+        unz64_file_pos position;
+        quint64 compressedSize;
+        quint64 uncompressedSize;
+        quint32 crc;
+    };
+
+private:
+    struct Header
+    {
+        char magic[4];
+        quint32 version;
+        quint32 partCount;
+        quint32 entryCount;
+        quint32 bucketCount;
+        quint32 reserved;
+        quint64 stringsSize;
+    };
+
+    struct PartRecord
+    {
+        qint64 size;
+        qint64 modified; // ms since epoch
+        quint32 nameOffset;
+        quint32 nameLength;
+    };
+
+    struct EntryRecord
+    {
+        quint64 pathHash;
+        quint64 dirPosition;
+        quint64 fileNumber;
+        quint64 compressedSize;
+        quint64 uncompressedSize;
+        quint32 pathOffset;
+        quint32 pathLength;
+        quint32 part;
+        quint32 crc;
+    };
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    static constexpr char MAGIC[4] = {'C', 'F', 'A', 'I'};
+    static const quint32 VERSION = 1;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    QFile mFile;
+    const uchar* mData;
+    const Header* mHeader;
+    const PartRecord* mParts;
+    const EntryRecord* mEntries;
+    const quint32* mBuckets;
+    const char* mStrings;
+    QList<quint32> mPartMap; // Index part -> caller part
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    ArchiveIndex();
+    ArchiveIndex(const ArchiveIndex& other) = delete;
+
+//-Class Functions------------------------------------------------------------------------------------------------------
+private:
+    static quint64 hashPath(QByteArrayView path);
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+public:
+    bool isValid() const;
+    quint32 entryCount() const;
+
+    // The parts must be in the same order as the QuaZip instances later used to read entries
+    bool load(const QString& indexPath, const QList<QFileInfo>& parts);
+    bool build(const QString& indexPath, std::list<QuaZip>& parts, QString* errorString = nullptr);
+    void close();
+
+    std::optional<Entry> find(const QString& inZipPath) const;
+
+//-Operators------------------------------------------------------------------------------------------------------
+public:
+    ArchiveIndex& operator=(const ArchiveIndex& other) = delete;
+};
+
+#endif // ARCHIVEINDEX_H
@@ -43,7 +43,7 @@ void BlockingProcessManager::signalProcessDataReceived(const QString& msgTemplat
         output.chop(1);
 
     // Signal data
-    logEvent(msgTemplate.arg(pid, output));
+    logEvent(msgTemplate, pid, output);
 }
 
 //Public:
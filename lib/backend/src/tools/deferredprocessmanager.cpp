@@ -1,9 +1,6 @@
 // Unit Include
 #include "deferredprocessmanager.h"
 
-// Qx Includes
-#include <qx/core/qx-system.h>
-
 // Project Includes
 #include "kernel/core.h"
 #include "utility.h"
@@ -39,7 +36,7 @@ void DeferredProcessManager::handleProcessDataReceived(QProcess* process, const
         output.chop(1);
 
     // Signal data
-    logEvent(msgTemplate.arg(identifier, program, pid, output));
+    logEvent(msgTemplate, identifier, program, pid, output);
 }
 
 void DeferredProcessManager::handleProcessStdOutMessage(QProcess* process)
@@ -69,46 +66,37 @@ void DeferredProcessManager::manage(const QString& identifier, QProcess* process
 
 void DeferredProcessManager::closeProcesses()
 {
-    if(!mClosingClients)
+    if(!mClosingClients && !mManagedProcesses.isEmpty())
     {
         mClosingClients = true;
-
-        /* Can't iterate over the set here as when a process finishes 'processFinishedHandler' gets called
-         * which removes the QProcess handle from the hash, potentially invalidating the iterator. Even if it
-         * coincidentally works some of the time, this is undefined behavior and should be avoided. Instead
-         * simply check if the set is empty on each iteration
+        Tracer::Span span = tracer()->span(u"closeProcesses"_s);
+        logEvent(LOG_EVENT_CLOSING.arg(mManagedProcesses.size()));
+
+        /* Work from a copy as when a process finishes 'processFinishedHandler' gets called which removes the
+         * QProcess handle from the set. The handles themselves are only scheduled for deletion there, so
+         * they remain valid for the rest of this function.
+         *
+         * Every tree is signaled up front and then all of them are waited on together under one deadline so
+         * that shutdown takes roughly as long as the slowest process instead of the sum of all of them.
          */
+        const QList<QProcess*> processes = mManagedProcesses.values();
+        for(QProcess* proc : processes)
+            terminateTree(proc);
 
-        while(!mManagedProcesses.isEmpty())
+        const QList<QProcess*> stragglers = awaitExit(processes, QDeadlineTimer(CLOSE_GRACE_PERIOD));
+
+        // Force kill anything that ignored the clean request, again all at once
+        for(QProcess* proc : stragglers)
         {
-            // Get first process from set
-            QProcess* proc = *mManagedProcesses.constBegin();
-
-            /* Kill children of the process, as here the whole tree should be killed
-             * A "clean" kill is used for this on Linux as the vanilla Launcher uses Node.js process.kill()
-             * without a signal argument, which maps to SIGTERM (on Linux), which is a clean kill.
-             *
-             * However on Windows, its likely that the children are console processes that won't respond to a
-             * clean kill, so here we opt for a force kill.
-             */
-            QList<quint32> children = Qx::processChildren(proc->processId(), true);
-            for(quint32 cPid : children)
-            {
-#if defined __linux__
-                Qx::cleanKillProcess(cPid);
-#elif defined _WIN32
-                Qx::forceKillProcess(cPid);
-#endif
-            }
-
-            // Kill the main process itself
-            proc->terminate(); // Try nice closure first
-            if(!(proc->waitForFinished(800)))
-            {
-                proc->kill();
-                proc->waitForFinished();
-            }
+            logEvent(LOG_EVENT_PROCCESS_KILL.arg(proc->objectName(), proc->program()));
+            proc->kill();
         }
+
+        // Reap, which is near instant at this point since everything has exited or been killed
+        for(QProcess* proc : processes)
+            if(mManagedProcesses.contains(proc))
+                proc->waitForFinished();
+
         mClosingClients = false;
     }
 }
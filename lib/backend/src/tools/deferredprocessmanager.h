@@ -5,6 +5,7 @@
 #include <QObject>
 #include <QProcess>
 #include <QSet>
+#include <QDeadlineTimer>
 
 // Qx Includes
 #include <qx/core/qx-genericerror.h>
@@ -27,6 +28,11 @@ private:
     static inline const QString LOG_EVENT_PROCCESS_CLOSED = u"Deferred process '%1' ( %2 ) finished. Status: '%3', Code: %4"_s;
     static inline const QString LOG_EVENT_PROCCESS_STDOUT = u"'%1' ( %2 | %3 ) <stdout> %4"_s;
     static inline const QString LOG_EVENT_PROCCESS_STDERR = u"'%1' ( %2 | %3 ) <stderr> %4"_s;
+    static inline const QString LOG_EVENT_CLOSING = u"Closing %1 deferred process(es)"_s;
+    static inline const QString LOG_EVENT_PROCCESS_KILL = u"Deferred process '%1' ( %2 ) did not close in time, killing it"_s;
+
+    // Shutdown
+    static const int CLOSE_GRACE_PERIOD = 800; // Shared by all processes
 
     // Error
     static inline const QString ERR_PROCESS_END_PREMATURE = u"Deferred process '%1' ( %2 ) unexpectedly finished. Status: '%3', Code: %4"_s;
@@ -40,6 +46,12 @@ private:
 public:
     DeferredProcessManager(Core& core);
 
+//-Class Functions------------------------------------------------------------------------------------------------------
+private:
+    // Platform specific
+    static void terminateTree(QProcess* process);
+    static QList<QProcess*> awaitExit(const QList<QProcess*>& processes, const QDeadlineTimer& deadline); // Returns stragglers
+
 //-Instance Functions------------------------------------------------------------------------------------------------------
 private:
     QString name() const override;
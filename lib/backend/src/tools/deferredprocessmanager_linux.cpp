@@ -0,0 +1,124 @@
+// Unit Include
+#include "deferredprocessmanager.h"
+
+// Qx Includes
+#include <qx/core/qx-system.h>
+
+// System Includes
+#include <poll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace // Unit helper functions
+{
+
+int pidfdOpen(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    return syscall(SYS_pidfd_open, pid, 0);
+#else
+    Q_UNUSED(pid);
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+bool hasExited(pid_t pid)
+{
+    /* Check without reaping so that QProcess can still collect the exit status. An error here means the
+     * child is already gone (i.e. it was reaped elsewhere), which also counts.
+     */
+    siginfo_t info{};
+    if(waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) == -1)
+        return errno != EINTR;
+
+    return info.si_pid == pid;
+}
+
+}
+
+//===============================================================================================================
+// DeferredProcessManager
+//===============================================================================================================
+
+//-Class Functions-------------------------------------------------------------
+//Private:
+void DeferredProcessManager::terminateTree(QProcess* process)
+{
+    /* Kill children of the process, as here the whole tree should be killed
+     * A "clean" kill is used for this on Linux as the vanilla Launcher uses Node.js process.kill()
+     * without a signal argument, which maps to SIGTERM (on Linux), which is a clean kill.
+     */
+    const QList<quint32> children = Qx::processChildren(process->processId(), true);
+    for(quint32 cPid : children)
+        Qx::cleanKillProcess(cPid);
+
+    // Then the process itself
+    process->terminate();
+}
+
+QList<QProcess*> DeferredProcessManager::awaitExit(const QList<QProcess*>& processes, const QDeadlineTimer& deadline)
+{
+    /* A pidfd becomes readable once its process exits, so all of them can be waited on with a single poll().
+     * Kernels older than 5.3 don't support pidfds, in which case the affected processes are checked with
+     * waitid() on a short interval instead.
+     */
+    static const int FALLBACK_INTERVAL = 10;
+
+    QList<QProcess*> waiting;
+    std::vector<pollfd> fds;
+    QList<QProcess*> unpollable;
+
+    for(QProcess* proc : processes)
+    {
+        if(proc->state() == QProcess::NotRunning)
+            continue;
+
+        pid_t pid = proc->processId();
+        if(int fd = pidfdOpen(pid); fd != -1)
+        {
+            waiting.append(proc);
+            fds.push_back({.fd = fd, .events = POLLIN, .revents = 0});
+        }
+        else if(errno != ESRCH) // ESRCH means it's already gone
+            unpollable.append(proc);
+    }
+
+    qsizetype remaining = waiting.size();
+    while((remaining > 0 || !unpollable.isEmpty()) && !deadline.hasExpired())
+    {
+        int timeout = static_cast<int>(deadline.remainingTime());
+        if(!unpollable.isEmpty())
+            timeout = std::min(timeout, FALLBACK_INTERVAL);
+
+        int ready = poll(fds.data(), fds.size(), timeout);
+        if(ready == -1 && errno != EINTR)
+            break;
+
+        for(pollfd& pfd : fds)
+        {
+            if(pfd.fd >= 0 && pfd.revents != 0)
+            {
+                close(pfd.fd);
+                pfd.fd = -1; // poll() ignores negative descriptors
+                remaining--;
+            }
+        }
+
+        unpollable.removeIf([](QProcess* proc){ return hasExited(proc->processId()); });
+    }
+
+    // Anything not seen to exit is a straggler
+    QList<QProcess*> stragglers = unpollable;
+    for(qsizetype i = 0; i < waiting.size(); i++)
+    {
+        if(fds[i].fd >= 0)
+        {
+            close(fds[i].fd);
+            stragglers.append(waiting.at(i));
+        }
+    }
+
+    return stragglers;
+}
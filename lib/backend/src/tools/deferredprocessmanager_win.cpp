@@ -0,0 +1,63 @@
+// Unit Include
+#include "deferredprocessmanager.h"
+
+// Qx Includes
+#include <qx/core/qx-system.h>
+#include <qx/windows/qx-common-windows.h>
+
+//===============================================================================================================
+// DeferredProcessManager
+//===============================================================================================================
+
+//-Class Functions-------------------------------------------------------------
+//Private:
+void DeferredProcessManager::terminateTree(QProcess* process)
+{
+    /* Kill children of the process, as here the whole tree should be killed
+     * On Windows, its likely that the children are console processes that won't respond to a
+     * clean kill, so here we opt for a force kill.
+     */
+    const QList<quint32> children = Qx::processChildren(process->processId(), true);
+    for(quint32 cPid : children)
+        Qx::forceKillProcess(cPid);
+
+    // Then the process itself, nicely at first
+    process->terminate();
+}
+
+QList<QProcess*> DeferredProcessManager::awaitExit(const QList<QProcess*>& processes, const QDeadlineTimer& deadline)
+{
+    // Process handles are signaled on exit, so they can be waited on in batches of up to MAXIMUM_WAIT_OBJECTS
+    QList<QProcess*> waiting;
+    QList<HANDLE> handles;
+
+    for(QProcess* proc : processes)
+    {
+        if(proc->state() == QProcess::NotRunning)
+            continue;
+
+        if(HANDLE h = OpenProcess(SYNCHRONIZE, FALSE, proc->processId()))
+        {
+            waiting.append(proc);
+            handles.append(h);
+        }
+        // Else, the process is already gone
+    }
+
+    for(qsizetype i = 0; i < handles.size() && !deadline.hasExpired(); i += MAXIMUM_WAIT_OBJECTS)
+    {
+        DWORD count = std::min<DWORD>(handles.size() - i, MAXIMUM_WAIT_OBJECTS);
+        WaitForMultipleObjects(count, handles.constData() + i, TRUE, static_cast<DWORD>(deadline.remainingTime()));
+    }
+
+    // Anything still unsignaled is a straggler
+    QList<QProcess*> stragglers;
+    for(qsizetype i = 0; i < handles.size(); i++)
+    {
+        if(WaitForSingleObject(handles.at(i), 0) != WAIT_OBJECT_0)
+            stragglers.append(waiting.at(i));
+        CloseHandle(handles.at(i));
+    }
+
+    return stragglers;
+}
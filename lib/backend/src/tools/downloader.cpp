@@ -0,0 +1,644 @@
+// Unit Include
+#include "downloader.h"
+
+// Qt Includes
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkProxy>
+#include <QSaveFile>
+#include <QSslError>
+#include <QTimer>
+
+// Qx Includes
+#include <qx/core/qx-genericerror.h>
+#include <qx/core/qx-string.h>
+
+//===============================================================================================================
+// DownloaderError
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Private:
+DownloaderError::DownloaderError(Type t, const QString& s, const QString& d) :
+    mType(t),
+    mSpecific(s),
+    mDetails(d)
+{}
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+bool DownloaderError::isValid() const { return mType != NoError; }
+QString DownloaderError::specific() const { return mSpecific; }
+QString DownloaderError::details() const { return mDetails; }
+DownloaderError::Type DownloaderError::type() const { return mType; }
+
+//Private:
+Qx::Severity DownloaderError::deriveSeverity() const { return Qx::Critical; }
+quint32 DownloaderError::deriveValue() const { return mType; }
+QString DownloaderError::derivePrimary() const { return ERR_STRINGS.value(mType); }
+QString DownloaderError::deriveSecondary() const { return mSpecific; }
+QString DownloaderError::deriveDetails() const { return mDetails; }
+
+//===============================================================================================================
+// Downloader
+//===============================================================================================================
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+//Public:
+Downloader::Downloader(QObject* parent, Director* director) :
+    QObject(parent),
+    Directorate(director),
+    mMaxSimultaneous(DEFAULT_MAX_SIMULTANEOUS),
+    mMaxPerHost(DEFAULT_MAX_PER_HOST),
+    mProcessing(false),
+    mStopping(false),
+    mStarting(false),
+    mTotalBytes(0),
+    mProgressBytes(0),
+    mTraceCount(0),
+    mRunBytes(0),
+    mRunDuration(0),
+    mAdaptive(false),
+    mAdaptiveLimit(0),
+    mSampleBytes(0),
+    mBestRate(0)
+{
+    mNam.setTransferTimeout(TRANSFER_TIMEOUT);
+
+    mAdaptiveTimer.setInterval(ADAPTIVE_INTERVAL);
+    connect(&mAdaptiveTimer, &QTimer::timeout, this, &Downloader::sampleThroughput);
+
+    connect(&mNam, &QNetworkAccessManager::authenticationRequired, this, [this](QNetworkReply* reply){
+        logEvent(LOG_EVENT_AUTH.arg(reply->url().toString()));
+    });
+    connect(&mNam, &QNetworkAccessManager::proxyAuthenticationRequired, this, [this](const QNetworkProxy& proxy){
+        logEvent(LOG_EVENT_AUTH.arg(proxy.hostName()));
+    });
+    connect(&mNam, &QNetworkAccessManager::sslErrors, this, [this](QNetworkReply* reply, const QList<QSslError>& errors){
+        QString errStrList = Qx::String::join(errors, [](const QSslError& err){ return err.errorString(); }, u"\n"_s);
+        bool ignore = false;
+        emit sslErrors(Qx::GenericError(Qx::Warning, 12361, ERR_SSL, reply->url().toString(), errStrList), &ignore);
+        if(ignore)
+            reply->ignoreSslErrors();
+    });
+}
+
+//-Class Functions-------------------------------------------------------------
+//Private:
+QString Downloader::partPath(const Transfer& t) { return t.task.dest + PART_SUFFIX; }
+QString Downloader::sidecarPath(const Transfer& t) { return t.task.dest + PART_SUFFIX + SIDECAR_SUFFIX; }
+
+bool Downloader::isRetryable(QNetworkReply::NetworkError error)
+{
+    /* Connection level problems (0-199) and server side errors (400-499) are often transient, 4xx responses are not.
+     * A stalled transfer hitting the transfer timeout is cancelled too, so OperationCanceledError is included;
+     * deliberate aborts are told apart by the transfer instead.
+     */
+    return error < QNetworkReply::ContentAccessDenied || error >= QNetworkReply::InternalServerError;
+}
+
+//-Instance Functions---------------------------------------------------------------------------------------------------------
+//Private:
+bool Downloader::preparePartial(Transfer& t)
+{
+    QString pPath = partPath(t);
+    QString sPath = sidecarPath(t);
+    t.hash = std::make_unique<QCryptographicHash>(QCryptographicHash::Sha256);
+    t.offset = 0;
+    t.received = 0;
+    t.rangeUnsatisfiable = false;
+
+    // Check for a compatible partial download
+    bool resume = false;
+    if(QFile sidecar(sPath); QFile::exists(pPath) && sidecar.open(QIODevice::ReadOnly))
+    {
+        QJsonObject meta = QJsonDocument::fromJson(sidecar.readAll()).object();
+        qint64 partSize = QFileInfo(pPath).size();
+        qint64 expected = meta.value(SIDECAR_SIZE).toInteger(-1);
+
+        resume = meta.value(SIDECAR_URL).toString() == t.task.target.toString() &&
+                 meta.value(SIDECAR_SHA256).toString().compare(t.task.checksum, Qt::CaseInsensitive) == 0 &&
+                 partSize > 0 && (expected < 0 || partSize <= expected);
+
+        if(resume)
+        {
+            t.size = expected;
+            t.etag = meta.value(SIDECAR_ETAG).toString();
+            t.lastModified = meta.value(SIDECAR_LAST_MODIFIED).toString();
+        }
+        else
+            logEvent(LOG_EVENT_PARTIAL_STALE.arg(pPath));
+    }
+
+    if(!QFileInfo(t.task.dest).absoluteDir().mkpath(u"."_s))
+        return false;
+
+    t.part = std::make_unique<QFile>(pPath);
+    if(!resume)
+    {
+        QFile::remove(sPath);
+        return t.part->open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    /* The hash state can't be persisted portably, so the data already on disk is re-hashed instead. Reading
+     * it back sequentially is far quicker than downloading it again.
+     */
+    if(!t.part->open(QIODevice::ReadWrite))
+        return false;
+
+    while(!t.part->atEnd())
+    {
+        QByteArray chunk = t.part->read(HASH_CHUNK_SIZE);
+        if(chunk.isEmpty())
+            return false;
+        t.hash->addData(chunk);
+    }
+
+    t.offset = t.part->pos();
+    return true;
+}
+
+void Downloader::writeSidecar(const Transfer& t)
+{
+    QJsonObject meta{
+        {SIDECAR_URL, t.task.target.toString()},
+        {SIDECAR_SIZE, t.size},
+        {SIDECAR_ETAG, t.etag},
+        {SIDECAR_LAST_MODIFIED, t.lastModified},
+        {SIDECAR_SHA256, t.task.checksum}
+    };
+
+    // Not being able to write this only costs the ability to resume
+    QSaveFile sidecar(sidecarPath(t));
+    if(sidecar.open(QIODevice::WriteOnly))
+    {
+        sidecar.write(QJsonDocument(meta).toJson(QJsonDocument::Compact));
+        sidecar.commit();
+    }
+}
+
+void Downloader::discardPartial(Transfer& t)
+{
+    if(t.part)
+    {
+        t.part->close();
+        t.part->remove();
+    }
+    QFile::remove(sidecarPath(t));
+}
+
+void Downloader::request(Transfer& t)
+{
+    if(t.reply)
+        t.reply->deleteLater();
+
+    t.attempts++;
+    t.writeFailed = false;
+    t.aborted = false;
+    if(!preparePartial(t))
+    {
+        fail(t, DownloaderError(DownloaderError::OpenFile, partPath(t), t.part ? t.part->errorString() : QString()));
+        return;
+    }
+
+    QNetworkRequest req(t.task.target);
+    if(t.offset > 0)
+    {
+        logDebug(LOG_EVENT_RESUME, t.task.target.toString(), t.offset);
+        req.setRawHeader("Range", "bytes=" + QByteArray::number(t.offset) + '-');
+
+        // Only continue if the resource is unchanged, otherwise the server sends it in full
+        if(!t.etag.isEmpty())
+            req.setRawHeader("If-Range", t.etag.toUtf8());
+        else if(!t.lastModified.isEmpty())
+            req.setRawHeader("If-Range", t.lastModified.toUtf8());
+    }
+    else
+        logDebug(LOG_EVENT_START, t.task.target.toString(), QDir::toNativeSeparators(t.task.dest));
+
+    mProgressBytes += t.offset;
+    countSize(t);
+    emit downloadProgress(mProgressBytes);
+
+    t.traceId = ++mTraceCount;
+    t.firstByte = false;
+    tracer()->beginAsync(TRACE_AWAIT.arg(QFileInfo(t.task.dest).fileName()), t.traceId, TRACE_CATEGORY);
+
+    t.reply = mNam.get(req);
+    connect(t.reply, &QNetworkReply::metaDataChanged, this, [this, &t]{ handleMetaData(t); });
+    connect(t.reply, &QNetworkReply::readyRead, this, [this, &t]{ handleData(t); });
+    connect(t.reply, &QNetworkReply::finished, this, [this, &t]{ handleFinished(t); });
+}
+
+void Downloader::endTrace(Transfer& t)
+{
+    if(!t.traceId)
+        return;
+
+    tracer()->endAsync((t.firstByte ? TRACE_RECEIVE : TRACE_AWAIT).arg(QFileInfo(t.task.dest).fileName()), t.traceId, TRACE_CATEGORY);
+    t.traceId = 0;
+}
+
+void Downloader::startNext()
+{
+    /* A transfer that fails while being started retires itself, which lands back here. Only the outermost
+     * call may start transfers and wrap up the batch, otherwise 'finished' would be emitted more than once.
+     */
+    if(mStarting)
+        return;
+    mStarting = true;
+
+    int limit = mAdaptive ? mAdaptiveLimit : mMaxSimultaneous;
+    while(!mStopping && !mQueue.isEmpty() && mActive.size() < size_t(limit))
+    {
+        // Take the first task whose host has room
+        auto qItr = mQueue.begin();
+        if(mMaxPerHost > 0)
+        {
+            qItr = std::find_if(mQueue.begin(), mQueue.end(), [this](const Qx::DownloadTask& task){
+                return mHostLoad.value(task.target.host()) < mMaxPerHost;
+            });
+            if(qItr == mQueue.end())
+                break;
+        }
+
+        mHostLoad[qItr->target.host()]++;
+        mActive.push_back({.task = *qItr});
+        mQueue.erase(qItr);
+        request(mActive.back());
+    }
+
+    mStarting = false;
+
+    if(mActive.empty() && (mQueue.isEmpty() || mStopping))
+    {
+        mProcessing = false;
+        mQueue.clear();
+        mHostLoad.clear();
+        mAdaptiveTimer.stop();
+        mRunDuration = mRunTimer.elapsed();
+
+        DownloaderError err = mError;
+        if(!err.isValid() && mStopping)
+            err = DownloaderError(DownloaderError::Aborted);
+
+        mError = DownloaderError();
+        mStopping = false;
+        emit finished(err);
+    }
+}
+
+void Downloader::finalize(Transfer& t)
+{
+    t.part->close();
+    if(t.part->error() != QFileDevice::NoError)
+    {
+        fail(t, DownloaderError(DownloaderError::WriteFile, partPath(t), t.part->errorString()));
+        return;
+    }
+
+    // Verify
+    if(!t.task.checksum.isEmpty() &&
+       t.hash->result().toHex().compare(t.task.checksum.toLatin1(), Qt::CaseInsensitive) != 0)
+    {
+        bool wasResumed = t.offset > 0;
+        discardPartial(t);
+
+        // A resumed file may have been pieced together from a resource that changed, try once from scratch
+        if(wasResumed && t.attempts < MAX_ATTEMPTS)
+        {
+            mProgressBytes -= t.offset + t.received;
+            request(t);
+            return;
+        }
+
+        fail(t, DownloaderError(DownloaderError::ChecksumMismatch, t.task.dest));
+        return;
+    }
+
+    // Move into place
+    if((QFile::exists(t.task.dest) && !QFile::remove(t.task.dest)) || !t.part->rename(t.task.dest))
+    {
+        fail(t, DownloaderError(DownloaderError::Finalize, t.task.dest, t.part->errorString()));
+        return;
+    }
+
+    QFile::remove(sidecarPath(t));
+    logDebug(LOG_EVENT_FINISHED, t.task.target.toString(), t.offset + t.received);
+    retire(t);
+}
+
+void Downloader::retire(Transfer& t)
+{
+    endTrace(t);
+    if(t.reply)
+        t.reply->deleteLater();
+
+    if(int& load = mHostLoad[t.task.target.host()]; --load <= 0)
+        mHostLoad.remove(t.task.target.host());
+
+    auto itr = std::find_if(mActive.begin(), mActive.end(), [&t](const Transfer& at){ return &at == &t; });
+    Q_ASSERT(itr != mActive.end());
+    mActive.erase(itr);
+
+    startNext();
+}
+
+void Downloader::fail(Transfer& t, const DownloaderError& error)
+{
+    if(!mError.isValid())
+        mError = error;
+
+    // One failure ends the batch, everything else stays resumable
+    if(!mStopping)
+    {
+        mStopping = true;
+        abortReplies(&t);
+    }
+
+    if(t.part && t.part->isOpen())
+        t.part->close();
+
+    retire(t);
+}
+
+void Downloader::abortReplies(const Transfer* except)
+{
+    // Aborting finishes a reply immediately, which retires its transfer, so work from a copy
+    QList<QPointer<QNetworkReply>> replies;
+    for(Transfer& t : mActive)
+    {
+        if(&t != except && t.reply)
+        {
+            t.aborted = true;
+            replies.append(t.reply);
+        }
+    }
+
+    for(const QPointer<QNetworkReply>& r : std::as_const(replies))
+        if(r)
+            r->abort();
+}
+
+void Downloader::countSize(Transfer& t)
+{
+    if(t.sizeCounted || t.size < 0)
+        return;
+
+    t.sizeCounted = true;
+    mTotalBytes += t.size;
+    emit downloadTotalChanged(mTotalBytes);
+}
+
+void Downloader::sampleThroughput()
+{
+    double rate = (mRunBytes - mSampleBytes) / (ADAPTIVE_INTERVAL / 1000.0);
+    mSampleBytes = mRunBytes;
+
+    // Only a full complement of transfers says anything about the current limit
+    if(mActive.size() < size_t(mAdaptiveLimit))
+        return;
+
+    QString rateStr = QString::number(rate / 1024.0, 'f', 0);
+    if(rate >= mBestRate * ADAPTIVE_GAIN && mAdaptiveLimit < mMaxSimultaneous)
+    {
+        mBestRate = rate;
+        logEvent(LOG_EVENT_ADAPTIVE_RAISE.arg(rateStr).arg(mAdaptiveLimit).arg(mAdaptiveLimit + 1));
+        mAdaptiveLimit++;
+        startNext();
+    }
+    else
+    {
+        // Back off the step that didn't pay for itself and stay there
+        int sampled = mAdaptiveLimit;
+        if(rate < mBestRate && mAdaptiveLimit > ADAPTIVE_START)
+            mAdaptiveLimit--;
+        logEvent(LOG_EVENT_ADAPTIVE_SETTLE.arg(rateStr).arg(sampled).arg(mAdaptiveLimit));
+        mAdaptiveTimer.stop();
+    }
+}
+
+void Downloader::handleMetaData(Transfer& t)
+{
+    int status = t.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if(status == 206)
+    {
+        // Content-Range: bytes <start>-<end>/<total>
+        QByteArray range = t.reply->rawHeader("Content-Range");
+        qsizetype slash = range.lastIndexOf('/');
+        qsizetype dash = range.indexOf('-');
+        qint64 start = dash > 6 ? range.mid(6, dash - 6).toLongLong() : -1;
+        if(start != t.offset)
+        {
+            // Should never happen, but if it does, the data can't be appended
+            t.aborted = true;
+            t.reply->abort();
+            return;
+        }
+
+        if(slash != -1)
+        {
+            bool ok;
+            qint64 total = range.sliced(slash + 1).toLongLong(&ok);
+            if(ok)
+                t.size = total;
+        }
+    }
+    else if(status == 200)
+    {
+        if(t.offset > 0)
+        {
+            // The resource changed, or the server doesn't support ranges
+            logEvent(LOG_EVENT_RANGE_IGNORED.arg(t.task.target.toString()));
+            t.part->resize(0);
+            t.part->seek(0);
+            t.hash->reset();
+            mProgressBytes -= t.offset;
+            t.offset = 0;
+        }
+
+        qint64 length = t.reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+        if(length > 0)
+            t.size = length;
+    }
+    else if(status == 416)
+    {
+        // Nothing left to send, which is only fine if the partial file is already whole (checked on finish)
+        t.rangeUnsatisfiable = true;
+        return;
+    }
+    else
+        return;
+
+    t.etag = QString::fromUtf8(t.reply->rawHeader("ETag"));
+    t.lastModified = QString::fromUtf8(t.reply->rawHeader("Last-Modified"));
+    writeSidecar(t);
+    countSize(t);
+}
+
+void Downloader::handleData(Transfer& t)
+{
+    if(t.rangeUnsatisfiable)
+    {
+        t.reply->readAll(); // Error body
+        return;
+    }
+
+    QByteArray data = t.reply->readAll();
+    if(data.isEmpty())
+        return;
+
+    if(t.part->write(data) != data.size())
+    {
+        t.writeFailed = true;
+        t.reply->abort();
+        return;
+    }
+
+    if(t.traceId && !std::exchange(t.firstByte, true))
+    {
+        QString fileName = QFileInfo(t.task.dest).fileName();
+        tracer()->endAsync(TRACE_AWAIT.arg(fileName), t.traceId, TRACE_CATEGORY);
+        tracer()->beginAsync(TRACE_RECEIVE.arg(fileName), t.traceId, TRACE_CATEGORY);
+    }
+
+    t.hash->addData(data);
+    emit dataReceived(t.task.dest, t.offset + t.received, data);
+    t.received += data.size();
+    mRunBytes += data.size();
+    mProgressBytes += data.size();
+    emit downloadProgress(mProgressBytes);
+}
+
+void Downloader::handleFinished(Transfer& t)
+{
+    // Disconnect first, retiring deletes the reply later and the transfer immediately
+    t.reply->disconnect(this);
+    endTrace(t);
+
+    if(t.rangeUnsatisfiable)
+    {
+        // Without a checksum the recorded size is all that says the partial file isn't truncated or stale
+        if(t.size >= 0 && t.offset == t.size)
+        {
+            finalize(t);
+            return;
+        }
+
+        logEvent(LOG_EVENT_PARTIAL_STALE.arg(partPath(t)));
+        discardPartial(t);
+        mProgressBytes -= t.offset;
+        if(t.attempts < MAX_ATTEMPTS)
+            request(t);
+        else
+            fail(t, DownloaderError(DownloaderError::Network, t.task.target.toString(), t.reply->errorString()));
+        return;
+    }
+
+    QNetworkReply::NetworkError error = t.reply->error();
+    if(error == QNetworkReply::NoError)
+    {
+        handleData(t); // Anything left
+        finalize(t);
+        return;
+    }
+
+    // Keep whatever was received so far
+    t.part->flush();
+    if(t.writeFailed || t.part->error() != QFileDevice::NoError)
+    {
+        fail(t, DownloaderError(DownloaderError::WriteFile, partPath(t), t.part->errorString()));
+        return;
+    }
+
+    if(mStopping)
+    {
+        logEvent(LOG_EVENT_PARTIAL_KEPT.arg(partPath(t)).arg(t.offset + t.received));
+        t.part->close();
+        retire(t);
+        return;
+    }
+
+    if(!t.aborted && isRetryable(error) && t.attempts < MAX_ATTEMPTS)
+    {
+        logEvent(LOG_EVENT_RETRY.arg(t.task.target.toString(), t.reply->errorString()).arg(t.attempts + 1).arg(MAX_ATTEMPTS));
+        t.part->close();
+        t.reply->deleteLater();
+        t.reply = nullptr;
+        mProgressBytes -= t.offset + t.received;
+
+        QTimer::singleShot(RETRY_DELAY, this, [this, &t]{
+            if(mStopping)
+                retire(t);
+            else
+                request(t);
+        });
+        return;
+    }
+
+    logEvent(LOG_EVENT_PARTIAL_KEPT.arg(partPath(t)).arg(t.offset + t.received));
+    fail(t, DownloaderError(DownloaderError::Network, t.task.target.toString(), t.reply->errorString()));
+}
+
+//Public:
+QString Downloader::name() const { return NAME; }
+bool Downloader::isProcessing() const { return mProcessing; }
+int Downloader::maxSimultaneous() const { return mMaxSimultaneous; }
+int Downloader::maxPerHost() const { return mMaxPerHost; }
+bool Downloader::isAdaptive() const { return mAdaptive; }
+qint64 Downloader::bytesTransferred() const { return mRunBytes; }
+qint64 Downloader::transferDuration() const { return mProcessing ? mRunTimer.elapsed() : mRunDuration; }
+
+double Downloader::throughput() const
+{
+    qint64 duration = transferDuration();
+    return duration > 0 ? mRunBytes / (duration / 1000.0) : 0;
+}
+
+void Downloader::setMaxSimultaneous(int max) { mMaxSimultaneous = std::max(max, 1); }
+void Downloader::setMaxPerHost(int max) { mMaxPerHost = std::max(max, 0); }
+void Downloader::setAdaptive(bool adaptive) { mAdaptive = adaptive; }
+void Downloader::appendTask(const Qx::DownloadTask& task) { mQueue.append(task); }
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+//Public Slots:
+void Downloader::processQueue()
+{
+    if(mProcessing)
+        return;
+
+    mProcessing = true;
+    mStopping = false;
+    mError = DownloaderError();
+    mTotalBytes = 0;
+    mProgressBytes = 0;
+    mRunBytes = 0;
+    mRunDuration = 0;
+    mRunTimer.start();
+
+    // In adaptive mode the overall limit is the ceiling that's worked up to
+    if(mAdaptive)
+    {
+        mAdaptiveLimit = std::min(ADAPTIVE_START, mMaxSimultaneous);
+        mSampleBytes = 0;
+        mBestRate = 0;
+        mAdaptiveTimer.start();
+    }
+
+    startNext();
+}
+
+void Downloader::abort()
+{
+    if(!mProcessing || mStopping)
+        return;
+
+    mStopping = true;
+    mQueue.clear();
+
+    // Partial files are kept so that the downloads can be resumed later
+    abortReplies();
+}
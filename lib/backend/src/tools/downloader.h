@@ -0,0 +1,246 @@
+#ifndef DOWNLOADER_H
+#define DOWNLOADER_H
+
+// Standard Library Includes
+#include <list>
+#include <memory>
+
+// Qt Includes
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QCryptographicHash>
+#include <QFile>
+
+// Qx Includes
+#include <qx/core/qx-error.h>
+#include <qx/network/qx-downloadmanager.h>
+#include <qx/utility/qx-macros.h>
+
+// Project Includes
+#include "kernel/directorate.h"
+
+class QX_ERROR_TYPE(DownloaderError, "DownloaderError", 1236)
+{
+    friend class Downloader;
+//-Class Enums-------------------------------------------------------------
+public:
+    enum Type
+    {
+        NoError,
+        Network,
+        OpenFile,
+        WriteFile,
+        ChecksumMismatch,
+        Finalize,
+        Aborted
+    };
+
+//-Class Variables-------------------------------------------------------------
+private:
+    static inline const QHash<Type, QString> ERR_STRINGS{
+        {NoError, u""_s},
+        {Network, u"A download failed."_s},
+        {OpenFile, u"Could not open a download's partial file."_s},
+        {WriteFile, u"Could not write to a download's partial file."_s},
+        {ChecksumMismatch, u"A downloaded file's checksum did not match."_s},
+        {Finalize, u"Could not move a completed download into place."_s},
+        {Aborted, u"The download(s) were aborted."_s}
+    };
+
+//-Instance Variables-------------------------------------------------------------
+private:
+    Type mType;
+    QString mSpecific;
+    QString mDetails;
+
+//-Constructor-------------------------------------------------------------
+private:
+    DownloaderError(Type t = NoError, const QString& s = {}, const QString& d = {});
+
+//-Instance Functions-------------------------------------------------------------
+public:
+    bool isValid() const;
+    Type type() const;
+    QString specific() const;
+    QString details() const;
+
+private:
+    Qx::Severity deriveSeverity() const override;
+    quint32 deriveValue() const override;
+    QString derivePrimary() const override;
+    QString deriveSecondary() const override;
+    QString deriveDetails() const override;
+};
+
+/* Downloads files to a "<dest>.part" file alongside a small JSON sidecar that records where the data came
+ * from (URL, size, ETag/Last-Modified and expected checksum). If a transfer is interrupted, be it by a
+ * network error, a stop request, or the process ending, a later attempt for the same file continues
+ * where it left off via a Range request, provided the server still has the same resource.
+ *
+ * Only once the whole file is present and its checksum verified is the partial file moved into place.
+ *
+ * Concurrency is bounded overall and, optionally, per host. In adaptive mode the overall limit starts low
+ * and is raised one step at a time for as long as each step keeps improving throughput.
+ */
+class Downloader : public QObject, public Directorate
+{
+    Q_OBJECT
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+private:
+    struct Transfer
+    {
+        Qx::DownloadTask task;
+        QPointer<QNetworkReply> reply;
+        std::unique_ptr<QFile> part;
+        std::unique_ptr<QCryptographicHash> hash;
+        QString etag;
+        QString lastModified;
+        qint64 offset = 0; // Bytes already present when the current request was made
+        qint64 received = 0; // Bytes received for the current request
+        qint64 size = -1;
+        int attempts = 0;
+        quint64 traceId = 0; // Of the current request, 0 when not traced
+        bool firstByte = false; // Received for the current request
+        bool sizeCounted = false;
+        bool rangeUnsatisfiable = false;
+        bool writeFailed = false;
+        bool aborted = false; // Deliberately, as opposed to by the transfer timeout
+    };
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    // Meta
+    static inline const QString NAME = u"Downloader"_s;
+
+    // Files
+    static inline const QString PART_SUFFIX = u".part"_s;
+    static inline const QString SIDECAR_SUFFIX = u".json"_s; // Appended to the part path
+    static inline const QString SIDECAR_URL = u"url"_s;
+    static inline const QString SIDECAR_SIZE = u"size"_s;
+    static inline const QString SIDECAR_ETAG = u"etag"_s;
+    static inline const QString SIDECAR_LAST_MODIFIED = u"lastModified"_s;
+    static inline const QString SIDECAR_SHA256 = u"sha256"_s;
+
+    // Transfer
+    static const int DEFAULT_MAX_SIMULTANEOUS = 4;
+    static const int DEFAULT_MAX_PER_HOST = 0; // Unlimited
+    static const int MAX_ATTEMPTS = 3;
+    static const int RETRY_DELAY = 1000; // ms
+    static const int TRANSFER_TIMEOUT = 30000; // ms
+    static const qint64 HASH_CHUNK_SIZE = 1024 * 1024;
+
+    // Adaptive concurrency
+    static const int ADAPTIVE_START = 2;
+    static const int ADAPTIVE_INTERVAL = 2000; // ms between throughput samples
+    static constexpr double ADAPTIVE_GAIN = 1.1; // Required improvement to keep climbing
+
+    // Logging
+    static inline const QString LOG_EVENT_START = u"Downloading \"%1\" -> \"%2\""_s;
+    static inline const QString LOG_EVENT_RESUME = u"Resuming \"%1\" from byte %2"_s;
+    static inline const QString LOG_EVENT_RANGE_IGNORED = u"Server ignored the range request for \"%1\", starting over"_s;
+    static inline const QString LOG_EVENT_PARTIAL_STALE = u"Discarding stale partial download \"%1\""_s;
+    static inline const QString LOG_EVENT_PARTIAL_KEPT = u"Keeping partial download \"%1\" (%2 bytes) for resumption"_s;
+    static inline const QString LOG_EVENT_RETRY = u"Download of \"%1\" failed (%2), retrying (attempt %3 of %4)"_s;
+    static inline const QString LOG_EVENT_FINISHED = u"Downloaded \"%1\" (%2 bytes)"_s;
+    static inline const QString LOG_EVENT_AUTH = u"File download unexpectedly requires authentication (%1)"_s;
+    static inline const QString LOG_EVENT_ADAPTIVE_RAISE = u"Throughput %1 KiB/s at %2 simultaneous downloads, raising to %3"_s;
+    static inline const QString LOG_EVENT_ADAPTIVE_SETTLE = u"Throughput %1 KiB/s at %2 simultaneous downloads, settling on %3"_s;
+
+    // Tracing
+    static inline const QString TRACE_CATEGORY = u"network"_s;
+    static inline const QString TRACE_AWAIT = u"Await %1"_s; // Request to first byte
+    static inline const QString TRACE_RECEIVE = u"Receive %1"_s; // First byte to finish
+
+    // Error
+    static inline const QString ERR_SSL = u"The download encountered SSL errors. Continue anyway?"_s;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    QNetworkAccessManager mNam;
+    QList<Qx::DownloadTask> mQueue;
+    std::list<Transfer> mActive; // Members are not movable
+    int mMaxSimultaneous;
+    int mMaxPerHost;
+    QHash<QString, int> mHostLoad;
+    bool mProcessing;
+    bool mStopping;
+    bool mStarting; // Guards startNext() against re-entry when a transfer fails as it's started
+    qint64 mTotalBytes;
+    qint64 mProgressBytes;
+    quint64 mTraceCount;
+    DownloaderError mError;
+
+    // Throughput
+    QElapsedTimer mRunTimer;
+    qint64 mRunBytes; // Bytes received this run, not counting resumed data
+    qint64 mRunDuration;
+
+    // Adaptive
+    bool mAdaptive;
+    int mAdaptiveLimit;
+    QTimer mAdaptiveTimer;
+    qint64 mSampleBytes;
+    double mBestRate;
+
+//-Constructor-------------------------------------------------------------------------------------------------
+public:
+    explicit Downloader(QObject* parent, Director* director);
+
+//-Class Functions------------------------------------------------------------------------------------------------------
+private:
+    static QString partPath(const Transfer& t);
+    static QString sidecarPath(const Transfer& t);
+    static bool isRetryable(QNetworkReply::NetworkError error);
+
+//-Instance Functions---------------------------------------------------------------------------------------------------------
+private:
+    bool preparePartial(Transfer& t);
+    void writeSidecar(const Transfer& t);
+    void discardPartial(Transfer& t);
+    void request(Transfer& t);
+    void endTrace(Transfer& t);
+    void startNext();
+    void finalize(Transfer& t);
+    void retire(Transfer& t);
+    void fail(Transfer& t, const DownloaderError& error);
+    void abortReplies(const Transfer* except = nullptr);
+    void countSize(Transfer& t);
+    void sampleThroughput();
+
+    void handleMetaData(Transfer& t);
+    void handleData(Transfer& t);
+    void handleFinished(Transfer& t);
+
+public:
+    QString name() const override;
+    bool isProcessing() const;
+    int maxSimultaneous() const;
+    int maxPerHost() const;
+    bool isAdaptive() const;
+    qint64 bytesTransferred() const;
+    qint64 transferDuration() const;
+    double throughput() const;
+
+    void setMaxSimultaneous(int max);
+    void setMaxPerHost(int max);
+    void setAdaptive(bool adaptive);
+    void appendTask(const Qx::DownloadTask& task);
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+public slots:
+    void processQueue();
+    void abort();
+
+signals:
+    void sslErrors(const Qx::Error& error, bool* ignore);
+    void downloadTotalChanged(qint64 total);
+    void downloadProgress(qint64 bytes);
+    void dataReceived(const QString& dest, qint64 offset, const QByteArray& data); // Written, but not yet verified
+    void finished(const DownloaderError& errorState);
+};
+
+#endif // DOWNLOADER_H
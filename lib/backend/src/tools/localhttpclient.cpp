@@ -0,0 +1,98 @@
+// Unit Includes
+#include "localhttpclient.h"
+
+// Qt Includes
+#include <QSslError>
+
+// Qx Includes
+#include <qx/core/qx-string.h>
+
+// Project Includes
+#include "kernel/tracer.h"
+
+//===============================================================================================================
+// LocalHttpClient
+//===============================================================================================================
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+//Public:
+LocalHttpClient::LocalHttpClient(Director* director) :
+    Directorate(director),
+    mNextTraceId(0)
+{
+    // Setup Network Access Manager
+    mNam.setAutoDeleteReplies(true);
+    mNam.setTransferTimeout(TRANSFER_TIMEOUT);
+
+    /* Network check (none of these should be triggered, they are here in case a FP update would required
+     * them to be used as to help make that clear in the logs when the update causes this to stop working).
+     */
+    connect(&mNam, &QNetworkAccessManager::authenticationRequired, this, [this](){
+        logEvent(u"Unexpected use of authentication by local server!"_s);
+    });
+    connect(&mNam, &QNetworkAccessManager::preSharedKeyAuthenticationRequired, this, [this](){
+        logEvent(u"Unexpected use of PSK authentication by local server!"_s);
+    });
+    connect(&mNam, &QNetworkAccessManager::proxyAuthenticationRequired, this, [this](){
+        logEvent(u"Unexpected use of proxy by local server!"_s);
+    });
+    connect(&mNam, &QNetworkAccessManager::sslErrors, this, [this](QNetworkReply* reply, const QList<QSslError>& errors){
+        Q_UNUSED(reply);
+        QString errStrList = Qx::String::join(errors, [](const QSslError& err){ return err.errorString(); }, u","_s);
+        logEvent(u"Unexpected SSL errors from local server! {"_s + errStrList + u"}"_s);
+    });
+}
+
+//-Instance Functions---------------------------------------------------------------------------------------------------------
+//Private:
+QNetworkRequest LocalHttpClient::prepare(const QNetworkRequest& request) const
+{
+    // The services only speak HTTP/1.1, so keep connections alive and pipeline over them
+    QNetworkRequest req(request);
+    req.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    req.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+    req.setRawHeader("Connection"_ba, "keep-alive"_ba);
+    return req;
+}
+
+void LocalHttpClient::track(QNetworkReply* reply, const QString& tag)
+{
+    quint64 traceId = mNextTraceId++;
+    tracer()->beginAsync(tag, traceId, TRACE_CATEGORY);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Connected ahead of the caller, so the figures are up to date by the time they see the reply finish
+    connect(reply, &QNetworkReply::finished, this, [this, tag, timer, traceId]{
+        qint64 elapsed = timer.elapsed();
+        tracer()->endAsync(tag, traceId, TRACE_CATEGORY);
+
+        Latency& l = mLatency[tag];
+        l.min = l.count ? std::min(l.min, elapsed) : elapsed;
+        l.max = std::max(l.max, elapsed);
+        l.last = elapsed;
+        l.total += elapsed;
+        l.count++;
+
+        logTrace(LOG_EVENT_ROUND_TRIP, tag, elapsed, l.mean(), l.count);
+    });
+}
+
+//Public:
+QString LocalHttpClient::name() const { return NAME; }
+LocalHttpClient::Latency LocalHttpClient::latency(const QString& tag) const { return mLatency.value(tag); }
+
+QNetworkReply* LocalHttpClient::get(const QNetworkRequest& request, const QString& tag)
+{
+    QNetworkReply* reply = mNam.get(prepare(request));
+    track(reply, tag);
+    return reply;
+}
+
+QNetworkReply* LocalHttpClient::post(const QNetworkRequest& request, const QByteArray& data, const QString& tag)
+{
+    QNetworkReply* reply = mNam.post(prepare(request), data);
+    track(reply, tag);
+    return reply;
+}
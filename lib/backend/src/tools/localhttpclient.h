@@ -0,0 +1,75 @@
+#ifndef LOCALHTTPCLIENT_H
+#define LOCALHTTPCLIENT_H
+
+// Qt Includes
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QHash>
+#include <QElapsedTimer>
+
+// Project Includes
+#include "kernel/directorate.h"
+
+/* Long lived HTTP client for talking to the local Flashpoint services (game server, PHP router).
+ *
+ * One instance is owned by Core and shared by everything that needs it so that connections to those services
+ * are kept alive and reused (and requests pipelined) instead of a new TCP connection, and network access
+ * manager, being spun up for every mount. In resident mode the client is also carried over between sessions.
+ *
+ * The round-trip time of each request is recorded, per tag, for diagnostics.
+ */
+class LocalHttpClient : public QObject, public Directorate
+{
+    Q_OBJECT
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+public:
+    struct Latency
+    {
+        int count = 0;
+        qint64 last = 0; // ms
+        qint64 min = 0;
+        qint64 max = 0;
+        qint64 total = 0;
+
+        qint64 mean() const { return count ? total / count : 0; }
+    };
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    // Meta
+    static inline const QString NAME = u"LocalHttpClient"_s;
+
+    // Connections
+    static const int TRANSFER_TIMEOUT = 30000; // ms
+
+    // Logging
+    static inline const QString LOG_EVENT_ROUND_TRIP = u"%1 round trip took %2 ms (mean %3 ms over %4 request(s))"_s;
+
+    // Tracing
+    static inline const QString TRACE_CATEGORY = u"local-http"_s;
+
+//-Instance Variables------------------------------------------------------------------------------------------------------------
+private:
+    QNetworkAccessManager mNam;
+    QHash<QString, Latency> mLatency;
+    quint64 mNextTraceId;
+
+//-Constructor-------------------------------------------------------------------------------------------------
+public:
+    explicit LocalHttpClient(Director* director = nullptr);
+
+//-Instance Functions---------------------------------------------------------------------------------------------------------
+private:
+    QNetworkRequest prepare(const QNetworkRequest& request) const;
+    void track(QNetworkReply* reply, const QString& tag);
+
+public:
+    QString name() const override;
+    Latency latency(const QString& tag) const;
+
+    QNetworkReply* get(const QNetworkRequest& request, const QString& tag);
+    QNetworkReply* post(const QNetworkRequest& request, const QByteArray& data, const QString& tag);
+};
+
+#endif // LOCALHTTPCLIENT_H
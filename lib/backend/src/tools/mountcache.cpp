@@ -0,0 +1,116 @@
+// Unit Include
+#include "mountcache.h"
+
+// Qt Includes
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+//===============================================================================================================
+// MountCache
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Public:
+MountCache::MountCache() :
+    mDirty(false)
+{}
+
+//-Class Functions----------------------------------------------------------------
+//Private:
+QString MountCache::filePath() { return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + u"/"_s + FILE_NAME; }
+
+QString MountCache::key(const QString& packPath)
+{
+    QString k = QFileInfo(packPath).absoluteFilePath();
+#ifdef _WIN32
+    k = k.toLower(); // Case insensitive file system
+#endif
+    return k;
+}
+
+//-Instance Functions-------------------------------------------------------------
+//Public:
+bool MountCache::load(const Session& session)
+{
+    mSession = session;
+    mPacks.clear();
+    mDirty = false;
+
+    if(!mSession.isValid())
+        return false;
+
+    QFile cacheFile(filePath());
+    if(!cacheFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonObject root = QJsonDocument::fromJson(cacheFile.readAll()).object();
+    Session stored{
+        .pid = static_cast<quint32>(root.value(KEY_PID).toInteger()),
+        .startTime = static_cast<quint64>(root.value(KEY_START_TIME).toString().toULongLong()) // String to avoid double precision loss
+    };
+
+    if(stored != mSession)
+    {
+        mDirty = true; // Overwrite the stale record on next save
+        return false;
+    }
+
+    const QJsonArray packs = root.value(KEY_PACKS).toArray();
+    for(const QJsonValue& p : packs)
+        mPacks.insert(p.toString());
+
+    return true;
+}
+
+MountCache::Session MountCache::session() const { return mSession; }
+bool MountCache::contains(const QString& packPath) const { return mSession.isValid() && mPacks.contains(key(packPath)); }
+
+void MountCache::insert(const QString& packPath)
+{
+    if(!mSession.isValid())
+        return;
+
+    mPacks.insert(key(packPath));
+    mDirty = true;
+}
+
+bool MountCache::save(QString* errorString)
+{
+    if(!mDirty)
+        return true;
+
+    QString path = filePath();
+    if(!QDir().mkpath(QFileInfo(path).absolutePath()))
+    {
+        if(errorString)
+            *errorString = u"Could not create cache directory"_s;
+        return false;
+    }
+
+    QJsonArray packs;
+    for(const QString& p : std::as_const(mPacks))
+        packs.append(p);
+
+    QJsonObject root{
+        {KEY_PID, static_cast<qint64>(mSession.pid)},
+        {KEY_START_TIME, QString::number(mSession.startTime)},
+        {KEY_PACKS, packs}
+    };
+
+    QSaveFile cacheFile(path);
+    if(!cacheFile.open(QIODevice::WriteOnly) || cacheFile.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) == -1 ||
+       !cacheFile.commit())
+    {
+        if(errorString)
+            *errorString = cacheFile.errorString();
+        return false;
+    }
+
+    mDirty = false;
+    return true;
+}
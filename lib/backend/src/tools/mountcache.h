@@ -0,0 +1,66 @@
+#ifndef MOUNTCACHE_H
+#define MOUNTCACHE_H
+
+// Qt Includes
+#include <QString>
+#include <QSet>
+
+/* Remembers which data packs have been mounted by the currently running game server, so that launching
+ * the same title again while the services stay up doesn't mount its pack a second time.
+ *
+ * The record is kept on disk so that it carries over between separate runs (i.e. companion mode) and is tied
+ * to a server session, which is identified by the PID and start time of whatever is listening on the mount
+ * port. Once the server restarts the session no longer matches and the record is dropped.
+ */
+class MountCache
+{
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+public:
+    struct Session
+    {
+        quint32 pid = 0;
+        quint64 startTime = 0; // Platform specific units, only used for comparison
+
+        bool isValid() const { return pid != 0; }
+        bool operator==(const Session& other) const = default;
+    };
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    static inline const QString FILE_NAME = u"mounts.json"_s;
+
+    // Keys
+    static inline const QString KEY_PID = u"pid"_s;
+    static inline const QString KEY_START_TIME = u"startTime"_s;
+    static inline const QString KEY_PACKS = u"packs"_s;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    Session mSession;
+    QSet<QString> mPacks;
+    bool mDirty;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    MountCache();
+
+//-Class Functions------------------------------------------------------------------------------------------------------
+private:
+    static QString filePath();
+    static QString key(const QString& packPath);
+
+public:
+    // Platform specific
+    static Session serverSession(quint16 port);
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+public:
+    bool load(const Session& session); // Returns false if the stored record belonged to another session
+    Session session() const;
+
+    bool contains(const QString& packPath) const;
+    void insert(const QString& packPath);
+    bool save(QString* errorString = nullptr);
+};
+
+#endif // MOUNTCACHE_H
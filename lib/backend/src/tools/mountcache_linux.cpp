@@ -0,0 +1,94 @@
+// Unit Include
+#include "mountcache.h"
+
+// Qt Includes
+#include <QDir>
+#include <QFile>
+
+// System Includes
+#include <unistd.h>
+
+namespace // Unit helper functions
+{
+
+QSet<QByteArray> listeningSockets(quint16 port)
+{
+    // Both tables share the same layout: sl local_address rem_address st ... inode
+    static const QByteArray STATE_LISTEN = "0A"_ba;
+    static const qsizetype FIELD_INODE = 9;
+
+    QSet<QByteArray> sockets;
+    for(const QString& table : {u"/proc/net/tcp"_s, u"/proc/net/tcp6"_s})
+    {
+        QFile tableFile(table);
+        if(!tableFile.open(QIODevice::ReadOnly))
+            continue;
+
+        tableFile.readLine(); // Skip header
+        while(!tableFile.atEnd())
+        {
+            const QList<QByteArray> fields = tableFile.readLine().simplified().split(' ');
+            if(fields.size() <= FIELD_INODE || fields.at(3) != STATE_LISTEN)
+                continue;
+
+            const QByteArray& local = fields.at(1);
+            bool ok;
+            quint16 localPort = local.mid(local.lastIndexOf(':') + 1).toUShort(&ok, 16);
+            if(ok && localPort == port)
+                sockets.insert("socket:["_ba + fields.at(FIELD_INODE) + "]"_ba);
+        }
+    }
+
+    return sockets;
+}
+
+quint64 processStartTime(quint32 pid)
+{
+    // Field 22 of stat, in clock ticks since boot. The command name (field 2) can contain spaces, so count from its end
+    QFile statFile(u"/proc/"_s + QString::number(pid) + u"/stat"_s);
+    if(!statFile.open(QIODevice::ReadOnly))
+        return 0;
+
+    QByteArray stat = statFile.readAll();
+    const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    return fields.size() > 19 ? fields.at(19).toULongLong() : 0;
+}
+
+}
+
+//===============================================================================================================
+// MountCache
+//===============================================================================================================
+
+//-Class Functions----------------------------------------------------------------
+//Public:
+MountCache::Session MountCache::serverSession(quint16 port)
+{
+    const QSet<QByteArray> sockets = listeningSockets(port);
+    if(sockets.isEmpty())
+        return {};
+
+    // Find the process holding one of the sockets
+    QDir proc(u"/proc"_s);
+    const QStringList entries = proc.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for(const QString& entry : entries)
+    {
+        bool isPid;
+        quint32 pid = entry.toUInt(&isPid);
+        if(!isPid)
+            continue;
+
+        QDir fdDir(proc.absoluteFilePath(entry + u"/fd"_s));
+        const QStringList fds = fdDir.entryList(QDir::System | QDir::NoDotAndDotDot); // Fails quietly for other users' processes
+        for(const QString& fd : fds)
+        {
+            QByteArray fdPath = QFile::encodeName(fdDir.absoluteFilePath(fd));
+            char target[64];
+            ssize_t len = readlink(fdPath.constData(), target, sizeof(target));
+            if(len > 0 && sockets.contains(QByteArray(target, len)))
+                return {.pid = pid, .startTime = processStartTime(pid)};
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,56 @@
+// Unit Include
+#include "mountcache.h"
+
+// Windows Includes
+#include <winsock2.h>
+#include <iphlpapi.h>
+
+//===============================================================================================================
+// MountCache
+//===============================================================================================================
+
+//-Class Functions----------------------------------------------------------------
+//Public:
+MountCache::Session MountCache::serverSession(quint16 port)
+{
+    // Find the owner of the listening socket
+    DWORD tableSize = 0;
+    QByteArray tableBuffer;
+    DWORD res;
+    do
+    {
+        tableBuffer.resize(tableSize);
+        res = GetExtendedTcpTable(tableBuffer.data(), &tableSize, FALSE, AF_INET, TCP_TABLE_OWNER_PID_LISTENER, 0);
+    }
+    while(res == ERROR_INSUFFICIENT_BUFFER);
+
+    if(res != NO_ERROR)
+        return {};
+
+    quint32 pid = 0;
+    auto table = reinterpret_cast<const MIB_TCPTABLE_OWNER_PID*>(tableBuffer.constData());
+    for(DWORD i = 0; i < table->dwNumEntries; i++)
+    {
+        const MIB_TCPROW_OWNER_PID& row = table->table[i];
+        if(ntohs(static_cast<u_short>(row.dwLocalPort)) == port)
+        {
+            pid = row.dwOwningPid;
+            break;
+        }
+    }
+
+    if(pid == 0)
+        return {};
+
+    // Get its creation time
+    quint64 startTime = 0;
+    if(HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid))
+    {
+        FILETIME creation, exit, kernel, user;
+        if(GetProcessTimes(h, &creation, &exit, &kernel, &user))
+            startTime = (static_cast<quint64>(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+        CloseHandle(h);
+    }
+
+    return {.pid = pid, .startTime = startTime};
+}
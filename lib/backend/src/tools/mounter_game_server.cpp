@@ -2,16 +2,12 @@
 #include "mounter_game_server.h"
 
 // Qt Includes
-#include <QAuthenticator>
-#include <QUrlQuery>
 #include <QDir>
 #include <QJsonObject>
 #include <QJsonDocument>
 
-// Qx Includes
-#include <qx/core/qx-string.h>
-
 // Project Includes
+#include "tools/localhttpclient.h"
 #include "utility.h"
 
 //===============================================================================================================
@@ -43,36 +39,14 @@ QString MounterGameServerError::deriveSecondary() const { return mSpecific; }
 
 //-Constructor----------------------------------------------------------------------------------------------------------
 //Public:
-MounterGameServer::MounterGameServer(QObject* parent, Director* director) :
+MounterGameServer::MounterGameServer(QObject* parent, Director* director, LocalHttpClient* httpClient) :
     QObject(parent),
     Directorate(director),
     mMounting(false),
-    mGameServerPort(0)
+    mGameServerPort(0),
+    mHttpClient(httpClient)
 {
-    // Setup Network Access Manager
-    mNam.setAutoDeleteReplies(true);
-    mNam.setTransferTimeout(GAME_SERVER_TRANSFER_TIMEOUT);
-
-    // Connections - Work
-    connect(&mNam, &QNetworkAccessManager::finished, this, &MounterGameServer::gameServerMountFinishedHandler);
-
-    /* Network check (none of these should be triggered, they are here in case a FP update would required
-     * them to be used as to help make that clear in the logs when the update causes this to stop working).
-     */
-    connect(&mNam, &QNetworkAccessManager::authenticationRequired, this, [this](){
-        logEvent(u"Unexpected use of authentication by PHP server!"_s);
-    });
-    connect(&mNam, &QNetworkAccessManager::preSharedKeyAuthenticationRequired, this, [this](){
-        logEvent(u"Unexpected use of PSK authentication by PHP server!"_s);
-    });
-    connect(&mNam, &QNetworkAccessManager::proxyAuthenticationRequired, this, [this](){
-        logEvent(u"Unexpected use of proxy by PHP server!"_s);
-    });
-    connect(&mNam, &QNetworkAccessManager::sslErrors, this, [this](QNetworkReply* reply, const QList<QSslError>& errors){
-        Q_UNUSED(reply);
-        QString errStrList = Qx::String::join(errors, [](const QSslError& err){ return err.errorString(); }, u","_s);
-        logEvent(u"Unexpected SSL errors from PHP server! {"_s + errStrList + u"}"_s"}");
-    });
+    Q_ASSERT(mHttpClient);
 }
 
 //-Instance Functions---------------------------------------------------------------------------------------------------------
@@ -105,9 +79,10 @@ void MounterGameServer::setFilePath(const QString& path) { mFilePath = QDir::toN
 
 //-Signals & Slots------------------------------------------------------------------------------------------------------------
 //Private Slots:
-void MounterGameServer::gameServerMountFinishedHandler(QNetworkReply* reply)
+void MounterGameServer::gameServerMountFinishedHandler()
 {
-    assert(reply == mGameServerMountReply.get());
+    QNetworkReply* reply = mGameServerMountReply.get();
+    Q_ASSERT(reply);
 
     MounterGameServerError err;
 
@@ -146,10 +121,10 @@ void MounterGameServer::mount()
     mountReq.setHeader(QNetworkRequest::ContentTypeHeader, "application/json"_ba);
     /* These following headers are used by the stock launcher, but don't seem to be needed;
      * however, we include them anyway out of posterity in hopes of avoiding future issues
-     * in case FPGS starts caring
+     * in case FPGS starts caring. The launcher's "Connection: close" is left out so that the
+     * shared client's connection to the server stays alive between mounts.
      */
     mountReq.setHeader(QNetworkRequest::UserAgentHeader, "axios/1.6.8"_ba);
-    mountReq.setRawHeader("Connection"_ba, "close"_ba);
     mountReq.setRawHeader("Accept"_ba, "application/json, text/plain, */*"_ba);
     mountReq.setRawHeader("Accept-Encoding"_ba, "gzip, compress, deflate, br"_ba);
 
@@ -158,7 +133,8 @@ void MounterGameServer::mount()
     QByteArray data = jdData.toJson(QJsonDocument::Compact);
 
     //-POST Request---------------------------------
-    mGameServerMountReply = mNam.post(mountReq, data);
+    mGameServerMountReply = mHttpClient->post(mountReq, data, LATENCY_TAG);
+    connect(mGameServerMountReply, &QNetworkReply::finished, this, &MounterGameServer::gameServerMountFinishedHandler);
 
     // Log request
     noteProxyRequest(mGameServerMountReply->operation(), mountUrl, data);
@@ -14,6 +14,8 @@
 // Project Includes
 #include "kernel/directorate.h"
 
+class LocalHttpClient;
+
 class QX_ERROR_TYPE(MounterGameServerError, "MounterError", 1232)
 {
     friend class MounterGameServer;
@@ -72,8 +74,8 @@ private:
                                                      "\tURL: %2\n"
                                                      "\tData: %3"_s;
 
-    // Connections
-    static const int GAME_SERVER_TRANSFER_TIMEOUT = 30000; // ms
+    // Metrics
+    static inline const QString LATENCY_TAG = u"Game server mount"_s;
 
 //-Instance Variables------------------------------------------------------------------------------------------------------------
 private:
@@ -81,12 +83,12 @@ private:
     int mGameServerPort;
     QString mFilePath;
 
-    QNetworkAccessManager mNam;
+    LocalHttpClient* mHttpClient;
     QPointer<QNetworkReply> mGameServerMountReply;
 
 //-Constructor-------------------------------------------------------------------------------------------------
 public:
-    explicit MounterGameServer(QObject* parent, Director* director);
+    explicit MounterGameServer(QObject* parent, Director* director, LocalHttpClient* httpClient);
 
 //-Instance Functions---------------------------------------------------------------------------------------------------------
 private:
@@ -106,7 +108,7 @@ public:
 
 //-Signals & Slots------------------------------------------------------------------------------------------------------------
 private slots:
-    void gameServerMountFinishedHandler(QNetworkReply* reply);
+    void gameServerMountFinishedHandler();
 
 public slots:
     void mount();
@@ -183,15 +183,14 @@ void MounterQmp::qmpiCommandErrorHandler(QString errorClass, QString description
 
 void MounterQmp::qmpiCommandResponseHandler(QJsonValue value, std::any context)
 {
-    logEvent(EVENT_QMP_COMMAND_RESPONSE.arg(std::any_cast<QString>(context), Qx::asString(value)));
+    logDebug(EVENT_QMP_COMMAND_RESPONSE, std::any_cast<QString>(context), [&value]{ return Qx::asString(value); });
 }
 
 void MounterQmp::qmpiEventOccurredHandler(QString name, QJsonObject data, QDateTime timestamp)
 {
-    QJsonDocument formatter(data);
-    QString dataStr = formatter.toJson(QJsonDocument::Compact);
-    QString timestampStr = timestamp.toString(u"hh:mm:s s.zzz"_s);
-    logEvent(EVENT_QMP_EVENT.arg(name, dataStr, timestampStr));
+    logDebug(EVENT_QMP_EVENT, name,
+             [&data]{ return QString::fromUtf8(QJsonDocument(data).toJson(QJsonDocument::Compact)); },
+             [&timestamp]{ return timestamp.toString(u"hh:mm:s s.zzz"_s); });
 }
 
 //Public Slots:
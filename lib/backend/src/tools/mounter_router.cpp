@@ -2,13 +2,10 @@
 #include "mounter_router.h"
 
 // Qt Includes
-#include <QAuthenticator>
 #include <QUrlQuery>
 
-// Qx Includes
-#include <qx/core/qx-string.h>
-
 // Project Includes
+#include "tools/localhttpclient.h"
 #include "utility.h"
 
 //===============================================================================================================
@@ -40,36 +37,14 @@ QString MounterRouterError::deriveSecondary() const { return mSpecific; }
 
 //-Constructor----------------------------------------------------------------------------------------------------------
 //Public:
-MounterRouter::MounterRouter(QObject* parent, Director* director) :
+MounterRouter::MounterRouter(QObject* parent, Director* director, LocalHttpClient* httpClient) :
     QObject(parent),
     Directorate(director),
     mMounting(false),
-    mRouterPort(0)
+    mRouterPort(0),
+    mHttpClient(httpClient)
 {
-    // Setup Network Access Manager
-    mNam.setAutoDeleteReplies(true);
-    mNam.setTransferTimeout(PHP_TRANSFER_TIMEOUT);
-
-    // Connections
-    connect(&mNam, &QNetworkAccessManager::finished, this, &MounterRouter::mountFinishedHandler);
-
-    /* Network check (none of these should be triggered, they are here in case a FP update would required
-     * them to be used as to help make that clear in the logs when the update causes this to stop working).
-     */
-    connect(&mNam, &QNetworkAccessManager::authenticationRequired, this, [this](){
-        logEvent(u"Unexpected use of authentication by PHP server!"_s);
-    });
-    connect(&mNam, &QNetworkAccessManager::preSharedKeyAuthenticationRequired, this, [this](){
-        logEvent(u"Unexpected use of PSK authentication by PHP server!"_s);
-    });
-    connect(&mNam, &QNetworkAccessManager::proxyAuthenticationRequired, this, [this](){
-        logEvent(u"Unexpected use of proxy by PHP server!"_s);
-    });
-    connect(&mNam, &QNetworkAccessManager::sslErrors, this, [this](QNetworkReply* reply, const QList<QSslError>& errors){
-        Q_UNUSED(reply);
-        QString errStrList = Qx::String::join(errors, [](const QSslError& err){ return err.errorString(); }, u","_s);
-        logEvent(u"Unexpected SSL errors from PHP server! {"_s + errStrList + u"}"_s"}");
-    });
+    Q_ASSERT(mHttpClient);
 }
 
 //-Instance Functions---------------------------------------------------------------------------------------------------------
@@ -92,9 +67,10 @@ void MounterRouter::setMountValue(const QString& value) { mMountValue = value; }
 
 //-Signals & Slots------------------------------------------------------------------------------------------------------------
 //Private Slots:
-void MounterRouter::mountFinishedHandler(QNetworkReply* reply)
+void MounterRouter::mountFinishedHandler()
 {
-    assert(reply == mRouterMountReply.get());
+    QNetworkReply* reply = mRouterMountReply.get();
+    Q_ASSERT(reply);
 
     MounterRouterError err;
 
@@ -134,7 +110,8 @@ void MounterRouter::mount()
     QNetworkRequest mountReq(mountUrl);
 
     // GET request
-    mRouterMountReply = mNam.get(mountReq);
+    mRouterMountReply = mHttpClient->get(mountReq, LATENCY_TAG);
+    connect(mRouterMountReply, &QNetworkReply::finished, this, &MounterRouter::mountFinishedHandler);
 
     // Log request
     logEvent(EVENT_REQUEST_SENT.arg(ENUM_NAME(mRouterMountReply->operation()), mountUrl.toString()));
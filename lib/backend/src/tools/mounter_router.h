@@ -14,6 +14,8 @@
 // Project Includes
 #include "kernel/directorate.h"
 
+class LocalHttpClient;
+
 class QX_ERROR_TYPE(MounterRouterError, "MounterRouterError", 1234)
 {
     friend class MounterRouter;
@@ -74,8 +76,8 @@ private:
     static inline const QString EVENT_MOUNTING_THROUGH_ROUTER = u"Mounting data pack via router..."_s;
     static inline const QString EVENT_REQUEST_SENT = u"Sent request (%1): %2"_s;
 
-    // Connections
-    static const int PHP_TRANSFER_TIMEOUT = 30000; // ms
+    // Metrics
+    static inline const QString LATENCY_TAG = u"Router mount"_s;
 
 //-Instance Variables------------------------------------------------------------------------------------------------------------
 private:
@@ -83,12 +85,12 @@ private:
     int mRouterPort;
     QString mMountValue;
 
-    QNetworkAccessManager mNam;
+    LocalHttpClient* mHttpClient;
     QPointer<QNetworkReply> mRouterMountReply;
 
 //-Constructor-------------------------------------------------------------------------------------------------
 public:
-    explicit MounterRouter(QObject* parent, Director* director);
+    explicit MounterRouter(QObject* parent, Director* director, LocalHttpClient* httpClient);
 
 //-Instance Functions---------------------------------------------------------------------------------------------------------
 private:
@@ -106,7 +108,7 @@ public:
 
 //-Signals & Slots------------------------------------------------------------------------------------------------------------
 private slots:
-    void mountFinishedHandler(QNetworkReply* reply);
+    void mountFinishedHandler();
 
 public slots:
     void mount();
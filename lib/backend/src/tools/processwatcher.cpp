@@ -0,0 +1,90 @@
+// Unit Include
+#include "processwatcher.h"
+
+// Qx Includes
+#include <qx/core/qx-system.h>
+
+//===============================================================================================================
+// ProcessWatcher
+//===============================================================================================================
+
+//-Constructor-------------------------------------------------------------
+//Public:
+ProcessWatcher::ProcessWatcher(QObject* parent) :
+    QObject(parent),
+    mPid(0),
+    mMethod(None),
+    mHandle(-1),
+    mNotifier(nullptr)
+{
+    mPollTimer.setInterval(POLL_INTERVAL);
+    connect(&mPollTimer, &QTimer::timeout, this, [this]{
+        if(!isAlive(mPid))
+            handleExit();
+    });
+}
+
+//-Destructor-------------------------------------------------------------
+//Public:
+ProcessWatcher::~ProcessWatcher() { detach(); }
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+void ProcessWatcher::next(quint32 pid)
+{
+    if(!pid)
+        pid = Qx::processId(mProcessName);
+
+    if(!pid)
+    {
+        // Nothing (left) to watch. Report asynchronously so that callers can connect after start()
+        mPid = 0;
+        mMethod = None;
+        QMetaObject::invokeMethod(this, &ProcessWatcher::finished, Qt::QueuedConnection);
+        return;
+    }
+
+    mPid = pid;
+    mMethod = attach(pid);
+    if(mMethod == None) // Gone before it could be attached to, try the next one
+    {
+        next();
+        return;
+    }
+
+    if(mMethod == Poll)
+        mPollTimer.start();
+
+    emit established(mPid, mMethod);
+}
+
+//Public:
+QString ProcessWatcher::processName() const { return mProcessName; }
+quint32 ProcessWatcher::pid() const { return mPid; }
+ProcessWatcher::Method ProcessWatcher::method() const { return mMethod; }
+bool ProcessWatcher::isWatching() const { return mMethod != None; }
+
+void ProcessWatcher::setProcessName(const QString& name) { mProcessName = name; }
+
+void ProcessWatcher::start(quint32 pid)
+{
+    stop();
+    next(pid);
+}
+
+void ProcessWatcher::stop()
+{
+    mPollTimer.stop();
+    detach();
+    mMethod = None;
+    mPid = 0;
+}
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+//Private Slots:
+void ProcessWatcher::handleExit()
+{
+    mPollTimer.stop();
+    detach();
+    next();
+}
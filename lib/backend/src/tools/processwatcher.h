@@ -0,0 +1,84 @@
+#ifndef PROCESSWATCHER_H
+#define PROCESSWATCHER_H
+
+// Qt Includes
+#include <QObject>
+#include <QTimer>
+
+/* Waits for every process with a given name to exit without polling where the platform allows it.
+ *
+ * On Linux a pidfd is watched through the event loop, with the kernel's process event connector as a fallback for
+ * kernels that lack pidfds (it usually needs elevated privileges though) and a slow liveness check as the last resort.
+ * On Windows the process handle itself is watched.
+ *
+ * Processes with the same name can come and go (e.g. helper processes), so once the watched one exits the watcher
+ * looks for another and carries on with it, only finishing when none are left.
+ */
+class ProcessWatcher : public QObject
+{
+    Q_OBJECT;
+//-Class Enums-------------------------------------------------------------------------------------------------
+public:
+    enum Method
+    {
+        None,
+        PidFd,
+        ProcConnector,
+        Handle,
+        Poll
+    };
+    Q_ENUM(Method);
+
+//-Class Variables------------------------------------------------------------------------------------------------------
+private:
+    static const int POLL_INTERVAL = 1000; // ms, only used if nothing better is available
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    QString mProcessName;
+    quint32 mPid;
+    Method mMethod;
+
+    // Platform specific
+    qintptr mHandle; // pidfd/netlink socket or process handle
+    QObject* mNotifier;
+    QTimer mPollTimer;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    explicit ProcessWatcher(QObject* parent = nullptr);
+
+//-Destructor----------------------------------------------------------------------------------------------------------
+public:
+    ~ProcessWatcher();
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    // Platform specific
+    Method attach(quint32 pid);
+    void detach();
+    bool isAlive(quint32 pid) const;
+
+    void next(quint32 pid = 0);
+
+public:
+    QString processName() const;
+    quint32 pid() const;
+    Method method() const;
+    bool isWatching() const;
+
+    void setProcessName(const QString& name);
+
+    void start(quint32 pid = 0); // Looks the process up by name if no PID is given
+    void stop();
+
+//-Signals & Slots------------------------------------------------------------------------------------------------------------
+private slots:
+    void handleExit();
+
+signals:
+    void established(quint32 pid, ProcessWatcher::Method method);
+    void finished();
+};
+
+#endif // PROCESSWATCHER_H
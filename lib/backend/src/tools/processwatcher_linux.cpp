@@ -0,0 +1,149 @@
+// Unit Include
+#include "processwatcher.h"
+
+// Qt Includes
+#include <QSocketNotifier>
+
+// System Includes
+#include <cerrno>
+#include <csignal>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace // Unit helper functions
+{
+
+int pidfdOpen(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    return syscall(SYS_pidfd_open, pid, 0);
+#else
+    Q_UNUSED(pid);
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+int procConnectorOpen()
+{
+    int sock = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_CONNECTOR);
+    if(sock == -1)
+        return -1;
+
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid = 0; // Let the kernel assign one
+    if(bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1)
+    {
+        close(sock);
+        return -1;
+    }
+
+    // Subscribe (requires CAP_NET_ADMIN on most systems)
+    alignas(nlmsghdr) char subscribe[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))]{};
+    auto header = reinterpret_cast<nlmsghdr*>(subscribe);
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+    header->nlmsg_type = NLMSG_DONE;
+    auto message = reinterpret_cast<cn_msg*>(NLMSG_DATA(header));
+    message->id = {.idx = CN_IDX_PROC, .val = CN_VAL_PROC};
+    message->len = sizeof(proc_cn_mcast_op);
+    *reinterpret_cast<proc_cn_mcast_op*>(message->data) = PROC_CN_MCAST_LISTEN;
+    if(send(sock, subscribe, header->nlmsg_len, 0) == -1)
+    {
+        close(sock);
+        return -1;
+    }
+
+    return sock;
+}
+
+bool procConnectorSawExit(int sock, pid_t pid)
+{
+    // Drain everything that's queued
+    bool exited = false;
+    alignas(nlmsghdr) char buffer[4096];
+    ssize_t len;
+    while((len = recv(sock, buffer, sizeof(buffer), 0)) > 0)
+    {
+        for(auto header = reinterpret_cast<nlmsghdr*>(buffer); NLMSG_OK(header, len); header = NLMSG_NEXT(header, len))
+        {
+            auto message = reinterpret_cast<cn_msg*>(NLMSG_DATA(header));
+            if(message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC)
+                continue;
+
+            auto event = reinterpret_cast<proc_event*>(message->data);
+            if(event->what == proc_event::PROC_EVENT_EXIT && event->event_data.exit.process_tgid == pid &&
+               event->event_data.exit.process_pid == pid) // Main thread, i.e. the process itself
+                exited = true;
+        }
+    }
+
+    return exited;
+}
+
+}
+
+//===============================================================================================================
+// ProcessWatcher
+//===============================================================================================================
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+ProcessWatcher::Method ProcessWatcher::attach(quint32 pid)
+{
+    // Preferred, becomes readable when the process exits (Linux 5.3+)
+    if(int fd = pidfdOpen(pid); fd != -1)
+    {
+        mHandle = fd;
+        auto notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, &ProcessWatcher::handleExit);
+        mNotifier = notifier;
+        return PidFd;
+    }
+    else if(errno == ESRCH)
+        return None;
+
+    // Kernel process events
+    if(int sock = procConnectorOpen(); sock != -1)
+    {
+        // Subscribed now, so make sure the process didn't end before that
+        if(!isAlive(pid))
+        {
+            close(sock);
+            return None;
+        }
+
+        mHandle = sock;
+        auto notifier = new QSocketNotifier(sock, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, [this]{
+            if(procConnectorSawExit(mHandle, mPid))
+                handleExit();
+        });
+        mNotifier = notifier;
+        return ProcConnector;
+    }
+
+    return isAlive(pid) ? Poll : None;
+}
+
+void ProcessWatcher::detach()
+{
+    if(mNotifier)
+    {
+        delete mNotifier;
+        mNotifier = nullptr;
+    }
+
+    if(mHandle != -1)
+    {
+        close(mHandle);
+        mHandle = -1;
+    }
+}
+
+bool ProcessWatcher::isAlive(quint32 pid) const { return kill(pid, 0) == 0 || errno == EPERM; }
@@ -0,0 +1,55 @@
+// Unit Include
+#include "processwatcher.h"
+
+// Qt Includes
+#include <QWinEventNotifier>
+
+// Qx Includes
+#include <qx/windows/qx-common-windows.h>
+
+//===============================================================================================================
+// ProcessWatcher
+//===============================================================================================================
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+ProcessWatcher::Method ProcessWatcher::attach(quint32 pid)
+{
+    // The handle is signaled when the process exits
+    HANDLE h = OpenProcess(SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if(!h)
+        return GetLastError() == ERROR_INVALID_PARAMETER ? None : (isAlive(pid) ? Poll : None); // Invalid parameter means no such process
+
+    mHandle = reinterpret_cast<qintptr>(h);
+    auto notifier = new QWinEventNotifier(h, this);
+    connect(notifier, &QWinEventNotifier::activated, this, &ProcessWatcher::handleExit);
+    mNotifier = notifier;
+    return Handle;
+}
+
+void ProcessWatcher::detach()
+{
+    if(mNotifier)
+    {
+        delete mNotifier;
+        mNotifier = nullptr;
+    }
+
+    if(mHandle != -1)
+    {
+        CloseHandle(reinterpret_cast<HANDLE>(mHandle));
+        mHandle = -1;
+    }
+}
+
+bool ProcessWatcher::isAlive(quint32 pid) const
+{
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if(!h)
+        return GetLastError() == ERROR_ACCESS_DENIED;
+
+    DWORD code = 0;
+    bool alive = GetExitCodeProcess(h, &code) && code == STILL_ACTIVE;
+    CloseHandle(h);
+    return alive;
+}
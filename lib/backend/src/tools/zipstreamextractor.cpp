@@ -0,0 +1,477 @@
+// Unit Include
+#include "zipstreamextractor.h"
+
+// Standard Library Includes
+#include <limits>
+
+// Qt Includes
+#include <QtEndian>
+
+namespace // Unit helper functions
+{
+
+quint16 le16(const char* p) { return qFromLittleEndian<quint16>(p); }
+quint32 le32(const char* p) { return qFromLittleEndian<quint32>(p); }
+quint64 le64(const char* p) { return qFromLittleEndian<quint64>(p); }
+
+}
+
+//===============================================================================================================
+// ZipStreamExtractor
+//===============================================================================================================
+
+//-Constructor--------------------------------------------------------------------
+//Public:
+ZipStreamExtractor::ZipStreamExtractor(const QString& stagingPath, const QString& zipDirPath) :
+    mStagingDir(stagingPath),
+    mState(State::Running),
+    mPhase(Phase::Header),
+    mConsumed(0),
+    mPendingPos(0),
+    mEntry{},
+    mEntryConsumed(0),
+    mEntryWritten(0),
+    mEntryCrc(0),
+    mInflate{},
+    mInflateReady(false),
+    mBytesWritten(0)
+{
+    // Same normalization as TExtract
+    if(!zipDirPath.isEmpty() && zipDirPath != '/')
+    {
+        mZipDirPath = zipDirPath.front() == '/' ? zipDirPath.sliced(1) : zipDirPath;
+        if(mZipDirPath.back() != '/')
+            mZipDirPath.append('/');
+    }
+    mSubPathFound = mZipDirPath.isEmpty();
+}
+
+//-Destructor--------------------------------------------------------------------
+//Public:
+ZipStreamExtractor::~ZipStreamExtractor()
+{
+    discard();
+    if(mInflateReady)
+        inflateEnd(&mInflate);
+}
+
+//-Instance Functions-------------------------------------------------------------
+//Private:
+const char* ZipStreamExtractor::pendingData() const { return mPending.constData() + mPendingPos; }
+qsizetype ZipStreamExtractor::pendingSize() const { return mPending.size() - mPendingPos; }
+void ZipStreamExtractor::consume(qsizetype count) { mPendingPos += count; }
+
+void ZipStreamExtractor::abandon(const QString& reason)
+{
+    mState = State::Abandoned;
+    mAbandonReason = reason;
+    discard(); // Whatever was staged is of no use now
+    mPending = QByteArray();
+    mPendingPos = 0;
+}
+
+void ZipStreamExtractor::finish()
+{
+    if(!mSubPathFound)
+    {
+        abandon(REASON_SUB_PATH.arg(mZipDirPath));
+        return;
+    }
+
+    mState = State::Finished;
+    mPending = QByteArray(); // The central directory isn't needed
+    mPendingPos = 0;
+}
+
+bool ZipStreamExtractor::parseHeader()
+{
+    if(pendingSize() < 4)
+        return false;
+
+    const char* p = pendingData();
+    quint32 sig = le32(p);
+    if(sig == SIG_CENTRAL_HEADER || sig == SIG_END_OF_CENTRAL_DIR || sig == SIG_ZIP64_END_OF_CENTRAL_DIR)
+    {
+        // All entries have been seen
+        finish();
+        return false;
+    }
+    else if(sig != SIG_LOCAL_HEADER)
+    {
+        abandon(REASON_UNEXPECTED_RECORD.arg(mConsumed - pendingSize()));
+        return false;
+    }
+
+    if(pendingSize() < LOCAL_HEADER_SIZE)
+        return false;
+
+    quint16 nameLength = le16(p + 26);
+    quint16 extraLength = le16(p + 28);
+    qsizetype headerSize = LOCAL_HEADER_SIZE + nameLength + extraLength;
+    if(pendingSize() < headerSize)
+        return false;
+
+    mEntry = {
+        .relPath = {},
+        .flags = le16(p + 6),
+        .method = le16(p + 8),
+        .crc = le32(p + 14),
+        .compressedSize = le32(p + 18),
+        .uncompressedSize = le32(p + 22),
+        .zip64 = false
+    };
+
+    // Full sizes of large entries are in the ZIP64 extra field, in this order, only when the regular field is maxed
+    const char* extra = p + LOCAL_HEADER_SIZE + nameLength;
+    for(qsizetype i = 0; i + 4 <= extraLength;)
+    {
+        quint16 id = le16(extra + i);
+        quint16 size = le16(extra + i + 2);
+        if(id == EXTRA_ZIP64)
+        {
+            mEntry.zip64 = true;
+            const char* field = extra + i + 4;
+            const char* fieldEnd = field + std::min<qsizetype>(size, extraLength - i - 4);
+            if(mEntry.uncompressedSize == SIZE_ZIP64 && field + 8 <= fieldEnd)
+            {
+                mEntry.uncompressedSize = le64(field);
+                field += 8;
+            }
+            if(mEntry.compressedSize == SIZE_ZIP64 && field + 8 <= fieldEnd)
+                mEntry.compressedSize = le64(field);
+        }
+        i += 4 + size;
+    }
+
+    QString name = QString::fromUtf8(p + LOCAL_HEADER_SIZE, nameLength);
+    consume(headerSize);
+
+    if(mEntry.flags & FLAG_ENCRYPTED)
+    {
+        abandon(REASON_ENCRYPTED.arg(name));
+        return false;
+    }
+    if(mEntry.method != METHOD_STORED && mEntry.method != METHOD_DEFLATED)
+    {
+        abandon(REASON_METHOD.arg(name).arg(mEntry.method));
+        return false;
+    }
+    if(mEntry.method == METHOD_STORED && (mEntry.flags & FLAG_DATA_DESCRIPTOR))
+    {
+        abandon(REASON_STORED_DESCRIPTOR.arg(name));
+        return false;
+    }
+
+    return startEntry(name);
+}
+
+bool ZipStreamExtractor::parseDescriptor()
+{
+    if(pendingSize() < 4)
+        return false;
+
+    // The signature is optional
+    const char* p = pendingData();
+    qsizetype sigSize = le32(p) == SIG_DATA_DESCRIPTOR ? 4 : 0;
+    qsizetype size = sigSize + 4 + (mEntry.zip64 ? 16 : 8);
+    if(pendingSize() < size)
+        return false;
+
+    quint32 crc = le32(p + sigSize);
+    consume(size);
+    finishEntry(crc);
+    return mState == State::Running;
+}
+
+bool ZipStreamExtractor::processData()
+{
+    return mEntry.method == METHOD_STORED ? processStored() : processDeflated();
+}
+
+bool ZipStreamExtractor::processStored()
+{
+    quint64 remaining = mEntry.compressedSize - mEntryConsumed;
+    if(remaining == 0)
+    {
+        endData();
+        return mState == State::Running;
+    }
+
+    qsizetype count = std::min<quint64>(remaining, pendingSize());
+    if(count == 0)
+        return false;
+
+    if(!writeOutput(pendingData(), count))
+        return false;
+
+    consume(count);
+    mEntryConsumed += count;
+    if(mEntryConsumed == mEntry.compressedSize)
+        endData();
+
+    return mState == State::Running;
+}
+
+bool ZipStreamExtractor::processDeflated()
+{
+    // With a data descriptor the compressed size is unknown, but deflate streams mark their own end
+    bool sizeKnown = !(mEntry.flags & FLAG_DATA_DESCRIPTOR);
+    qsizetype available = pendingSize();
+    if(sizeKnown)
+        available = std::min<quint64>(available, mEntry.compressedSize - mEntryConsumed);
+    if(available == 0)
+        return false;
+
+    mInflate.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(pendingData()));
+    mInflate.avail_in = uInt(std::min<qsizetype>(available, std::numeric_limits<uInt>::max()));
+    uInt given = mInflate.avail_in;
+
+    int ret;
+    bool produced = false;
+    do
+    {
+        mInflate.next_out = reinterpret_cast<Bytef*>(mOutBuffer.data());
+        mInflate.avail_out = uInt(mOutBuffer.size());
+        ret = inflate(&mInflate, Z_NO_FLUSH);
+        if(ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+        {
+            abandon(REASON_INFLATE.arg(mEntry.relPath).arg(ret));
+            return false;
+        }
+
+        qsizetype out = mOutBuffer.size() - mInflate.avail_out;
+        if(out > 0)
+        {
+            produced = true;
+            if(!writeOutput(mOutBuffer.constData(), out))
+                return false;
+        }
+    }
+    while(mInflate.avail_out == 0 && ret != Z_STREAM_END);
+
+    qsizetype used = given - mInflate.avail_in;
+    consume(used);
+    mEntryConsumed += used;
+
+    if(ret == Z_STREAM_END)
+    {
+        endData();
+        return mState == State::Running;
+    }
+
+    if(sizeKnown && mEntryConsumed == mEntry.compressedSize)
+    {
+        abandon(REASON_INFLATE.arg(mEntry.relPath).arg(Z_DATA_ERROR)); // Ran out of data before the stream ended
+        return false;
+    }
+
+    return used > 0 || produced;
+}
+
+bool ZipStreamExtractor::startEntry(const QString& name)
+{
+    mEntryConsumed = 0;
+    mEntryWritten = 0;
+    mEntryCrc = crc32(0, nullptr, 0);
+
+    if(mEntry.method == METHOD_DEFLATED)
+    {
+        int ret = mInflateReady ? inflateReset(&mInflate) : inflateInit2(&mInflate, -MAX_WBITS); // Raw deflate
+        if(ret != Z_OK)
+        {
+            abandon(REASON_INFLATE.arg(name).arg(ret));
+            return false;
+        }
+        mInflateReady = true;
+        if(mOutBuffer.isEmpty())
+            mOutBuffer.resize(OUTPUT_BUFFER_SIZE);
+    }
+
+    // Entries outside the sub-path are still walked through, just not written
+    mPhase = Phase::Data;
+    if(!name.startsWith(mZipDirPath))
+        return true;
+    mSubPathFound = true;
+
+    QString relPath = name.sliced(mZipDirPath.size());
+    if(relPath.isEmpty())
+        return true;
+
+    // Never write outside of the destination
+    bool isDir = relPath.endsWith('/');
+    relPath = QDir::cleanPath(relPath);
+    if(QDir::isAbsolutePath(relPath) || relPath == u".."_s || relPath.startsWith(u"../"_s))
+    {
+        abandon(REASON_ESCAPE.arg(name));
+        return false;
+    }
+
+    if(isDir)
+    {
+        if(!mStagingDir.mkpath(relPath))
+        {
+            abandon(REASON_MAKE_PATH.arg(relPath));
+            return false;
+        }
+        mDirectories.append(relPath);
+        return true;
+    }
+
+    qsizetype slash = relPath.lastIndexOf('/');
+    QString parent = slash != -1 ? relPath.left(slash) : u"."_s;
+    if(!mStagingDir.mkpath(parent))
+    {
+        abandon(REASON_MAKE_PATH.arg(parent));
+        return false;
+    }
+
+    mOutput = std::make_unique<QFile>(mStagingDir.absoluteFilePath(relPath));
+    if(!mOutput->open(QIODevice::WriteOnly))
+    {
+        abandon(REASON_WRITE.arg(relPath, mOutput->errorString()));
+        return false;
+    }
+
+    mEntry.relPath = relPath;
+    mFiles.append(relPath);
+    return true;
+}
+
+bool ZipStreamExtractor::writeOutput(const char* data, qsizetype size)
+{
+    // Skipped entries are still CRC checked, as that's cheap and catches a corrupt stream early
+    mEntryCrc = crc32(mEntryCrc, reinterpret_cast<const Bytef*>(data), uInt(size));
+    mEntryWritten += size;
+
+    if(mOutput)
+    {
+        if(mOutput->write(data, size) != size)
+        {
+            abandon(REASON_WRITE.arg(mEntry.relPath, mOutput->errorString()));
+            return false;
+        }
+        mBytesWritten += size;
+    }
+
+    return true;
+}
+
+void ZipStreamExtractor::endData()
+{
+    if(mEntry.flags & FLAG_DATA_DESCRIPTOR)
+        mPhase = Phase::Descriptor;
+    else
+        finishEntry(mEntry.crc);
+}
+
+void ZipStreamExtractor::finishEntry(quint32 expectedCrc)
+{
+    QString label = mEntry.relPath;
+    if(mOutput)
+    {
+        mOutput->close();
+        if(mOutput->error() != QFileDevice::NoError)
+        {
+            abandon(REASON_WRITE.arg(label, mOutput->errorString()));
+            return;
+        }
+        mOutput.reset();
+    }
+
+    if(mEntryCrc != expectedCrc)
+    {
+        abandon(REASON_CRC.arg(label));
+        return;
+    }
+
+    mPhase = Phase::Header;
+}
+
+//Public:
+ZipStreamExtractor::State ZipStreamExtractor::state() const { return mState; }
+QString ZipStreamExtractor::abandonReason() const { return mAbandonReason; }
+QString ZipStreamExtractor::stagingPath() const { return mStagingDir.absolutePath(); }
+qsizetype ZipStreamExtractor::fileCount() const { return mFiles.size(); }
+qint64 ZipStreamExtractor::bytesWritten() const { return mBytesWritten; }
+
+void ZipStreamExtractor::feed(qint64 offset, const QByteArray& data)
+{
+    if(mState != State::Running)
+        return;
+
+    // Entries are only valid when seen from the start without any gaps
+    if(offset != mConsumed)
+    {
+        abandon(REASON_DISCONTINUITY);
+        return;
+    }
+
+    mConsumed += data.size();
+    mPending.append(data);
+
+    bool progressed = true;
+    while(progressed && mState == State::Running)
+    {
+        switch(mPhase)
+        {
+            case Phase::Header:
+                progressed = parseHeader();
+                break;
+            case Phase::Data:
+                progressed = processData();
+                break;
+            case Phase::Descriptor:
+                progressed = parseDescriptor();
+                break;
+        }
+    }
+
+    // Keep only what couldn't be parsed yet, which is at most part of a header
+    if(mPendingPos > 0)
+    {
+        mPending.remove(0, mPendingPos);
+        mPendingPos = 0;
+    }
+}
+
+bool ZipStreamExtractor::commit(const QDir& destination, QString* errorString)
+{
+    Q_ASSERT(mState == State::Finished);
+
+    auto fail = [&](const QString& reason){
+        if(errorString)
+            *errorString = reason;
+        return false;
+    };
+
+    if(!destination.mkpath(u"."_s))
+        return fail(REASON_MAKE_PATH.arg(destination.absolutePath()));
+
+    for(const QString& d : std::as_const(mDirectories))
+        if(!destination.mkpath(d))
+            return fail(REASON_MAKE_PATH.arg(d));
+
+    // The staging directory is expected to be on the same volume as the destination, so these are cheap renames
+    for(const QString& f : std::as_const(mFiles))
+    {
+        QString target = destination.absoluteFilePath(f);
+        if(qsizetype slash = f.lastIndexOf('/'); slash != -1 && !destination.mkpath(f.left(slash)))
+            return fail(REASON_MAKE_PATH.arg(f.left(slash)));
+        if(QFile::exists(target) && !QFile::remove(target))
+            return fail(REASON_WRITE.arg(f, u"existing file could not be replaced"_s));
+
+        QFile staged(mStagingDir.absoluteFilePath(f));
+        if(!staged.rename(target))
+            return fail(REASON_WRITE.arg(f, staged.errorString()));
+    }
+
+    discard();
+    return true;
+}
+
+void ZipStreamExtractor::discard()
+{
+    mOutput.reset();
+    if(mStagingDir.exists())
+        mStagingDir.removeRecursively();
+}
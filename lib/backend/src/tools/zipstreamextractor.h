@@ -0,0 +1,170 @@
+#ifndef ZIPSTREAMEXTRACTOR_H
+#define ZIPSTREAMEXTRACTOR_H
+
+// Standard Library Includes
+#include <memory>
+
+// Qt Includes
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+// zlib Includes
+#include <zlib.h>
+
+/* Extracts a zip archive as it's being received, by walking the local file headers in stream order
+ * instead of waiting for the central directory at the end of the file. Entries are written to a
+ * staging directory and only moved to their final location via commit(), so that nothing reaches the
+ * destination before the archive as a whole has been verified.
+ *
+ * Not every archive can be handled this way (encryption, unusual compression methods, stored entries
+ * that rely on a data descriptor, a transfer that restarts part way through, etc.). In those cases the
+ * extractor gives up and reports why, and the caller is expected to fall back to extracting the
+ * completed file normally.
+ */
+class ZipStreamExtractor
+{
+//-Class Enums-------------------------------------------------------------------------------------------------
+public:
+    enum class State
+    {
+        Running,
+        Finished,
+        Abandoned
+    };
+
+private:
+    enum class Phase
+    {
+        Header,
+        Data,
+        Descriptor
+    };
+
+//-Inner Structs--------------------------------------------------------------------------------------------------------
+private:
+    struct Entry
+    {
+        QString relPath; // Empty if the entry isn't being extracted
+        quint16 flags;
+        quint16 method;
+        quint32 crc;
+        quint64 compressedSize;
+        quint64 uncompressedSize;
+        bool zip64;
+    };
+
+//-Class Variables-------------------------------------------------------------------------------------------------
+private:
+    // Signatures
+    static const quint32 SIG_LOCAL_HEADER = 0x04034b50;
+    static const quint32 SIG_CENTRAL_HEADER = 0x02014b50;
+    static const quint32 SIG_END_OF_CENTRAL_DIR = 0x06054b50;
+    static const quint32 SIG_ZIP64_END_OF_CENTRAL_DIR = 0x06064b50;
+    static const quint32 SIG_DATA_DESCRIPTOR = 0x08074b50;
+
+    // Layout
+    static const qsizetype LOCAL_HEADER_SIZE = 30;
+    static const quint16 EXTRA_ZIP64 = 0x0001;
+    static const quint32 SIZE_ZIP64 = 0xFFFFFFFF;
+
+    // Flags/Methods
+    static const quint16 FLAG_ENCRYPTED = 0x0001;
+    static const quint16 FLAG_DATA_DESCRIPTOR = 0x0008;
+    static const quint16 METHOD_STORED = 0;
+    static const quint16 METHOD_DEFLATED = 8;
+
+    // Buffers
+    static const qsizetype OUTPUT_BUFFER_SIZE = 256 * 1024;
+
+    // Reasons
+    static inline const QString REASON_DISCONTINUITY = u"the transfer was resumed or restarted"_s;
+    static inline const QString REASON_UNEXPECTED_RECORD = u"unexpected record at offset %1"_s;
+    static inline const QString REASON_ENCRYPTED = u"\"%1\" is encrypted"_s;
+    static inline const QString REASON_METHOD = u"\"%1\" uses unsupported compression method %2"_s;
+    static inline const QString REASON_STORED_DESCRIPTOR = u"\"%1\" is stored without a known size"_s;
+    static inline const QString REASON_ESCAPE = u"\"%1\" points outside of the destination"_s;
+    static inline const QString REASON_INFLATE = u"decompression of \"%1\" failed (%2)"_s;
+    static inline const QString REASON_CRC = u"\"%1\" failed its CRC check"_s;
+    static inline const QString REASON_WRITE = u"could not write \"%1\" (%2)"_s;
+    static inline const QString REASON_MAKE_PATH = u"could not create \"%1\""_s;
+    static inline const QString REASON_SUB_PATH = u"the archive has no \"%1\" folder"_s;
+
+//-Instance Variables------------------------------------------------------------------------------------------------
+private:
+    // Data
+    QDir mStagingDir;
+    QString mZipDirPath; // NOTE: empty string for root, otherwise has a trailing slash
+
+    // Status
+    State mState;
+    QString mAbandonReason;
+    bool mSubPathFound;
+
+    // Stream
+    Phase mPhase;
+    qint64 mConsumed; // Total bytes fed
+    QByteArray mPending;
+    qsizetype mPendingPos;
+
+    // Current entry
+    Entry mEntry;
+    quint64 mEntryConsumed;
+    quint64 mEntryWritten;
+    uLong mEntryCrc;
+    std::unique_ptr<QFile> mOutput;
+    z_stream mInflate;
+    bool mInflateReady;
+    QByteArray mOutBuffer;
+
+    // Results
+    QStringList mFiles;
+    QStringList mDirectories;
+    qint64 mBytesWritten;
+
+//-Constructor----------------------------------------------------------------------------------------------------------
+public:
+    ZipStreamExtractor(const QString& stagingPath, const QString& zipDirPath);
+    ZipStreamExtractor(const ZipStreamExtractor& other) = delete;
+
+//-Destructor----------------------------------------------------------------------------------------------------------
+public:
+    ~ZipStreamExtractor();
+
+//-Instance Functions------------------------------------------------------------------------------------------------------
+private:
+    const char* pendingData() const;
+    qsizetype pendingSize() const;
+    void consume(qsizetype count);
+
+    void abandon(const QString& reason);
+    void finish();
+
+    bool parseHeader();
+    bool parseDescriptor();
+    bool processData();
+    bool processStored();
+    bool processDeflated();
+    bool startEntry(const QString& name);
+    bool writeOutput(const char* data, qsizetype size);
+    void endData();
+    void finishEntry(quint32 expectedCrc);
+
+public:
+    State state() const;
+    QString abandonReason() const;
+    QString stagingPath() const;
+    qsizetype fileCount() const;
+    qint64 bytesWritten() const;
+
+    void feed(qint64 offset, const QByteArray& data);
+    bool commit(const QDir& destination, QString* errorString = nullptr);
+    void discard();
+
+//-Operators------------------------------------------------------------------------------------------------------
+public:
+    ZipStreamExtractor& operator=(const ZipStreamExtractor& other) = delete;
+};
+
+#endif // ZIPSTREAMEXTRACTOR_H